@@ -0,0 +1,433 @@
+#ifndef ANYTIMESEARCH_H
+#define ANYTIMESEARCH_H
+
+#include <vector>
+#include <limits>
+#include <chrono>
+
+#include "Graph.h"
+#include "GraphSearch.h"
+#include "SearchContext.h"
+
+// -------------------------------------------------------
+// Name:        AnytimeAStar
+// Description: Anytime repairing A* (ARA*) on a Graph, for
+//              callers that must answer within a budget. The
+//              first pass orders the open set by g + w * h with
+//              an inflated weight w, so a path turns up after
+//              few expansions; its cost is at most w times the
+//              shortest. Each later pass lowers w and repairs
+//              the previous search instead of starting again:
+//              only the nodes whose cost dropped after they were
+//              expanded (kept aside as "inconsistent") and the
+//              open set are searched on, so the passes together
+//              cost little more than the last one alone. The
+//              pass with w = 1 ends with the shortest path.
+//
+//              Every call runs until its Budget (expansions,
+//              wall-clock time or both) is spent, then returns
+//              the best path so far and a bound on how much
+//              longer than the shortest it can be; improve()
+//              picks up where the last call stopped. The
+//              heuristic must be admissible and consistent, and
+//              the graph must not change between the calls of
+//              one query.
+// -------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic = typename Graph<NodeType, ArcType>::Euclidean>
+class AnytimeAStar {
+public:
+	typedef Graph<NodeType, ArcType> GraphType;
+	typedef GraphNode<NodeType, ArcType> Node;
+
+// -------------------------------------------------------
+// Description: What one call may spend; 0 means no limit,
+//              and both 0 runs the query to the end.
+// -------------------------------------------------------
+	struct Budget {
+		size_t expansions;
+		double milliseconds;
+	};
+
+	struct Result {
+		// the best path's cost, or infinity if none is known yet
+		ArcType cost;
+		// the cost is at most bound times the shortest (1 once it
+		// is the shortest, infinity while there is no path)
+		double bound;
+		// the weight the current pass uses
+		double weight;
+		// true once nothing is left to improve
+		bool finished;
+		// expansions by this call and by the whole query so far
+		size_t expanded;
+		size_t totalExpanded;
+		// passes completed so far
+		int passes;
+	};
+
+private:
+	typedef typename CostTraits<ArcType>::Weight Weight;
+
+	GraphType const & m_graph;
+	Heuristic m_heuristic;
+
+	// costs, parents and the open set of the query
+	SearchContext<ArcType> m_context;
+
+// -------------------------------------------------------
+// Description: the nodes the query has reached, and the
+//              pass each node was expanded in and set aside
+//              as inconsistent in; passes are numbered across
+//              queries, so no clearing is needed.
+// -------------------------------------------------------
+	std::vector<int> m_reached;
+	std::vector<unsigned int> m_closed;
+	std::vector<unsigned int> m_inconsistent;
+	std::vector<int> m_inconsistentList;
+	unsigned int m_pass;
+
+	int m_start;
+	int m_goal;
+	double m_weight;
+	double m_step;
+	Weight m_fixedWeight;
+	bool m_finished;
+	int m_passes;
+	size_t m_expanded;
+
+	// the best path found, destination first, and its cost and bound
+	std::vector<int> m_best;
+	ArcType m_bestCost;
+	double m_bound;
+
+	static ArcType infinity() {
+		return SearchContext<ArcType>::infinity();
+	}
+
+	ArcType key( int node ) const {
+		return m_context.cost(node) + CostTraits<ArcType>::scale(m_heuristic(node, m_goal), m_fixedWeight);
+	}
+
+	void beginPass();
+	bool improvePath( Budget const &budget, std::chrono::steady_clock::time_point start, size_t &spent );
+	void keepBest();
+	void updateBound();
+
+	// not copyable
+	AnytimeAStar( AnytimeAStar const & );
+	AnytimeAStar & operator=( AnytimeAStar const & );
+
+public:
+	explicit AnytimeAStar( GraphType const &graph )
+		: m_graph( graph ), m_heuristic( graph ), m_pass( 0 ), m_start( -1 ), m_goal( -1 ), m_weight( 1.0 ), m_step( 0.5 ),
+		  m_fixedWeight( CostTraits<ArcType>::weight(1.0) ), m_finished( true ), m_passes( 0 ), m_expanded( 0 ),
+		  m_bestCost( infinity() ), m_bound( std::numeric_limits<double>::infinity() ) {
+	}
+
+	AnytimeAStar( GraphType const &graph, Heuristic const &heuristic )
+		: m_graph( graph ), m_heuristic( heuristic ), m_pass( 0 ), m_start( -1 ), m_goal( -1 ), m_weight( 1.0 ), m_step( 0.5 ),
+		  m_fixedWeight( CostTraits<ArcType>::weight(1.0) ), m_finished( true ), m_passes( 0 ), m_expanded( 0 ),
+		  m_bestCost( infinity() ), m_bound( std::numeric_limits<double>::infinity() ) {
+	}
+
+	static Budget unlimited() {
+		Budget budget = { 0, 0.0 };
+		return budget;
+	}
+
+	static Budget expansions( size_t count ) {
+		Budget budget = { count, 0.0 };
+		return budget;
+	}
+
+	static Budget milliseconds( double ms ) {
+		Budget budget = { 0, ms };
+		return budget;
+	}
+
+	Result search( int start, int goal, Budget const &budget, double initialWeight = 3.0, double weightStep = 0.5 );
+	Result improve( Budget const &budget );
+
+	void path( std::vector<Node*> &path ) const;
+
+	// Accessor functions
+	ArcType cost() const {
+		return m_bestCost;
+	}
+
+	double bound() const {
+		return m_bound;
+	}
+
+	bool finished() const {
+		return m_finished;
+	}
+};
+
+// ----------------------------------------------------------------
+//  Name:           search
+//  Description:    Starts a query and works on it until the budget
+//                  is spent or the shortest path is found.
+//  Arguments:      The start and goal node indices, the budget, the
+//                  weight of the first pass (at least 1) and how
+//                  much each later pass lowers it.
+//  Return Value:   The best path's cost and bound so far.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+typename AnytimeAStar<NodeType, ArcType, Heuristic>::Result AnytimeAStar<NodeType, ArcType, Heuristic>::search( int start, int goal, Budget const &budget, double initialWeight, double weightStep ) {
+	int size = m_graph.getMaxNodes();
+	m_context.reset(size);
+	m_closed.resize(size, 0);
+	m_inconsistent.resize(size, 0);
+	if(++m_pass == 0) {
+		m_closed.assign(size, 0);
+		m_inconsistent.assign(size, 0);
+		m_pass = 1;
+	}
+	m_reached.clear();
+	m_inconsistentList.clear();
+	m_best.clear();
+
+	m_start = start;
+	m_goal = goal;
+	m_weight = initialWeight < 1.0 ? 1.0 : initialWeight;
+	m_step = weightStep > 0.0 ? weightStep : 0.5;
+	m_fixedWeight = CostTraits<ArcType>::weight(m_weight);
+	m_finished = false;
+	m_passes = 0;
+	m_expanded = 0;
+	m_bestCost = infinity();
+	m_bound = std::numeric_limits<double>::infinity();
+
+	m_context.setCost(start, 0, -1);
+	m_reached.push_back(start);
+	m_context.open().push(start, key(start));
+
+	return improve(budget);
+}
+
+// ----------------------------------------------------------------
+//  Name:           improve
+//  Description:    Goes on with the current query: finishes the
+//                  pass the last call was in, then runs passes
+//                  with lower weights, until the budget is spent or
+//                  the pass with weight 1 is done.
+//  Arguments:      The budget for this call.
+//  Return Value:   The best path's cost and bound so far.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+typename AnytimeAStar<NodeType, ArcType, Heuristic>::Result AnytimeAStar<NodeType, ArcType, Heuristic>::improve( Budget const &budget ) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	size_t spent = 0;
+
+	while(!m_finished) {
+		bool passDone = improvePath(budget, start, spent);
+		keepBest();
+		if(!passDone) {
+			updateBound();
+			break;
+		}
+
+		m_passes++;
+		updateBound();
+		if(m_weight < m_bound) {
+			m_bound = m_weight;
+		}
+		if(m_weight <= 1.0 || m_bound <= 1.0 || m_bestCost == infinity()) {
+			// the shortest path is known, or there is none.
+			m_finished = true;
+			m_bound = m_bestCost == infinity() ? std::numeric_limits<double>::infinity() : 1.0;
+			break;
+		}
+
+		m_weight = m_weight - m_step < 1.0 ? 1.0 : m_weight - m_step;
+		m_fixedWeight = CostTraits<ArcType>::weight(m_weight);
+		beginPass();
+	}
+
+	Result result;
+	result.cost = m_bestCost;
+	result.bound = m_bound;
+	result.weight = m_weight;
+	result.finished = m_finished;
+	result.expanded = spent;
+	result.totalExpanded = m_expanded;
+	result.passes = m_passes;
+	return result;
+}
+
+// ----------------------------------------------------------------
+//  Name:           beginPass
+//  Description:    Starts a pass with the new weight: the nodes set
+//                  aside as inconsistent join the open set, every
+//                  open node is keyed by the new weight, and no node
+//                  counts as expanded any more.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+void AnytimeAStar<NodeType, ArcType, Heuristic>::beginPass() {
+	IndexedPriorityQueue<ArcType> &open = m_context.open();
+
+	for(size_t i = 0; i != m_reached.size(); i++) {
+		int node = m_reached[i];
+		if(open.contains(node)) {
+			// a lower weight can only lower the key.
+			open.decreaseKey(node, key(node));
+		}
+	}
+	for(size_t i = 0; i != m_inconsistentList.size(); i++) {
+		open.push(m_inconsistentList[i], key(m_inconsistentList[i]));
+	}
+	m_inconsistentList.clear();
+
+	if(++m_pass == 0) {
+		m_closed.assign(m_closed.size(), 0);
+		m_inconsistent.assign(m_inconsistent.size(), 0);
+		m_pass = 1;
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           improvePath
+//  Description:    The body of a pass: weighted A* from the open
+//                  set until the goal's cost is no more than the
+//                  smallest key. A node whose cost drops after it
+//                  was expanded in this pass is not queued again
+//                  but set aside for the next pass, which is what
+//                  keeps each pass's work small.
+//  Arguments:      The budget, when the call started and the
+//                  expansions it has made so far (updated).
+//  Return Value:   true if the pass finished, false if the budget
+//                  ran out first.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+bool AnytimeAStar<NodeType, ArcType, Heuristic>::improvePath( Budget const &budget, std::chrono::steady_clock::time_point start, size_t &spent ) {
+	IndexedPriorityQueue<ArcType> &open = m_context.open();
+	Node** nodes = m_graph.nodeArray();
+
+	while(!open.empty() && m_context.cost(m_goal) > open.topKey()) {
+		if(budget.expansions != 0 && spent >= budget.expansions) {
+			return false;
+		}
+		// reading the clock costs more than an expansion, so it is
+		// only checked every 32 of them.
+		if(budget.milliseconds > 0.0 && spent % 32 == 0
+			&& std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() >= budget.milliseconds) {
+			return false;
+		}
+
+		int top = open.top();
+		open.pop();
+		m_closed[top] = m_pass;
+		m_context.countExpansion();
+		m_expanded++;
+		spent++;
+
+		ArcType cost = m_context.cost(top);
+		typename Node::ArcList::const_iterator iter = nodes[top]->arcList().begin();
+		typename Node::ArcList::const_iterator endIter = nodes[top]->arcList().end();
+
+		for( ; iter != endIter; iter++) {
+			int child = iter->node()->index();
+			ArcType gC = cost + iter->weight();
+
+			if(gC < m_context.cost(child)) {
+				if(!m_context.reached(child)) {
+					m_reached.push_back(child);
+				}
+				m_context.setCost(child, gC, top);
+
+				if(m_closed[child] != m_pass) {
+					if(open.contains(child)) {
+						open.decreaseKey(child, key(child));
+					}
+					else {
+						open.push(child, key(child));
+					}
+				}
+				else if(m_inconsistent[child] != m_pass) {
+					m_inconsistent[child] = m_pass;
+					m_inconsistentList.push_back(child);
+				}
+			}
+		}
+	}
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           keepBest
+//  Description:    Copies the path to the goal out of the search
+//                  tree if it is better than the best one kept.
+//                  Following parents always gives a path no more
+//                  costly than the goal's cost, because a parent's
+//                  cost only drops after the child takes it.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+void AnytimeAStar<NodeType, ArcType, Heuristic>::keepBest() {
+	if(m_context.cost(m_goal) < m_bestCost) {
+		m_best.clear();
+		for(int node = m_goal; node != -1; node = m_context.previous(node)) {
+			m_best.push_back(node);
+		}
+		m_bestCost = m_context.cost(m_goal);
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           updateBound
+//  Description:    Tightens the bound on the best path. No path is
+//                  shorter than the least g + h (unweighted) over
+//                  the open and the inconsistent nodes, as some
+//                  node of the shortest path with its true cost is
+//                  among them; the best cost over that is a bound
+//                  that holds at any point in a pass.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+void AnytimeAStar<NodeType, ArcType, Heuristic>::updateBound() {
+	if(m_bestCost == infinity()) {
+		return;
+	}
+
+	IndexedPriorityQueue<ArcType> &open = m_context.open();
+	ArcType lowest = infinity();
+	for(size_t i = 0; i != m_reached.size(); i++) {
+		int node = m_reached[i];
+		if(open.contains(node) || m_inconsistent[node] == m_pass) {
+			ArcType estimate = m_context.cost(node) + static_cast<ArcType>(m_heuristic(node, m_goal));
+			if(estimate < lowest) {
+				lowest = estimate;
+			}
+		}
+	}
+
+	double bound = 1.0;
+	if(lowest < m_bestCost) {
+		bound = lowest > 0 ? double(m_bestCost) / double(lowest) : std::numeric_limits<double>::infinity();
+	}
+	if(bound < m_bound) {
+		m_bound = bound;
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           path
+//  Description:    The best path found so far.
+//  Arguments:      The vector to write it into, destination first;
+//                  it is left empty if there is none yet.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+void AnytimeAStar<NodeType, ArcType, Heuristic>::path( std::vector<Node*> &path ) const {
+	Node** nodes = m_graph.nodeArray();
+	for(size_t i = 0; i != m_best.size(); i++) {
+		path.push_back(nodes[m_best[i]]);
+	}
+}
+
+#endif
@@ -0,0 +1,410 @@
+#ifndef ARCIMPORTER_H
+#define ARCIMPORTER_H
+
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <climits>
+
+#include "CSRGraph.h"
+#include "ThreadPool.h"
+
+// -------------------------------------------------------
+// Name:        ImportStats
+// Description: What the last ArcImporter::load read.
+// -------------------------------------------------------
+struct ImportStats {
+	unsigned long long bytes;
+	unsigned long long lines;
+	unsigned long long malformed;
+	unsigned long long duplicates;
+	double seconds;
+
+	double megabytesPerSecond() const {
+		return seconds > 0.0 ? bytes / 1048576.0 / seconds : 0.0;
+	}
+};
+
+// -------------------------------------------------------
+// Name:        ArcImporter
+// Description: Reads an arcs.txt style file, one
+//              "from to weight startX startY endX endY" line
+//              per two-way arc, straight into a CSRGraph,
+//              without making a Graph and a GraphArc per arc on
+//              the way.
+//
+//              The file is read in blocks of threads x
+//              chunkBytes, cut at line ends, and the pieces are
+//              parsed on a ThreadPool with a hand-written
+//              number parser. The lines then only cost their
+//              from, to and weight until the graph is built.
+//              The peak is while their two arcs are dealt into
+//              the graph's arrays: the blocks, the positions,
+//              12 to 24 bytes per line for the lines (a vector
+//              grown by doubling) and 16 for the arcs, with int
+//              weights; 1.75 to 2.5 times the finished graph.
+//
+//              The result matches Graph::addDualArc followed by
+//              freeze(): an arc that is already there is not
+//              added again (the first weight read wins), and a
+//              node's position is the last one a line gives it
+//              (a skipped duplicate line still moves its nodes,
+//              which addDualArc would not).
+// -------------------------------------------------------
+template<class ArcType>
+class ArcImporter {
+public:
+	typedef typename CSRGraph<ArcType>::NodeId NodeId;
+
+private:
+	struct Line {
+		NodeId from;
+		NodeId to;
+		ArcType weight;
+		float startX, startY, endX, endY;
+	};
+
+	struct Arc {
+		NodeId from;
+		NodeId to;
+		ArcType weight;
+	};
+
+	struct ByTarget {
+		bool operator()( std::pair<NodeId, ArcType> const &a, std::pair<NodeId, ArcType> const &b ) const {
+			return a.first < b.first;
+		}
+	};
+
+	ThreadPool m_pool;
+	size_t m_chunkBytes;
+	NodeId m_nodeLimit;
+	ImportStats m_stats;
+
+	static bool parseLine( char const *&p, char const *end, Line &line );
+	void parse( std::vector<char> const &block, size_t length, std::vector<std::vector<Line> > &pieces, std::vector<unsigned long long> &bad );
+
+	// not copyable
+	ArcImporter( ArcImporter const & );
+	ArcImporter & operator=( ArcImporter const & );
+
+public:
+	// threads as for ThreadPool; chunkBytes is how much each thread
+	// parses at a time.
+	ArcImporter( int threads = 0, size_t chunkBytes = 4 << 20 )
+		: m_pool( threads ), m_chunkBytes( chunkBytes > 0 ? chunkBytes : 1 ), m_nodeLimit( 1 << 28 ) {
+		ImportStats none = { 0, 0, 0, 0, 0.0 };
+		m_stats = none;
+	}
+
+	bool load( char const *path, CSRGraph<ArcType> &graph, NodeId nodeCount = 0 );
+
+	int workerCount() const {
+		return m_pool.workerCount();
+	}
+
+	// when load counts the nodes itself, a line naming a node id at
+	// or above this is malformed (so one bad id cannot ask for
+	// gigabytes of positions). 2^28 by default.
+	NodeId nodeLimit() const {
+		return m_nodeLimit;
+	}
+
+	void setNodeLimit( NodeId limit ) {
+		m_nodeLimit = limit;
+	}
+
+	ImportStats const & stats() const {
+		return m_stats;
+	}
+};
+
+// -------------------------------------------------------
+// The number parsers. Whitespace other than a line end is
+// skipped first; p is left after the number. A number too
+// big for the type is not a number.
+// -------------------------------------------------------
+inline bool parseArcNumber( char const *&p, char const *end, long long &value ) {
+	while(p != end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+		p++;
+	}
+	bool negative = p != end && *p == '-';
+	if(negative || (p != end && *p == '+')) {
+		p++;
+	}
+	if(p == end || *p < '0' || *p > '9') {
+		return false;
+	}
+	long long result = 0;
+	for( ; p != end && *p >= '0' && *p <= '9'; p++) {
+		if(result > (LLONG_MAX - 9) / 10) {
+			return false;
+		}
+		result = result * 10 + (*p - '0');
+	}
+	value = negative ? -result : result;
+	return true;
+}
+
+inline bool parseArcNumber( char const *&p, char const *end, int &value ) {
+	long long wide;
+	if(!parseArcNumber(p, end, wide) || wide < INT_MIN || wide > INT_MAX) {
+		return false;
+	}
+	value = static_cast<int>(wide);
+	return true;
+}
+
+inline bool parseArcNumber( char const *&p, char const *end, unsigned int &value ) {
+	long long wide;
+	if(!parseArcNumber(p, end, wide) || wide < 0 || wide > UINT_MAX) {
+		return false;
+	}
+	value = static_cast<unsigned int>(wide);
+	return true;
+}
+
+inline bool parseArcNumber( char const *&p, char const *end, double &value ) {
+	while(p != end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+		p++;
+	}
+	// every piece ends in a line end, so strtod stops inside it.
+	char *stop;
+	value = std::strtod(p, &stop);
+	if(stop == p || stop > end) {
+		return false;
+	}
+	p = stop;
+	return true;
+}
+
+inline bool parseArcNumber( char const *&p, char const *end, float &value ) {
+	char const *start = p;
+	long long whole;
+	// the demo's coordinates are integers; only fall back to strtod
+	// for the rest.
+	if(parseArcNumber(p, end, whole) && (p == end || (*p != '.' && *p != 'e' && *p != 'E'))) {
+		value = static_cast<float>(whole);
+		return true;
+	}
+	p = start;
+	double wide;
+	if(!parseArcNumber(p, end, wide)) {
+		return false;
+	}
+	value = static_cast<float>(wide);
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           load
+//  Description:    Reads the file and builds the graph from it.
+//                  Lines that do not hold seven numbers, or that
+//                  name a node outside [0, nodeCount), are skipped
+//                  and counted in stats().malformed.
+//  Arguments:      The path of the arc file, the graph to replace
+//                  and the number of nodes (the count of names in
+//                  nodes.txt); 0 means one more than the largest
+//                  node id read, which must be below nodeLimit().
+//  Return Value:   false if the file could not be read; the graph
+//                  is then left as it was.
+// ----------------------------------------------------------------
+template<class ArcType>
+bool ArcImporter<ArcType>::load( char const *path, CSRGraph<ArcType> &graph, NodeId nodeCount ) {
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	ImportStats none = { 0, 0, 0, 0, 0.0 };
+	m_stats = none;
+
+	FILE *file = std::fopen(path, "rb");
+	if(file == 0) {
+		return false;
+	}
+
+	bool fixedCount = nodeCount != 0;
+	std::vector<Arc> arcs;
+	std::vector<float> x(nodeCount, 0.0f), y(nodeCount, 0.0f);
+	// each node's arc count, shifted up one to become the offsets.
+	std::vector<NodeId> offsets(static_cast<size_t>(nodeCount) + 1, 0);
+
+	std::vector<char> block(m_pool.workerCount() * m_chunkBytes + 1);
+	std::vector<std::vector<Line> > pieces(m_pool.workerCount());
+	std::vector<unsigned long long> bad(m_pool.workerCount());
+	size_t carried = 0;
+	bool done = false;
+
+	while(!done) {
+		size_t read = std::fread(&block[carried], 1, block.size() - 1 - carried, file);
+		m_stats.bytes += read;
+		size_t length = carried + read;
+		done = read == 0;
+
+		// parse up to the last line end; the rest waits for the next
+		// block, unless there is no more.
+		size_t cut = length;
+		while(cut != 0 && block[cut - 1] != '\n') {
+			cut--;
+		}
+		if(done) {
+			block[length] = '\n';
+			cut = length + 1;
+		}
+		else if(cut == 0) {
+			// a line longer than the block.
+			carried = length;
+			block.resize(block.size() * 2);
+			continue;
+		}
+
+		parse(block, cut, pieces, bad);
+
+		for(size_t piece = 0; piece != pieces.size(); piece++) {
+			m_stats.malformed += bad[piece];
+			for(size_t i = 0; i != pieces[piece].size(); i++) {
+				Line const &line = pieces[piece][i];
+				NodeId largest = line.from > line.to ? line.from : line.to;
+				if(largest >= x.size()) {
+					if(fixedCount || largest >= m_nodeLimit) {
+						m_stats.malformed++;
+						continue;
+					}
+					x.resize(static_cast<size_t>(largest) + 1, 0.0f);
+					y.resize(static_cast<size_t>(largest) + 1, 0.0f);
+					offsets.resize(static_cast<size_t>(largest) + 2, 0);
+				}
+				Arc arc = { line.from, line.to, line.weight };
+				arcs.push_back(arc);
+				offsets[line.from + 1]++;
+				offsets[line.to + 1]++;
+				x[line.from] = line.startX;
+				y[line.from] = line.startY;
+				x[line.to] = line.endX;
+				y[line.to] = line.endY;
+			}
+			m_stats.lines += pieces[piece].size();
+		}
+
+		if(!done) {
+			carried = length - cut;
+			std::copy(block.begin() + cut, block.begin() + length, block.begin());
+		}
+	}
+	std::fclose(file);
+
+	// deal each line's two arcs into place, in file order...
+	NodeId nodes = static_cast<NodeId>(x.size());
+	for(NodeId node = 0; node != nodes; node++) {
+		offsets[node + 1] += offsets[node];
+	}
+
+	std::vector<NodeId> targets(offsets[nodes]);
+	std::vector<ArcType> weights(offsets[nodes]);
+	std::vector<NodeId> next(offsets.begin(), offsets.end() - 1);
+	for(size_t i = 0; i != arcs.size(); i++) {
+		NodeId from = next[arcs[i].from]++, to = next[arcs[i].to]++;
+		targets[from] = arcs[i].to;
+		weights[from] = arcs[i].weight;
+		targets[to] = arcs[i].from;
+		weights[to] = arcs[i].weight;
+	}
+	std::vector<Arc>().swap(arcs);
+	std::vector<NodeId>().swap(next);
+
+	// ...then drop all but the first arc to each neighbour, packing
+	// the arrays down in place.
+	std::vector<std::pair<NodeId, ArcType> > sorted;
+	NodeId kept = 0, begin = 0;
+	for(NodeId node = 0; node != nodes; node++) {
+		NodeId end = offsets[node + 1];
+		sorted.clear();
+		for(NodeId arc = begin; arc != end; arc++) {
+			sorted.push_back(std::make_pair(targets[arc], weights[arc]));
+		}
+		std::stable_sort(sorted.begin(), sorted.end(), ByTarget());
+
+		offsets[node] = kept;
+		for(size_t arc = 0; arc != sorted.size(); arc++) {
+			if(arc != 0 && sorted[arc].first == sorted[arc - 1].first) {
+				continue;
+			}
+			targets[kept] = sorted[arc].first;
+			weights[kept] = sorted[arc].second;
+			kept++;
+		}
+		begin = end;
+	}
+	// every line adds its arc both ways, so a duplicate line costs two.
+	m_stats.duplicates = (targets.size() - kept) / 2;
+	offsets[nodes] = kept;
+	targets.resize(kept);
+	weights.resize(kept);
+
+	graph = CSRGraph<ArcType>(offsets, targets, weights, x, y);
+	m_stats.seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           parse
+//  Description:    Cuts a block into one piece per worker, at line
+//                  ends, and parses the pieces in parallel.
+//  Arguments:      The block, the length to parse (which ends in a
+//                  line end), and the lines and malformed line
+//                  counts of each piece, to fill in.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType>
+void ArcImporter<ArcType>::parse( std::vector<char> const &block, size_t length, std::vector<std::vector<Line> > &pieces, std::vector<unsigned long long> &bad ) {
+	size_t count = pieces.size();
+	std::vector<size_t> bounds(count + 1, 0);
+	for(size_t piece = 1; piece != count; piece++) {
+		size_t cut = length * piece / count;
+		if(cut < bounds[piece - 1]) {
+			cut = bounds[piece - 1];
+		}
+		while(cut != 0 && cut < length && block[cut - 1] != '\n') {
+			cut++;
+		}
+		bounds[piece] = cut;
+	}
+	bounds[count] = length;
+
+	char const *data = &block[0];
+	m_pool.parallelFor(count, 1, [&](int, size_t first, size_t last) {
+		for(size_t piece = first; piece != last; piece++) {
+			pieces[piece].clear();
+			bad[piece] = 0;
+
+			char const *p = data + bounds[piece], *end = data + bounds[piece + 1];
+			while(p != end) {
+				Line line;
+				char const *lineStart = p;
+				if(parseLine(p, end, line)) {
+					pieces[piece].push_back(line);
+				}
+				else {
+					// blank lines are not errors.
+					while(lineStart != p && (*lineStart == ' ' || *lineStart == '\t' || *lineStart == '\r')) {
+						lineStart++;
+					}
+					if(lineStart != p || (p != end && *p != '\n')) {
+						bad[piece]++;
+					}
+				}
+				while(p != end && *p++ != '\n') {
+				}
+			}
+		}
+	});
+}
+
+template<class ArcType>
+bool ArcImporter<ArcType>::parseLine( char const *&p, char const *end, Line &line ) {
+	return parseArcNumber(p, end, line.from) && parseArcNumber(p, end, line.to)
+		&& parseArcNumber(p, end, line.weight) && parseArcNumber(p, end, line.startX)
+		&& parseArcNumber(p, end, line.startY) && parseArcNumber(p, end, line.endX)
+		&& parseArcNumber(p, end, line.endY);
+}
+
+#endif
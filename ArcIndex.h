@@ -0,0 +1,182 @@
+#ifndef ARCINDEX_H
+#define ARCINDEX_H
+
+#include <vector>
+#include <cstddef>
+
+// -------------------------------------------------------
+// Name:        ArcIndex
+// Description: A small open-addressing hash map from a node
+//              pointer to the arc that leads to it. Linear
+//              probing keeps a lookup to one or two cache
+//              lines; erase shifts later entries back instead
+//              of leaving tombstones, so the table never needs
+//              a clean-up pass. A null key marks an empty slot.
+// -------------------------------------------------------
+template<class Key, class Value>
+class ArcIndex {
+private:
+	struct Slot {
+		Key key;
+		Value value;
+	};
+
+	std::vector<Slot> m_slots;
+	size_t m_size;
+
+// -------------------------------------------------------
+// Description: 64 - log2(table size), for the hash below.
+// -------------------------------------------------------
+	int m_shift;
+
+	size_t home( Key key ) const {
+		// Fibonacci hashing: the top bits of the product depend on
+		// every bit of the pointer.
+		unsigned long long bits = reinterpret_cast<size_t>(key);
+		return static_cast<size_t>((bits * 0x9E3779B97F4A7C15ull) >> m_shift);
+	}
+
+	void grow();
+
+public:
+	ArcIndex() : m_size( 0 ), m_shift( 64 ) {
+	}
+
+	size_t size() const {
+		return m_size;
+	}
+
+	bool empty() const {
+		return m_size == 0;
+	}
+
+	size_t memoryUsage() const {
+		return m_slots.capacity() * sizeof(Slot);
+	}
+
+	Value const * find( Key key ) const;
+	void insert( Key key, Value value );
+	void erase( Key key );
+	void clear();
+};
+
+// ----------------------------------------------------------------
+//  Name:           find
+//  Description:    Looks up a key.
+//  Arguments:      The key.
+//  Return Value:   A pointer to the value, or 0 if the key is not in
+//                  the index. It is invalidated by insert/erase.
+// ----------------------------------------------------------------
+template<class Key, class Value>
+Value const * ArcIndex<Key, Value>::find( Key key ) const {
+	if( m_size == 0 ) {
+		return 0;
+	}
+
+	size_t mask = m_slots.size() - 1;
+	for( size_t slot = home(key); m_slots[slot].key != 0; slot = (slot + 1) & mask ) {
+		if( m_slots[slot].key == key ) {
+			return &m_slots[slot].value;
+		}
+	}
+	return 0;
+}
+
+// ----------------------------------------------------------------
+//  Name:           insert
+//  Description:    Adds a key, or replaces its value if it is
+//                  already there.
+//  Arguments:      The (non-null) key and its value.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class Key, class Value>
+void ArcIndex<Key, Value>::insert( Key key, Value value ) {
+	// keep the table at most 3/4 full so probe runs stay short.
+	if( (m_size + 1) * 4 > m_slots.size() * 3 ) {
+		grow();
+	}
+
+	size_t mask = m_slots.size() - 1;
+	size_t slot = home(key);
+	while( m_slots[slot].key != 0 && m_slots[slot].key != key ) {
+		slot = (slot + 1) & mask;
+	}
+
+	if( m_slots[slot].key == 0 ) {
+		m_size++;
+	}
+	m_slots[slot].key = key;
+	m_slots[slot].value = value;
+}
+
+// ----------------------------------------------------------------
+//  Name:           erase
+//  Description:    Removes a key if it is in the index.
+//  Arguments:      The key.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class Key, class Value>
+void ArcIndex<Key, Value>::erase( Key key ) {
+	if( m_size == 0 ) {
+		return;
+	}
+
+	size_t mask = m_slots.size() - 1;
+	size_t slot = home(key);
+	while( m_slots[slot].key != key ) {
+		if( m_slots[slot].key == 0 ) {
+			return;
+		}
+		slot = (slot + 1) & mask;
+	}
+
+	// pull back any later entry of the probe run that would no
+	// longer be reachable across the hole.
+	size_t hole = slot;
+	for( size_t next = (hole + 1) & mask; m_slots[next].key != 0; next = (next + 1) & mask ) {
+		size_t want = home(m_slots[next].key);
+		bool reachable = hole <= next ? (want > hole && want <= next) : (want > hole || want <= next);
+		if( !reachable ) {
+			m_slots[hole] = m_slots[next];
+			hole = next;
+		}
+	}
+	m_slots[hole].key = 0;
+	m_size--;
+}
+
+// ----------------------------------------------------------------
+//  Name:           clear
+//  Description:    Removes every key and releases the table.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class Key, class Value>
+void ArcIndex<Key, Value>::clear() {
+	std::vector<Slot>().swap(m_slots);
+	m_size = 0;
+	m_shift = 64;
+}
+
+template<class Key, class Value>
+void ArcIndex<Key, Value>::grow() {
+	std::vector<Slot> old;
+	old.swap(m_slots);
+
+	Slot empty;
+	empty.key = 0;
+	m_slots.assign(old.empty() ? 16 : old.size() * 2, empty);
+	m_size = 0;
+	m_shift = 64;
+	for( size_t size = m_slots.size(); size > 1; size >>= 1 ) {
+		m_shift--;
+	}
+
+	for( size_t i = 0; i != old.size(); i++ ) {
+		if( old[i].key != 0 ) {
+			insert(old[i].key, old[i].value);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef BATCHQUERY_H
+#define BATCHQUERY_H
+
+#include <vector>
+#include <chrono>
+
+#include "CSRGraph.h"
+#include "SearchContext.h"
+#include "ThreadPool.h"
+
+// -------------------------------------------------------
+// Name:        BatchQuery
+// Description: Solves many (start, dest) queries at once on a
+//              frozen graph, spread over a ThreadPool. Each
+//              worker keeps its own SearchContext for the life
+//              of the BatchQuery, so after the first batch no
+//              per-query setup is needed beyond a context
+//              reset.
+// -------------------------------------------------------
+template<class ArcType>
+class BatchQuery {
+public:
+	typedef typename CSRGraph<ArcType>::NodeId NodeId;
+
+	enum Algorithm {
+		UCS,
+		ASTAR
+	};
+
+	struct Query {
+		NodeId start;
+		NodeId dest;
+	};
+
+// -------------------------------------------------------
+// Description: Where a query's answer is written. The path
+//              is destination first and empty if there is
+//              none. Reusing the same results from tick to
+//              tick keeps the path vectors' capacity, so the
+//              steady state does not allocate.
+// -------------------------------------------------------
+	struct Result {
+		ArcType cost;
+		std::vector<NodeId> path;
+	};
+
+	struct Stats {
+		size_t queries;
+		int threads;
+		double seconds;
+		double queriesPerSecond;
+	};
+
+private:
+	CSRGraph<ArcType> const & m_graph;
+	ThreadPool m_pool;
+	std::vector<SearchContext<ArcType> > m_contexts;
+
+public:
+	BatchQuery( CSRGraph<ArcType> const &graph, int threads = 0 )
+		: m_graph( graph ), m_pool( threads ), m_contexts( m_pool.workerCount() ) {
+	}
+
+	int threadCount() const {
+		return m_pool.workerCount();
+	}
+
+	Stats solve( Query const *queries, size_t count, Result *results, Algorithm algorithm = ASTAR, size_t grain = 16 );
+};
+
+// ----------------------------------------------------------------
+//  Name:           solve
+//  Description:    Runs every query and waits for them all.
+//  Arguments:      The queries and their count, a buffer of at least
+//                  count results (result i answers query i), the
+//                  search to run and how many queries a worker takes
+//                  at a time.
+//  Return Value:   The wall time and throughput of the batch.
+// ----------------------------------------------------------------
+template<class ArcType>
+typename BatchQuery<ArcType>::Stats BatchQuery<ArcType>::solve( Query const *queries, size_t count, Result *results, Algorithm algorithm, size_t grain ) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	CSRGraph<ArcType> const &graph = m_graph;
+	std::vector<SearchContext<ArcType> > &contexts = m_contexts;
+
+	m_pool.parallelFor(count, grain, [&](int worker, size_t begin, size_t end) {
+		SearchContext<ArcType> &context = contexts[worker];
+
+		for( size_t i = begin; i != end; i++ ) {
+			results[i].path.clear();
+			if( algorithm == UCS ) {
+				results[i].cost = graph.ucs(context, queries[i].start, queries[i].dest, results[i].path);
+			}
+			else {
+				results[i].cost = graph.aStar(context, queries[i].start, queries[i].dest, results[i].path);
+			}
+		}
+	});
+
+	Stats stats;
+	stats.queries = count;
+	stats.threads = m_pool.workerCount();
+	stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	stats.queriesPerSecond = stats.seconds > 0.0 ? count / stats.seconds : 0.0;
+	return stats;
+}
+
+#endif
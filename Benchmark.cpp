@@ -0,0 +1,1463 @@
+////////////////////////////////////////////////////////////
+// Benchmark
+//
+// Times Graph::aStar and Graph::ucs, which keep their open
+// set in an IndexedPriorityQueue, against the open set the
+// project used before: a std::list that is re-sorted after
+// every expansion. The same searches are then run on the
+// CSRGraph snapshot made by Graph::freeze(), and the memory
+// each arc costs in both forms is reported.
+//
+// Usage:   Benchmark [gridSide ...] [--legacy-max nodes]
+//                    [--batch queries] [--bidir queries] [--ch queries]
+//                    [--ch-side gridSide] [--landmarks count]
+//                    [--jps mapSide] [--file gridSide] [--stats queries]
+//                    [--cache queries] [--arena gridSide]
+//                    [--policy queries] [--table sources]
+//                    [--anytime queries] [--slice microseconds]
+//                    [--spatial queries] [--dstar rounds]
+//                    [--kernel destinations]
+//          e.g. "Benchmark 317 1000" runs on grids of about
+//          10^5 and 10^6 nodes. The list based search is
+//          quadratic, so it is skipped on graphs larger than
+//          --legacy-max (250000 nodes by default).
+//
+//          On the first grid a batch of random queries is
+//          then solved by BatchQuery with 1, 2, 4... threads
+//          up to the core count (--batch sets the batch size,
+//          2000 by default) to show how it scales.
+//
+//          --stats (200 by default) random aStar queries on
+//          the first grid are timed with no instrumentation and
+//          with SearchStatistics counting, to show what the
+//          counters cost, and their means are printed.
+//
+//          --cache (1000 by default) queries between 16 busy
+//          nodes of the first grid, with an arc weight changed
+//          every 50 queries, are solved by aStar and through a
+//          PathCache; times, hit rate, entries invalidated and
+//          the cache's memory are reported.
+//
+//          A grid of --arena side (1000 by default) is built
+//          and destroyed with its nodes and arcs allocated one
+//          by one and from the graph's pools, and then from the
+//          pools into a graph made empty that grows as the nodes
+//          are added; the times and allocator counters are
+//          compared.
+//
+//          --policy (200 by default) random queries on the
+//          first grid are solved by Graph::ucs and Graph::aStar
+//          and by the policy-based search() as Dijkstra and A*,
+//          with both open sets, then as weighted A* and greedy
+//          best-first; times, nodes expanded and path costs
+//          against the shortest are compared.
+//
+//          --anytime (100 by default) random queries on the
+//          first grid are given to AnytimeAStar with budgets of
+//          500 expansions and of 1 ms, and run to the end; the
+//          cost of the path each budget buys, its bound and the
+//          expansions are compared with aStar's.
+//
+//          The corner to corner aStar on the first grid is run
+//          again as a SearchTask in slices of --slice us (4000
+//          by default), as the demo runs it between frames;
+//          the number of slices, the longest one and the total
+//          time are compared with the search run in one go.
+//
+//          --spatial (10000 by default) random points over the
+//          first grid are snapped to their nearest node, and
+//          the nodes within a radius and within a window-sized
+//          rectangle found, by scanning every node and through
+//          a SpatialIndex; times are compared and every answer
+//          is checked against the scan.
+//
+//          A DStarLite plan across the first grid is kept
+//          for --dstar rounds (100 by default): each round a
+//          few random arcs are reweighted, removed or put
+//          back, the start moves one step along the path and
+//          the plan is repaired. Every replan is checked
+//          against Graph::ucs, and the time and nodes expanded
+//          are compared.
+//
+//          Random queries on the first grid (--bidir
+//          sets how many, 200 by default) are solved by the
+//          one-way and the bidirectional searches, and the
+//          nodes each expands per query are compared.
+//
+//          On a random geometric graph with as many nodes as
+//          the first grid, every node's neighbours are scored
+//          towards --kernel (20 by default) random destinations
+//          with each metric, one child at a time as aStar used
+//          to (heuristic_eval for euclidean) and a block at a
+//          time through HeuristicKernel at each level the CPU
+//          has; times are compared and every block score is
+//          checked against the per-child one.
+//
+//          The first grid also gets --landmarks (16 by default)
+//          ALT landmarks, stored in full and quantized to 16
+//          bits, and the nodes aStar expands with them and with
+//          heuristic_eval are compared on 200 random queries,
+//          along with the memory the tables take.
+//
+//          An 8-connected map of --jps x --jps cells (512 by
+//          default) with walls scattered over it is searched by
+//          Graph::aStar, with the octile heuristic, and by
+//          JumpPointSearch on a bit-packed GridMap; nodes
+//          expanded, times and bytes per cell are compared.
+//
+//          A grid of --ch-side (150 by default; grids are the
+//          slowest kind of graph to contract) is then
+//          preprocessed into a ContractionHierarchy, and
+//          random queries on it (--ch sets how many, 1000 by
+//          default) are timed against CSRGraph::ucs. Every
+//          answer is checked against ucs.
+//
+//          On the same grid a table from --table sources (100
+//          by default) to ten times as many targets is filled
+//          by DistanceTable, with a search per row and with the
+//          hierarchy's buckets, and timed against the time
+//          that many point to point ucs calls would take.
+//
+//          Last, a grid of --file side (317 by default) is
+//          written as text and as a GraphFile, and loading it
+//          the demo's way, by parsing the text into a Graph and
+//          freezing it, is timed against mapping the file with
+//          MappedGraph and searching it in place, and against
+//          reading the text with ArcImporter, whose throughput
+//          is reported in MB/s.
+//
+// The graph core has no SFML dependency, so this program
+// builds and runs headless.
+////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <fstream>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "Graph.h"
+#include "BatchQuery.h"
+#include "BidirectionalSearch.h"
+#include "ContractionHierarchy.h"
+#include "Landmarks.h"
+#include "JumpPointSearch.h"
+#include "GraphFile.h"
+#include "ArcImporter.h"
+#include "PathCache.h"
+#include "GraphSearch.h"
+#include "LazyPriorityQueue.h"
+#include "DistanceTable.h"
+#include "AnytimeSearch.h"
+#include "SearchTask.h"
+#include "SpatialIndex.h"
+#include "DStarLite.h"
+#include "GraphGenerators.h"
+
+using namespace std;
+
+typedef Graph<pair<string, int>, int> GraphType;
+typedef GraphNode<pair<string, int>, int> Node;
+typedef GraphArc<pair<string, int>, int> Arc;
+
+// grid cells are this far apart, so arc weights of at least
+// kSpacing keep the euclidean heuristic admissible.
+const int kSpacing = 10;
+
+void ignoreNode(Node *) {
+}
+
+//orders nodes by their f value, as NodeHeuristicCostComparer did.
+struct LegacyCompare {
+	vector<int> const &f;
+	LegacyCompare(vector<int> const &estimates) : f(estimates) {}
+
+	bool operator()(Node * n1, Node * n2) const {
+		return f[n1->index()] < f[n2->index()];
+	}
+};
+
+//The open set strategy aStar used before the indexed heap: every
+//discovered node goes on a list which is fully sorted by f after
+//each expansion.
+void legacyAStar(GraphType &graph, Node* pStart, Node* pDest, std::vector<Node*> &path) {
+	const int infinity = INT_MAX / 2;
+	int count = graph.getMaxNodes();
+	vector<int> g(count, infinity), f(count, infinity);
+	vector<Node*> previous(count, (Node*)NULL);
+	vector<bool> marked(count, false);
+	list<Node*> nodeList;
+
+	g[pStart->index()] = 0;
+	f[pStart->index()] = graph.heuristic_eval(pStart, pDest);
+
+	nodeList.push_front(pStart);
+	marked[pStart->index()] = true;
+
+	while(nodeList.empty() != true && nodeList.front() != pDest) {
+		Node* top = nodeList.front();
+
+		Node::ArcList::const_iterator iter = top->arcList().begin();
+		Node::ArcList::const_iterator endIter = top->arcList().end();
+
+		for( ; iter != endIter; iter++) {
+			Node* node = iter->node();
+			int gC = g[top->index()] + iter->weight();
+
+			if(gC < g[node->index()]) {
+				g[node->index()] = gC;
+				f[node->index()] = gC + graph.heuristic_eval(node, pDest);
+				previous[node->index()] = top;
+			}
+			if(!marked[node->index()]) {
+				nodeList.push_back(node);
+				marked[node->index()] = true;
+			}
+		}
+
+		nodeList.pop_front();
+		nodeList.sort(LegacyCompare(f));
+	}
+
+	for(Node* node = pDest; node != NULL; node = previous[node->index()]) {
+		path.push_back(node);
+	}
+}
+
+//builds a side x side grid, with each cell joined to its right and
+//lower neighbours by an arc of random weight.
+void buildGrid(GraphType &graph, int side) {
+	for(int i = 0; i != side * side; i++) {
+		graph.addNode(pair<string, int>("", 0), i);
+	}
+
+	srand(42);
+	for(int y = 0; y != side; y++) {
+		for(int x = 0; x != side; x++) {
+			int from = y * side + x;
+			if(x + 1 != side) {
+				graph.addDualArc(from, from + 1, kSpacing + rand() % kSpacing,
+					x * kSpacing, y * kSpacing, (x + 1) * kSpacing, y * kSpacing);
+			}
+			if(y + 1 != side) {
+				graph.addDualArc(from, from + side, kSpacing + rand() % kSpacing,
+					x * kSpacing, y * kSpacing, x * kSpacing, (y + 1) * kSpacing);
+			}
+		}
+	}
+}
+
+double elapsedMs(chrono::high_resolution_clock::time_point since) {
+	return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - since).count();
+}
+
+//solves the same batch of random queries with more and more threads.
+void benchmarkBatch(int side, int batchSize) {
+	typedef BatchQuery<int> Batch;
+
+	GraphType graph(side * side);
+	buildGrid(graph, side);
+	CSRGraph<int> frozen = graph.freeze();
+
+	srand(7);
+	vector<Batch::Query> queries(batchSize);
+	for(int i = 0; i != batchSize; i++) {
+		queries[i].start = rand() % frozen.nodeCount();
+		queries[i].dest = rand() % frozen.nodeCount();
+	}
+	vector<Batch::Result> results(batchSize);
+
+	int cores = static_cast<int>(thread::hardware_concurrency());
+	printf("\nbatch of %d aStar queries on %d nodes\n", batchSize, side * side);
+	printf("%10s %14s %10s\n", "threads", "queries/sec", "speedup");
+
+	double single = 0.0;
+	for(int threads = 1; ; threads *= 2) {
+		if(threads > cores) {
+			threads = cores;
+		}
+
+		Batch batch(frozen, threads);
+		Batch::Stats stats = batch.solve(&queries[0], queries.size(), &results[0]);
+		if(threads == 1) {
+			single = stats.queriesPerSecond;
+		}
+		printf("%10d %14.1f %10.2f\n", threads, stats.queriesPerSecond, stats.queriesPerSecond / single);
+
+		if(threads >= cores) {
+			break;
+		}
+	}
+}
+
+//times aStar without instrumentation and with SearchStatistics on the
+//same queries, and prints the mean counters.
+void benchmarkInstrumentation(int side, int queryCount) {
+	GraphType graph(side * side);
+	buildGrid(graph, side);
+	CSRGraph<int> frozen = graph.freeze();
+	CSRGraph<int>::Euclidean euclidean(frozen);
+
+	CSRGraph<int>::Context context(frozen.nodeCount());
+	vector<CSRGraph<int>::NodeId> path;
+	SearchStatistics statistics;
+	double plainMs = 0.0, countedMs = 0.0;
+	double totals[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+	srand(17);
+	for(int i = 0; i != queryCount; i++) {
+		CSRGraph<int>::NodeId from = rand() % frozen.nodeCount();
+		CSRGraph<int>::NodeId to = rand() % frozen.nodeCount();
+
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		frozen.aStar(context, from, to, path, euclidean);
+		plainMs += elapsedMs(start);
+		path.clear();
+
+		start = chrono::high_resolution_clock::now();
+		frozen.aStar(context, from, to, path, euclidean, statistics);
+		countedMs += elapsedMs(start);
+		path.clear();
+
+		SearchStats const &stats = statistics.stats();
+		totals[0] += stats.expansions;
+		totals[1] += stats.relaxations;
+		totals[2] += stats.pushes;
+		totals[3] += stats.pops;
+		totals[4] += stats.decreaseKeys;
+		totals[5] += stats.peakOpen;
+	}
+
+	printf("\n%d aStar queries on %d nodes: %.1f us uninstrumented, %.1f us with SearchStatistics\n", queryCount,
+		side * side, 1000.0 * plainMs / queryCount, 1000.0 * countedMs / queryCount);
+	printf("per query: %.0f expanded, %.0f relaxed, %.0f pushes, %.0f pops, %.0f decrease-keys, open set peak %.0f\n",
+		totals[0] / queryCount, totals[1] / queryCount, totals[2] / queryCount, totals[3] / queryCount,
+		totals[4] / queryCount, totals[5] / queryCount);
+}
+
+//solves queries between a few busy nodes while arc weights change,
+//with and without a PathCache.
+void benchmarkCache(int side, int queryCount) {
+	GraphType graph(side * side);
+	buildGrid(graph, side);
+	PathCache<pair<string, int>, int> cache(graph);
+
+	vector<int> busy(16);
+	srand(23);
+	for(size_t i = 0; i != busy.size(); i++) {
+		busy[i] = rand() % (side * side);
+	}
+
+	GraphType::Context context(graph.getMaxNodes());
+	vector<Node*> path;
+	double plainMs = 0.0, cachedMs = 0.0;
+	for(int i = 0; i != queryCount; i++) {
+		Node* pStart = graph.nodeArray()[busy[rand() % busy.size()]];
+		Node* pDest = graph.nodeArray()[busy[rand() % busy.size()]];
+
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		graph.aStar(context, pStart, pDest, ignoreNode, path);
+		plainMs += elapsedMs(start);
+		path.clear();
+
+		start = chrono::high_resolution_clock::now();
+		cache.aStar(context, pStart, pDest, ignoreNode, path);
+		cachedMs += elapsedMs(start);
+		path.clear();
+
+		if(i % 50 == 49) {
+			// a random arc of a random node gets a new weight
+			int from = rand() % (side * side);
+			Arc const &arc = graph.nodeArray()[from]->arcList().front();
+			graph.setArcWeight(from, arc.node()->index(), kSpacing + rand() % (2 * kSpacing));
+		}
+	}
+
+	PathCache<pair<string, int>, int>::Stats stats = cache.stats();
+	printf("\n%d aStar queries between %u nodes of %d: %.1f us searching, %.1f us through PathCache\n", queryCount,
+		(unsigned)busy.size(), side * side, 1000.0 * plainMs / queryCount, 1000.0 * cachedMs / queryCount);
+	printf("hit rate %.2f (%u whole, %u part of a longer path), %u invalidated, %u entries in %u KB\n", stats.hitRate(),
+		(unsigned)stats.hits, (unsigned)stats.subpathHits, (unsigned)stats.invalidated, (unsigned)stats.entries,
+		(unsigned)(stats.bytes / 1024));
+}
+
+//builds and destroys a grid with and without pooled allocation.
+void benchmarkArena(int side) {
+	printf("\n%d node grid %10s %10s %12s %12s %10s\n", side * side, "build", "destroy", "allocations",
+		"system", "MB");
+	char const *names[3] = { "one by one", "pooled", "pooled, grown" };
+	for(int run = 0; run != 3; run++) {
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		// the last run starts with no slots and lets the graph grow.
+		GraphType *graph = new GraphType(run == 2 ? 0 : side * side, run != 0);
+		buildGrid(*graph, side);
+		double buildMs = elapsedMs(start);
+		PoolStats stats = graph->allocatorStats();
+
+		start = chrono::high_resolution_clock::now();
+		delete graph;
+		double destroyMs = elapsedMs(start);
+
+		printf("%20s %10.1f %10.1f %12u %12u %10.1f\n", names[run], buildMs, destroyMs,
+			(unsigned)stats.allocations, (unsigned)stats.blocks, stats.reservedBytes / 1048576.0);
+	}
+}
+
+//Graph's searches call their visitor through a pointer; search()
+//can inline it. Both count the nodes expanded here.
+size_t visitedNodes = 0;
+
+void countNode(Node *) {
+	visitedNodes++;
+}
+
+struct CountNode {
+	void operator()(Node *) const {
+		visitedNodes++;
+	}
+};
+
+//times the policy-based search() against Graph's own searches, and
+//its weighted and greedy forms against A*.
+void benchmarkPolicy(int side, int queryCount) {
+	GraphType graph(side * side);
+	buildGrid(graph, side);
+	GraphType::Euclidean euclidean(graph);
+
+	GraphType::Context context(graph.getMaxNodes());
+	LazyPriorityQueue<int> lazy;
+	vector<Node*> path;
+
+	const int kRuns = 7;
+	char const *names[kRuns] = { "Graph::ucs", "dijkstra", "Graph::aStar", "astar", "astar lazy", "weighted 1.5",
+		"greedy" };
+	double ms[kRuns] = { 0.0 };
+	double cost[kRuns] = { 0.0 };
+	size_t expanded[kRuns] = { 0 };
+	int mismatches = 0;
+
+	srand(29);
+	for(int i = 0; i != queryCount; i++) {
+		Node* pStart = graph.nodeArray()[rand() % (side * side)];
+		Node* pDest = graph.nodeArray()[rand() % (side * side)];
+		int costs[kRuns];
+
+		for(int run = 0; run != kRuns; run++) {
+			visitedNodes = 0;
+			chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+			switch(run) {
+			case 0:
+				graph.ucs(context, pStart, pDest, countNode, path);
+				costs[run] = context.cost(pDest->index());
+				break;
+			case 1:
+				costs[run] = search(graph, context, context.open(), pStart, pDest, ZeroHeuristic<int>(), CountNode(), path);
+				break;
+			case 2:
+				graph.aStar(context, pStart, pDest, countNode, path);
+				costs[run] = context.cost(pDest->index());
+				break;
+			case 3:
+				costs[run] = search(graph, context, context.open(), pStart, pDest, euclidean, CountNode(), path);
+				break;
+			case 4:
+				costs[run] = search(graph, context, lazy, pStart, pDest, euclidean, CountNode(), path);
+				break;
+			case 5:
+				costs[run] = search(graph, context, context.open(), pStart, pDest,
+					WeightedHeuristic<GraphType::Euclidean, int>(euclidean, 1.5), CountNode(), path);
+				break;
+			default:
+				costs[run] = search(graph, context, context.open(), pStart, pDest,
+					GreedyHeuristic<GraphType::Euclidean, int>(euclidean), CountNode(), path);
+				break;
+			}
+			ms[run] += elapsedMs(start);
+			expanded[run] += visitedNodes;
+			cost[run] += costs[run];
+			path.clear();
+		}
+		for(int run = 1; run != 5; run++) {
+			if(costs[run] != costs[0]) {
+				mismatches++;
+			}
+		}
+	}
+
+	printf("\n%d random queries on %d nodes (per query)\n", queryCount, side * side);
+	printf("%12s %12s %10s %10s\n", "search", "expanded", "ms", "cost");
+	for(int run = 0; run != kRuns; run++) {
+		printf("%12s %12.0f %10.2f %10.3f\n", names[run], double(expanded[run]) / queryCount, ms[run] / queryCount,
+			cost[run] / cost[0]);
+	}
+	printf("exact searches disagreeing with ucs: %d\n", mismatches);
+}
+
+//what AnytimeAStar's path costs under an expansion budget, a time
+//budget and none, next to aStar's.
+void benchmarkAnytime(int side, int queryCount) {
+	typedef AnytimeAStar<pair<string, int>, int> Anytime;
+	GraphType graph(side * side);
+	buildGrid(graph, side);
+
+	GraphType::Context context(graph.getMaxNodes());
+	Anytime anytime(graph);
+	vector<Node*> path;
+
+	const int kRuns = 3;
+	char const *names[kRuns] = { "500 exp", "1 ms", "to the end" };
+	Anytime::Budget budgets[kRuns] = { Anytime::expansions(500), Anytime::milliseconds(1.0), Anytime::unlimited() };
+	double ratio[kRuns] = { 0.0 }, bound[kRuns] = { 0.0 }, expanded[kRuns] = { 0.0 }, ms[kRuns] = { 0.0 };
+	int answered[kRuns] = { 0 };
+	double aStarExpanded = 0.0, aStarMs = 0.0;
+	int queries = 0;
+
+	srand(37);
+	while(queries != queryCount) {
+		Node* pStart = graph.nodeArray()[rand() % (side * side)];
+		Node* pDest = graph.nodeArray()[rand() % (side * side)];
+
+		visitedNodes = 0;
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		graph.aStar(context, pStart, pDest, countNode, path);
+		aStarMs += elapsedMs(start);
+		path.clear();
+		int shortest = context.cost(pDest->index());
+		if(shortest == 0 || !context.reached(pDest->index())) {
+			continue;
+		}
+		aStarExpanded += visitedNodes;
+		queries++;
+
+		for(int run = 0; run != kRuns; run++) {
+			start = chrono::high_resolution_clock::now();
+			Anytime::Result result = anytime.search(pStart->index(), pDest->index(), budgets[run]);
+			ms[run] += elapsedMs(start);
+			expanded[run] += result.totalExpanded;
+			if(result.cost != GraphType::Context::infinity()) {
+				answered[run]++;
+				ratio[run] += double(result.cost) / shortest;
+				bound[run] += result.bound;
+			}
+		}
+	}
+
+	printf("\n%d random queries on %d nodes, aStar expands %.0f in %.2f ms (per query)\n", queryCount, side * side,
+		aStarExpanded / queryCount, aStarMs / queryCount);
+	printf("%12s %10s %12s %10s %10s %10s\n", "budget", "answered", "expanded", "ms", "cost", "bound");
+	for(int run = 0; run != kRuns; run++) {
+		int count = answered[run] > 0 ? answered[run] : 1;
+		printf("%12s %10d %12.0f %10.2f %10.3f %10.3f\n", names[run], answered[run], expanded[run] / queryCount,
+			ms[run] / queryCount, ratio[run] / count, bound[run] / count);
+	}
+}
+
+//runs one long aStar in time slices, as the demo does between
+//frames, and reports how long the slices really took.
+void benchmarkSlices(int side, double sliceMicroseconds) {
+	GraphType graph(side * side);
+	buildGrid(graph, side);
+	Node* pStart = graph.nodeArray()[0];
+	Node* pDest = graph.nodeArray()[side * side - 1];
+	GraphType::Euclidean euclidean(graph);
+
+	GraphType::Context context(graph.getMaxNodes());
+	vector<Node*> path;
+	chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+	graph.aStar(context, pStart, pDest, ignoreNode, path);
+	double wholeMs = elapsedMs(start);
+	size_t wholeLength = path.size();
+	path.clear();
+
+	SearchTask<pair<string, int>, int> task(graph, context);
+	int slices = 0;
+	double longestMs = 0.0, totalMs = 0.0;
+	task.startAStar(pStart, pDest, euclidean, ignoreNode);
+	while(task.running()) {
+		start = chrono::high_resolution_clock::now();
+		task.stepFor(sliceMicroseconds);
+		double ms = elapsedMs(start);
+		slices++;
+		totalMs += ms;
+		if(ms > longestMs) {
+			longestMs = ms;
+		}
+	}
+	task.path(path);
+
+	printf("\naStar across %d nodes: %.1f ms in one go, %d slices of %.0f us: longest %.2f ms, %.1f ms in all, paths %s\n",
+		side * side, wholeMs, slices, sliceMicroseconds, longestMs, totalMs, path.size() == wholeLength ? "agree" : "DIFFER");
+}
+
+//the node queries a view makes (picking, snapping, culling), by
+//scanning every node and through a SpatialIndex.
+void benchmarkSpatial(int side, int queryCount) {
+	GraphType graph(side * side);
+	buildGrid(graph, side);
+	Node** nodes = graph.nodeArray();
+	int count = side * side;
+	float extent = float(side * kSpacing);
+	float radius = 3.0f * kSpacing;
+	float width = 80.0f * kSpacing, height = 60.0f * kSpacing;
+
+	chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+	SpatialIndex<pair<string, int>, int> index(graph, 2.0f * kSpacing);
+	double buildMs = elapsedMs(start);
+
+	vector<float> xs(queryCount), ys(queryCount);
+	srand(41);
+	for(int q = 0; q != queryCount; q++) {
+		xs[q] = extent * rand() / RAND_MAX;
+		ys[q] = extent * rand() / RAND_MAX;
+	}
+
+	// the scans
+	vector<int> scanNearest(queryCount);
+	vector<size_t> scanRadius(queryCount), scanRect(queryCount);
+	double scanMs[3];
+	start = chrono::high_resolution_clock::now();
+	for(int q = 0; q != queryCount; q++) {
+		float best = 0.0f;
+		scanNearest[q] = -1;
+		for(int i = 0; i != count; i++) {
+			float dx = nodes[i]->x() - xs[q], dy = nodes[i]->y() - ys[q];
+			if(scanNearest[q] == -1 || dx * dx + dy * dy < best) {
+				best = dx * dx + dy * dy;
+				scanNearest[q] = i;
+			}
+		}
+	}
+	scanMs[0] = elapsedMs(start);
+	start = chrono::high_resolution_clock::now();
+	for(int q = 0; q != queryCount; q++) {
+		scanRadius[q] = 0;
+		for(int i = 0; i != count; i++) {
+			float dx = nodes[i]->x() - xs[q], dy = nodes[i]->y() - ys[q];
+			if(dx * dx + dy * dy <= radius * radius) {
+				scanRadius[q]++;
+			}
+		}
+	}
+	scanMs[1] = elapsedMs(start);
+	start = chrono::high_resolution_clock::now();
+	for(int q = 0; q != queryCount; q++) {
+		scanRect[q] = 0;
+		for(int i = 0; i != count; i++) {
+			if(nodes[i]->x() >= xs[q] && nodes[i]->x() <= xs[q] + width && nodes[i]->y() >= ys[q] && nodes[i]->y() <= ys[q] + height) {
+				scanRect[q]++;
+			}
+		}
+	}
+	scanMs[2] = elapsedMs(start);
+
+	// the index
+	int mismatches = 0;
+	double indexMs[3];
+	vector<int> found;
+	start = chrono::high_resolution_clock::now();
+	for(int q = 0; q != queryCount; q++) {
+		int node = index.nearest(xs[q], ys[q]);
+		float dx = nodes[node]->x() - xs[q], dy = nodes[node]->y() - ys[q];
+		float ex = nodes[scanNearest[q]]->x() - xs[q], ey = nodes[scanNearest[q]]->y() - ys[q];
+		if(dx * dx + dy * dy != ex * ex + ey * ey) {
+			mismatches++;
+		}
+	}
+	indexMs[0] = elapsedMs(start);
+	start = chrono::high_resolution_clock::now();
+	for(int q = 0; q != queryCount; q++) {
+		found.clear();
+		index.withinRadius(xs[q], ys[q], radius, found);
+		if(found.size() != scanRadius[q]) {
+			mismatches++;
+		}
+	}
+	indexMs[1] = elapsedMs(start);
+	start = chrono::high_resolution_clock::now();
+	for(int q = 0; q != queryCount; q++) {
+		found.clear();
+		index.inRectangle(xs[q], ys[q], xs[q] + width, ys[q] + height, found);
+		if(found.size() != scanRect[q]) {
+			mismatches++;
+		}
+	}
+	indexMs[2] = elapsedMs(start);
+
+	printf("\n%d point queries on %d nodes, index built in %.1f ms (us per query)\n", queryCount, count, buildMs);
+	printf("%12s %10s %10s\n", "query", "scan", "index");
+	char const *names[3] = { "nearest", "radius", "rectangle" };
+	for(int k = 0; k != 3; k++) {
+		printf("%12s %10.2f %10.2f\n", names[k], 1000.0 * scanMs[k] / queryCount, 1000.0 * indexMs[k] / queryCount);
+	}
+	printf("index answers disagreeing with the scan: %d\n", mismatches);
+}
+
+//keeps a D* Lite plan up to date while arcs change and the start
+//moves, and checks each replan against a fresh ucs.
+void benchmarkDStar(int side, int rounds) {
+	GraphType graph(side * side);
+	buildGrid(graph, side);
+	Node** nodes = graph.nodeArray();
+	int count = side * side;
+	const int infinity = GraphType::Context::infinity();
+	const int kChanges = 8;
+
+	GraphType::Context context(graph.getMaxNodes());
+	DStarLite<pair<string, int>, int> planner(graph);
+	vector<Node*> path;
+	// arcs taken out, to be put back later: (from, to, weight)
+	vector<pair<pair<int, int>, int> > removed;
+
+	srand(43);
+	int start = 0, goal = count - 1;
+	chrono::high_resolution_clock::time_point clock = chrono::high_resolution_clock::now();
+	planner.plan(start, goal);
+	double planMs = elapsedMs(clock);
+	size_t planExpanded = planner.expanded();
+
+	double replanMs = 0.0, ucsMs = 0.0;
+	size_t replanExpanded = 0, ucsExpanded = 0;
+	int mismatches = 0, replans = 0;
+
+	for(int round = 0; round != rounds; round++) {
+		for(int change = 0; change != kChanges; change++) {
+			int kind = rand() % 3;
+			if(kind == 2 && !removed.empty()) {
+				// put an arc back
+				int which = rand() % removed.size();
+				int from = removed[which].first.first, to = removed[which].first.second;
+				graph.addArc(from, to, removed[which].second);
+				planner.arcChanged(from, to, infinity);
+				removed[which] = removed.back();
+				removed.pop_back();
+				continue;
+			}
+
+			Node* pNode = nodes[rand() % count];
+			if(pNode->arcList().empty()) {
+				continue;
+			}
+			Node::ArcList::const_iterator iter = pNode->arcList().begin();
+			advance(iter, rand() % pNode->arcList().size());
+			int from = pNode->index(), to = iter->node()->index(), oldWeight = iter->weight();
+
+			if(kind == 1) {
+				graph.removeArc(from, to);
+				removed.push_back(make_pair(make_pair(from, to), oldWeight));
+			}
+			else {
+				// weights stay at least kSpacing, so the heuristic stays admissible.
+				graph.setArcWeight(from, to, kSpacing + rand() % (4 * kSpacing));
+			}
+			planner.arcChanged(from, to, oldWeight);
+		}
+
+		// step along the path, or pick a new goal once there.
+		int next = planner.next(start);
+		if(next == -1) {
+			start = rand() % count;
+			goal = rand() % count;
+			planner.plan(start, goal);
+		}
+		else {
+			start = next;
+			planner.moveStart(start);
+		}
+
+		clock = chrono::high_resolution_clock::now();
+		int cost = planner.replan();
+		replanMs += elapsedMs(clock);
+		replanExpanded += planner.expanded();
+		replans++;
+
+		visitedNodes = 0;
+		clock = chrono::high_resolution_clock::now();
+		graph.ucs(context, nodes[start], nodes[goal], countNode, path);
+		ucsMs += elapsedMs(clock);
+		ucsExpanded += visitedNodes;
+		path.clear();
+		if(cost != context.cost(goal)) {
+			mismatches++;
+		}
+	}
+
+	printf("\nD* Lite on %d nodes: plan %.2f ms, %u expanded; %d rounds of %d arc changes (per round)\n", count,
+		planMs, (unsigned)planExpanded, rounds, kChanges);
+	printf("%12s %10s %12s\n", "", "ms", "expanded");
+	printf("%12s %10.3f %12.0f\n", "replan", replanMs / replans, double(replanExpanded) / replans);
+	printf("%12s %10.3f %12.0f\n", "ucs", ucsMs / replans, double(ucsExpanded) / replans);
+	printf("replans disagreeing with ucs: %d\n", mismatches);
+}
+
+//compares how many nodes the one-way and bidirectional searches
+//expand on the same random queries.
+void benchmarkBidirectional(int side, int queryCount) {
+	GraphType graph(side * side);
+	buildGrid(graph, side);
+	CSRGraph<int> frozen = graph.freeze();
+	CSRGraph<int> reverse = frozen.transpose();
+
+	CSRGraph<int>::Context context(frozen.nodeCount());
+	BidirectionalSearch<int> bidirectional(frozen, reverse);
+	vector<CSRGraph<int>::NodeId> path;
+
+	// expansions and milliseconds for ucs, aStar, bidirectional ucs
+	// and bidirectional aStar.
+	double expanded[4] = { 0.0, 0.0, 0.0, 0.0 };
+	double ms[4] = { 0.0, 0.0, 0.0, 0.0 };
+
+	srand(11);
+	for(int i = 0; i != queryCount; i++) {
+		CSRGraph<int>::NodeId from = rand() % frozen.nodeCount();
+		CSRGraph<int>::NodeId to = rand() % frozen.nodeCount();
+
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		frozen.ucs(context, from, to, path);
+		ms[0] += elapsedMs(start);
+		expanded[0] += context.expanded();
+		path.clear();
+
+		start = chrono::high_resolution_clock::now();
+		frozen.aStar(context, from, to, path);
+		ms[1] += elapsedMs(start);
+		expanded[1] += context.expanded();
+		path.clear();
+
+		start = chrono::high_resolution_clock::now();
+		bidirectional.ucs(from, to, path);
+		ms[2] += elapsedMs(start);
+		expanded[2] += bidirectional.stats().expanded();
+		path.clear();
+
+		start = chrono::high_resolution_clock::now();
+		bidirectional.aStar(from, to, path);
+		ms[3] += elapsedMs(start);
+		expanded[3] += bidirectional.stats().expanded();
+		path.clear();
+	}
+
+	char const *names[4] = { "ucs", "aStar", "bidir ucs", "bidir aStar" };
+	printf("\n%d random queries on %d nodes (per query)\n", queryCount, side * side);
+	printf("%12s %12s %10s %10s\n", "search", "expanded", "vs 1-way", "ms");
+	for(int i = 0; i != 4; i++) {
+		printf("%12s %12.0f %10.2f %10.2f\n", names[i], expanded[i] / queryCount,
+			expanded[i] / expanded[i % 2], ms[i] / queryCount);
+	}
+}
+
+//the per-child estimate that block scores are checked against;
+//for euclidean it is heuristic_eval itself.
+template<DistanceMetric Metric>
+int perChild(CSRGraph<int> const &, CoordinateHeuristic<int, Metric> const &heuristic, CSRGraph<int>::NodeId node, CSRGraph<int>::NodeId dest) {
+	return heuristic(node, dest);
+}
+
+int perChild(CSRGraph<int> const &graph, CoordinateHeuristic<int, METRIC_EUCLIDEAN> const &, CSRGraph<int>::NodeId node, CSRGraph<int>::NodeId dest) {
+	return graph.heuristic_eval(node, dest);
+}
+
+//scores every node's neighbours towards each destination one child
+//at a time and then in blocks at each kernel level, adding the times
+//to ms (per child, then by level; -1 for a level the CPU lacks).
+//Returns the block scores that differ from the per-child ones.
+template<DistanceMetric Metric>
+int scoreNeighbours(CSRGraph<int> const &graph, vector<CSRGraph<int>::NodeId> const &dests, double ms[4]) {
+	typedef CSRGraph<int>::NodeId NodeId;
+	CoordinateHeuristic<int, Metric> heuristic(graph);
+	vector<NodeId> targets(graph.arcCount());
+	for(NodeId arc = 0; arc != graph.arcCount(); arc++) {
+		targets[arc] = graph.target(arc);
+	}
+	vector<int> expected(graph.arcCount()), scores(graph.arcCount());
+	int mismatches = 0;
+
+	for(size_t d = 0; d != dests.size(); d++) {
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		for(NodeId arc = 0; arc != graph.arcCount(); arc++) {
+			expected[arc] = perChild(graph, heuristic, targets[arc], dests[d]);
+		}
+		ms[0] += elapsedMs(start);
+
+		for(int level = HeuristicKernel::SCALAR; level <= HeuristicKernel::AVX2; level++) {
+			HeuristicKernel::limitLevel(static_cast<HeuristicKernel::Level>(level));
+			if(HeuristicKernel::level() != level) {
+				ms[level + 1] = -1.0;
+				continue;
+			}
+			start = chrono::high_resolution_clock::now();
+			for(NodeId node = 0; node != graph.nodeCount(); node++) {
+				NodeId begin = graph.arcBegin(node), end = graph.arcEnd(node);
+				if(begin != end) {
+					heuristic.block(&targets[begin], end - begin, dests[d], &scores[begin]);
+				}
+			}
+			ms[level + 1] += elapsedMs(start);
+			for(NodeId arc = 0; arc != graph.arcCount(); arc++) {
+				if(scores[arc] != expected[arc]) {
+					mismatches++;
+				}
+			}
+		}
+	}
+	HeuristicKernel::limitLevel(HeuristicKernel::AVX2);
+	return mismatches;
+}
+
+//times HeuristicKernel's levels against scoring one child at a time.
+void benchmarkKernel(int side, int destCount) {
+	CSRGraph<int> graph = generateGeometric(side * side, 12.0, 5);
+
+	vector<CSRGraph<int>::NodeId> dests(destCount);
+	srand(43);
+	for(int d = 0; d != destCount; d++) {
+		dests[d] = rand() % graph.nodeCount();
+	}
+
+	char const *names[4] = { "euclidean", "octile", "manhattan", "squared" };
+	double ms[4][4] = { { 0.0 } };
+	int mismatches = scoreNeighbours<METRIC_EUCLIDEAN>(graph, dests, ms[0]);
+	mismatches += scoreNeighbours<METRIC_OCTILE>(graph, dests, ms[1]);
+	mismatches += scoreNeighbours<METRIC_MANHATTAN>(graph, dests, ms[2]);
+	mismatches += scoreNeighbours<METRIC_SQUARED>(graph, dests, ms[3]);
+
+	printf("\nneighbour scoring on %u nodes, %u arcs, %d destinations (ns per arc)\n", graph.nodeCount(),
+		graph.arcCount(), destCount);
+	printf("%12s %10s %10s %10s %10s\n", "metric", "per child", "scalar", "sse2", "avx2");
+	double arcs = double(graph.arcCount()) * destCount;
+	for(int m = 0; m != 4; m++) {
+		printf("%12s", names[m]);
+		for(int k = 0; k != 4; k++) {
+			if(ms[m][k] < 0.0) {
+				printf(" %10s", "-");
+			}
+			else {
+				printf(" %10.2f", 1e6 * ms[m][k] / arcs);
+			}
+		}
+		printf("\n");
+	}
+	printf("block scores disagreeing with per-child: %d\n", mismatches);
+}
+
+//compares aStar with heuristic_eval against aStar with landmarks.
+void benchmarkLandmarks(int side, int count) {
+	const int queryCount = 200;
+
+	GraphType graph(side * side);
+	buildGrid(graph, side);
+	CSRGraph<int> frozen = graph.freeze();
+
+	chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+	Landmarks<int> full(frozen, count);
+	double fullMs = elapsedMs(start);
+
+	start = chrono::high_resolution_clock::now();
+	Landmarks<int> quantized(frozen, count, Landmarks<int>::QUANTIZED);
+	double quantizedMs = elapsedMs(start);
+
+	CSRGraph<int>::Context context(frozen.nodeCount());
+	vector<CSRGraph<int>::NodeId> path;
+
+	// expansions and milliseconds for heuristic_eval, full and
+	// quantized landmarks.
+	double expanded[3] = { 0.0, 0.0, 0.0 };
+	double ms[3] = { 0.0, 0.0, 0.0 };
+
+	srand(17);
+	for(int i = 0; i != queryCount; i++) {
+		CSRGraph<int>::NodeId from = rand() % frozen.nodeCount();
+		CSRGraph<int>::NodeId to = rand() % frozen.nodeCount();
+
+		start = chrono::high_resolution_clock::now();
+		frozen.aStar(context, from, to, path);
+		ms[0] += elapsedMs(start);
+		expanded[0] += context.expanded();
+		path.clear();
+
+		start = chrono::high_resolution_clock::now();
+		frozen.aStar(context, from, to, path, full);
+		ms[1] += elapsedMs(start);
+		expanded[1] += context.expanded();
+		path.clear();
+
+		start = chrono::high_resolution_clock::now();
+		frozen.aStar(context, from, to, path, quantized);
+		ms[2] += elapsedMs(start);
+		expanded[2] += context.expanded();
+		path.clear();
+	}
+
+	printf("\n%d landmarks on %d nodes: full %.0f ms, %.1f MB; 16-bit %.0f ms, %.1f MB\n", count, side * side,
+		fullMs, full.memoryUsage() / 1048576.0, quantizedMs, quantized.memoryUsage() / 1048576.0);
+	printf("%12s %12s %10s %10s\n", "heuristic", "expanded", "vs euclid", "ms");
+	char const *names[3] = { "euclidean", "alt", "alt 16-bit" };
+	for(int i = 0; i != 3; i++) {
+		printf("%12s %12.0f %10.2f %10.2f\n", names[i], expanded[i] / queryCount, expanded[i] / expanded[0],
+			ms[i] / queryCount);
+	}
+}
+
+//the octile distance on a map of the given width, in the same
+//units as JumpPointSearch's default costs.
+struct Octile {
+	int width;
+	explicit Octile(int mapWidth) : width(mapWidth) {}
+
+	int operator()(int node, int dest) const {
+		int dx = abs(node % width - dest % width), dy = abs(node / width - dest / width);
+		return dx < dy ? 14 * dx + 10 * (dy - dx) : 14 * dy + 10 * (dx - dy);
+	}
+};
+
+//compares aStar on a Graph of an 8-connected map against Jump Point
+//Search on the same map as a GridMap.
+void benchmarkJumpPoint(int side) {
+	const int queryCount = 50;
+
+	// scatter walls: 1-cell thick, up to a tenth of the map long.
+	srand(19);
+	GridMap map(side, side);
+	for(int wall = 0; wall != side / 2; wall++) {
+		int x = rand() % side, y = rand() % side, length = 1 + rand() % (side / 10 + 1);
+		bool across = rand() % 2 == 0;
+		for(int i = 0; i != length && x < side && y < side; i++) {
+			map.setWalkable(x, y, false);
+			if(across) {
+				x++;
+			}
+			else {
+				y++;
+			}
+		}
+	}
+
+	// the same moves as GridMap: no diagonal past a blocked cell.
+	GraphType graph(side * side);
+	for(int i = 0; i != side * side; i++) {
+		graph.addNode(pair<string, int>("", 0), i);
+		graph.nodeArray()[i]->setPosition(i % side, i / side);
+	}
+	size_t arcs = 0;
+	for(int y = 0; y != side; y++) {
+		for(int x = 0; x != side; x++) {
+			for(int dy = -1; dy <= 1 && map.walkable(x, y); dy++) {
+				for(int dx = -1; dx <= 1; dx++) {
+					if((dx != 0 || dy != 0) && map.walkable(x + dx, y + dy)
+						&& (dx == 0 || dy == 0 || (map.walkable(x + dx, y) && map.walkable(x, y + dy)))) {
+						graph.addArc(map.id(x, y), map.id(x + dx, y + dy), dx != 0 && dy != 0 ? 14 : 10);
+						arcs++;
+					}
+				}
+			}
+		}
+	}
+
+	GraphType::Context context(side * side);
+	JumpPointSearch<int> jps(map);
+	vector<Node*> path;
+	vector<int> cells;
+	double aStarMs = 0.0, jpsMs = 0.0, aStarExpanded = 0.0, jpsExpanded = 0.0;
+	int wrong = 0;
+
+	for(int i = 0; i != queryCount; i++) {
+		int from, to;
+		do {
+			from = rand() % (side * side);
+			to = rand() % (side * side);
+		} while(!map.walkable(map.x(from), map.y(from)) || !map.walkable(map.x(to), map.y(to)));
+
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		graph.aStar(context, graph.nodeArray()[from], graph.nodeArray()[to], ignoreNode, path, Octile(side));
+		aStarMs += elapsedMs(start);
+		int aStarCost = context.cost(to);
+		path.clear();
+
+		// Graph::aStar has no expansion count; every marked node
+		// was queued.
+		for(int node = 0; node != side * side; node++) {
+			aStarExpanded += context.marked(node) && !context.open().contains(node);
+		}
+
+		start = chrono::high_resolution_clock::now();
+		int jpsCost = jps.search(from, to, cells);
+		jpsMs += elapsedMs(start);
+		jpsExpanded += jps.context().expanded();
+		cells.clear();
+
+		if(jpsCost != aStarCost) {
+			wrong++;
+		}
+	}
+
+	// a node, its list of arcs and its list of incoming nodes.
+	double graphBytes = sizeof(Node) + (arcs * (sizeof(Arc) + 2 * sizeof(void*) + sizeof(Node*))) / double(side * side);
+	printf("\n%dx%d map with walls, %d queries (per query)\n", side, side, queryCount);
+	printf("%12s %12s %10s %12s\n", "search", "expanded", "ms", "B/cell");
+	printf("%12s %12.0f %10.2f %12.1f\n", "aStar", aStarExpanded / queryCount, aStarMs / queryCount, graphBytes);
+	printf("%12s %12.0f %10.2f %12.3f\n", "jps", jpsExpanded / queryCount, jpsMs / queryCount,
+		double(map.memoryUsage()) / (side * side));
+	printf("%d jps costs differ from aStar\n", wrong);
+}
+
+//preprocesses a grid into a contraction hierarchy and times queries
+//on it against plain ucs.
+void benchmarkHierarchy(int side, int queryCount) {
+	GraphType graph(side * side);
+	buildGrid(graph, side);
+	CSRGraph<int> frozen = graph.freeze();
+
+	chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+	ContractionHierarchy<int> hierarchy = ContractionHierarchy<int>::build(frozen);
+	double buildMs = elapsedMs(start);
+
+	CSRGraph<int>::Context context(frozen.nodeCount()), forward, backward;
+	vector<CSRGraph<int>::NodeId> path;
+	double ucsMs = 0.0, chMs = 0.0, settled = 0.0;
+	int wrong = 0;
+
+	srand(13);
+	for(int i = 0; i != queryCount; i++) {
+		CSRGraph<int>::NodeId from = rand() % frozen.nodeCount();
+		CSRGraph<int>::NodeId to = rand() % frozen.nodeCount();
+
+		start = chrono::high_resolution_clock::now();
+		int expected = frozen.ucs(context, from, to, path);
+		ucsMs += elapsedMs(start);
+		path.clear();
+
+		start = chrono::high_resolution_clock::now();
+		int cost = hierarchy.query(forward, backward, from, to, path);
+		chMs += elapsedMs(start);
+		settled += forward.expanded() + backward.expanded();
+		path.clear();
+
+		if(cost != expected) {
+			wrong++;
+		}
+	}
+
+	printf("\ncontraction hierarchy of %d nodes: built in %.0f ms, %u shortcuts, %.1f B/arc\n", side * side,
+		buildMs, hierarchy.shortcutCount(), double(hierarchy.memoryUsage()) / frozen.arcCount());
+	printf("%d queries: ucs %.1f us, ch %.1f us (%.0f nodes settled), %d wrong\n", queryCount,
+		1000.0 * ucsMs / queryCount, 1000.0 * chMs / queryCount, settled / queryCount, wrong);
+}
+
+//fills a many-to-many table with DistanceTable, by rows of
+//Dijkstra and by contraction hierarchy buckets, and estimates what
+//one ucs call per entry would take from a sample of them.
+void benchmarkTable(int side, int sourceCount) {
+	GraphType graph(side * side);
+	buildGrid(graph, side);
+	CSRGraph<int> frozen = graph.freeze();
+	ContractionHierarchy<int> hierarchy = ContractionHierarchy<int>::build(frozen);
+
+	int targetCount = 10 * sourceCount;
+	vector<CSRGraph<int>::NodeId> sources(sourceCount), targets(targetCount);
+	srand(31);
+	for(int i = 0; i != sourceCount; i++) {
+		sources[i] = rand() % frozen.nodeCount();
+	}
+	for(int j = 0; j != targetCount; j++) {
+		targets[j] = rand() % frozen.nodeCount();
+	}
+
+	const int kSample = 200;
+	CSRGraph<int>::Context context(frozen.nodeCount());
+	vector<CSRGraph<int>::NodeId> path;
+	chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+	for(int i = 0; i != kSample; i++) {
+		frozen.ucs(context, sources[i % sourceCount], targets[i % targetCount], path);
+		path.clear();
+	}
+	double pairwiseMs = elapsedMs(start) / kSample * sourceCount * targetCount;
+
+	DistanceTable<int> table;
+	DistanceTable<int>::Matrix rows, buckets;
+	DistanceTable<int>::Stats rowStats = table.compute(frozen, &sources[0], sourceCount, &targets[0], targetCount, rows);
+	DistanceTable<int>::Stats bucketStats = table.compute(hierarchy, &sources[0], sourceCount, &targets[0], targetCount,
+		buckets);
+
+	int wrong = 0;
+	for(int i = 0; i != sourceCount; i++) {
+		for(int j = 0; j != targetCount; j++) {
+			if(rows.at(i, j) != buckets.at(i, j)) {
+				wrong++;
+			}
+		}
+	}
+
+	printf("\n%dx%d table on %d nodes, %d threads (ms)\n", sourceCount, targetCount, side * side, table.threadCount());
+	printf("%12s %12.0f (estimated from %d calls)\n", "ucs per pair", pairwiseMs, kSample);
+	printf("%12s %12.1f %12u settled\n", "ucs per row", 1000.0 * rowStats.seconds, (unsigned)rowStats.settled);
+	printf("%12s %12.1f %12u settled, %u bucket entries, %d differ\n", "ch buckets", 1000.0 * bucketStats.seconds,
+		(unsigned)bucketStats.settled, (unsigned)bucketStats.bucketEntries, wrong);
+}
+
+//writes the grid as nodes.txt / arcs.txt style text and as a
+//graph file, then times loading each and searching the result.
+void benchmarkGraphFile(int side) {
+	GraphType graph(side * side);
+	buildGrid(graph, side);
+	CSRGraph<int> frozen = graph.freeze();
+	int nodes = side * side;
+
+	{
+		ofstream nodeFile("benchmark_nodes.txt"), arcFile("benchmark_arcs.txt");
+		for(int node = 0; node != nodes; node++) {
+			nodeFile << "n" << node << "\n";
+			for(CSRGraph<int>::NodeId arc = frozen.arcBegin(node); arc != frozen.arcEnd(node); arc++) {
+				int target = frozen.target(arc);
+				if(target > node) {
+					arcFile << node << ' ' << target << ' ' << frozen.weight(arc) << ' ' << frozen.x(node) << ' '
+						<< frozen.y(node) << ' ' << frozen.x(target) << ' ' << frozen.y(target) << "\n";
+				}
+			}
+		}
+	}
+	vector<string> names(nodes);
+	for(int node = 0; node != nodes; node++) {
+		names[node] = "n" + to_string(static_cast<long long>(node));
+	}
+	writeGraphFile("benchmark_graph.bin", frozen, names);
+
+	// the demo's loader: parse both files into a Graph, then freeze it.
+	chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+	GraphType parsed(nodes);
+	ifstream nodeFile("benchmark_nodes.txt");
+	pair<string, int> c("", 0);
+	for(int i = 0; nodeFile >> c.first; i++) {
+		parsed.addNode(c, i);
+	}
+	ifstream arcFile("benchmark_arcs.txt");
+	int from, to, weight, startX, startY, endX, endY;
+	while(arcFile >> from >> to >> weight >> startX >> startY >> endX >> endY) {
+		parsed.addDualArc(from, to, weight, startX, startY, endX, endY);
+	}
+	CSRGraph<int> parsedFrozen = parsed.freeze();
+	double textMs = elapsedMs(start);
+
+	ArcImporter<int> importer;
+	CSRGraph<int> imported;
+	importer.load("benchmark_arcs.txt", imported, nodes);
+
+	start = chrono::high_resolution_clock::now();
+	MappedGraph<int> mapped;
+	bool opened = mapped.open("benchmark_graph.bin");
+	double mapMs = elapsedMs(start);
+
+	CSRGraph<int>::Context context(nodes);
+	vector<CSRGraph<int>::NodeId> path;
+	int expected = parsedFrozen.ucs(context, 0, nodes - 1, path);
+	path.clear();
+
+	start = chrono::high_resolution_clock::now();
+	int cost = opened ? mapped.graph().ucs(context, 0, nodes - 1, path) : -1;
+	double searchMs = elapsedMs(start);
+
+	path.clear();
+	int importedCost = imported.ucs(context, 0, nodes - 1, path);
+
+	printf("\ngraph file of %d nodes, %.1f MB: text load %.0f ms, mapped in %.2f ms, then ucs %.1f ms (%s)\n", nodes,
+		mapped.fileSize() / 1048576.0, textMs, mapMs, searchMs, cost == expected ? "same cost" : "WRONG");
+	printf("ArcImporter, %d threads: %.1f MB in %.0f ms, %.1f MB/s (%s)\n", importer.workerCount(),
+		importer.stats().bytes / 1048576.0, 1000.0 * importer.stats().seconds, importer.stats().megabytesPerSecond(),
+		importedCost == expected ? "same cost" : "WRONG");
+
+	mapped.close();
+	remove("benchmark_nodes.txt");
+	remove("benchmark_arcs.txt");
+	remove("benchmark_graph.bin");
+}
+
+int main(int argc, char *argv[]) {
+	vector<int> sides;
+	int legacyMax = 250000;
+	int batchSize = 2000;
+	int bidirCount = 200;
+	int chCount = 1000;
+	int chSide = 150;
+	int landmarkCount = 16;
+	int jpsSide = 512;
+	int fileSide = 317;
+	int statsCount = 200;
+	int cacheCount = 1000;
+	int arenaSide = 1000;
+	int policyCount = 200;
+	int tableCount = 100;
+	int anytimeCount = 100;
+	double sliceMicroseconds = 4000.0;
+	int spatialCount = 10000;
+	int dstarCount = 100;
+	int kernelCount = 20;
+
+	for(int i = 1; i < argc; i++) {
+		if(string(argv[i]) == "--legacy-max" && i + 1 < argc) {
+			legacyMax = atoi(argv[++i]);
+		}
+		else if(string(argv[i]) == "--batch" && i + 1 < argc) {
+			batchSize = atoi(argv[++i]);
+		}
+		else if(string(argv[i]) == "--bidir" && i + 1 < argc) {
+			bidirCount = atoi(argv[++i]);
+		}
+		else if(string(argv[i]) == "--ch" && i + 1 < argc) {
+			chCount = atoi(argv[++i]);
+		}
+		else if(string(argv[i]) == "--ch-side" && i + 1 < argc) {
+			chSide = atoi(argv[++i]);
+		}
+		else if(string(argv[i]) == "--landmarks" && i + 1 < argc) {
+			landmarkCount = atoi(argv[++i]);
+		}
+		else if(string(argv[i]) == "--jps" && i + 1 < argc) {
+			jpsSide = atoi(argv[++i]);
+		}
+		else if(string(argv[i]) == "--file" && i + 1 < argc) {
+			fileSide = atoi(argv[++i]);
+		}
+		else if(string(argv[i]) == "--stats" && i + 1 < argc) {
+			statsCount = atoi(argv[++i]);
+		}
+		else if(string(argv[i]) == "--cache" && i + 1 < argc) {
+			cacheCount = atoi(argv[++i]);
+		}
+		else if(string(argv[i]) == "--arena" && i + 1 < argc) {
+			arenaSide = atoi(argv[++i]);
+		}
+		else if(string(argv[i]) == "--policy" && i + 1 < argc) {
+			policyCount = atoi(argv[++i]);
+		}
+		else if(string(argv[i]) == "--table" && i + 1 < argc) {
+			tableCount = atoi(argv[++i]);
+		}
+		else if(string(argv[i]) == "--anytime" && i + 1 < argc) {
+			anytimeCount = atoi(argv[++i]);
+		}
+		else if(string(argv[i]) == "--slice" && i + 1 < argc) {
+			sliceMicroseconds = atof(argv[++i]);
+		}
+		else if(string(argv[i]) == "--spatial" && i + 1 < argc) {
+			spatialCount = atoi(argv[++i]);
+		}
+		else if(string(argv[i]) == "--dstar" && i + 1 < argc) {
+			dstarCount = atoi(argv[++i]);
+		}
+		else if(string(argv[i]) == "--kernel" && i + 1 < argc) {
+			kernelCount = atoi(argv[++i]);
+		}
+		else {
+			sides.push_back(atoi(argv[i]));
+		}
+	}
+	if(sides.empty()) {
+		sides.push_back(317);
+		sides.push_back(1000);
+	}
+
+	// times are in milliseconds.
+	printf("%10s %10s %10s %10s %10s %12s %8s %12s %12s\n", "nodes", "ucs", "aStar", "csr ucs", "csr aStar",
+		"legacy", "path", "list B/arc", "csr B/arc");
+
+	for(unsigned s = 0; s != sides.size(); s++) {
+		int side = sides[s];
+		GraphType graph(side * side);
+		buildGrid(graph, side);
+
+		Node* pStart = graph.nodeArray()[0];
+		Node* pDest = graph.nodeArray()[side * side - 1];
+		vector<Node*> path;
+
+		GraphType::Context context(graph.getMaxNodes());
+
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		graph.ucs(context, pStart, pDest, ignoreNode, path);
+		double ucsMs = elapsedMs(start);
+		path.clear();
+
+		start = chrono::high_resolution_clock::now();
+		graph.aStar(context, pStart, pDest, ignoreNode, path);
+		double aStarMs = elapsedMs(start);
+		size_t pathLength = path.size();
+		path.clear();
+
+		CSRGraph<int> frozen = graph.freeze();
+		vector<CSRGraph<int>::NodeId> csrPath;
+
+		start = chrono::high_resolution_clock::now();
+		frozen.ucs(context, pStart->index(), pDest->index(), csrPath);
+		double csrUcsMs = elapsedMs(start);
+		csrPath.clear();
+
+		start = chrono::high_resolution_clock::now();
+		frozen.aStar(context, pStart->index(), pDest->index(), csrPath);
+		double csrAStarMs = elapsedMs(start);
+		csrPath.clear();
+
+		// a std::list cell is the arc plus two link pointers.
+		size_t listBytesPerArc = sizeof(Arc) + 2 * sizeof(void*);
+		double csrBytesPerArc = double(frozen.memoryUsage()) / frozen.arcCount();
+
+		char legacy[32] = "skipped";
+		if(side * side <= legacyMax) {
+			start = chrono::high_resolution_clock::now();
+			legacyAStar(graph, pStart, pDest, path);
+			sprintf(legacy, "%.1f", elapsedMs(start));
+			path.clear();
+		}
+
+		printf("%10d %10.1f %10.1f %10.1f %10.1f %12s %8u %12u %12.1f\n", side * side, ucsMs, aStarMs,
+			csrUcsMs, csrAStarMs, legacy, (unsigned)pathLength, (unsigned)listBytesPerArc, csrBytesPerArc);
+	}
+
+	if(batchSize > 0) {
+		benchmarkBatch(sides[0], batchSize);
+	}
+	if(statsCount > 0) {
+		benchmarkInstrumentation(sides[0], statsCount);
+	}
+	if(cacheCount > 0) {
+		benchmarkCache(sides[0], cacheCount);
+	}
+	if(arenaSide > 0) {
+		benchmarkArena(arenaSide);
+	}
+	if(policyCount > 0) {
+		benchmarkPolicy(sides[0], policyCount);
+	}
+	if(anytimeCount > 0) {
+		benchmarkAnytime(sides[0], anytimeCount);
+	}
+	if(sliceMicroseconds > 0.0) {
+		benchmarkSlices(sides[0], sliceMicroseconds);
+	}
+	if(spatialCount > 0) {
+		benchmarkSpatial(sides[0], spatialCount);
+	}
+	if(dstarCount > 0) {
+		benchmarkDStar(sides[0], dstarCount);
+	}
+	if(bidirCount > 0) {
+		benchmarkBidirectional(sides[0], bidirCount);
+	}
+	if(kernelCount > 0) {
+		benchmarkKernel(sides[0], kernelCount);
+	}
+	if(landmarkCount > 0) {
+		benchmarkLandmarks(sides[0], landmarkCount);
+	}
+	if(jpsSide > 0) {
+		benchmarkJumpPoint(jpsSide);
+	}
+	if(chCount > 0) {
+		benchmarkHierarchy(chSide, chCount);
+	}
+	if(tableCount > 0) {
+		benchmarkTable(chSide, tableCount);
+	}
+	if(fileSide > 0) {
+		benchmarkGraphFile(fileSide);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,494 @@
+////////////////////////////////////////////////////////////
+// BenchmarkSuite
+//
+// Runs every search engine over fixed query sets on
+// reproducible synthetic graphs and writes the results as
+// JSON, so runs of different versions can be compared.
+//
+// Usage:   BenchmarkSuite [--sizes n,n,...] [--families f,f,...]
+//                         [--queries count] [--seed seed]
+//                         [--out file] [--graph-max nodes]
+//                         [--ch-max nodes] [--dfs-max nodes]
+//                         [--landmarks count]
+//
+//          --sizes      node counts, 1000,10000,100000 by
+//                       default; up to 10^7 works, given time
+//          --families   any of grid (4-connected, 20% of the
+//                       cells blocked), geometric (random
+//                       geometric, average degree 6) and
+//                       scalefree (Barabasi-Albert, 2 links per
+//                       node); all three by default
+//          --queries    random (start, destination) pairs per
+//                       graph, the same for every engine; 100 by
+//                       default
+//          --seed       seeds the graphs and the queries; 42 by
+//                       default
+//          --out        where to write the JSON; stdout by
+//                       default
+//          --graph-max  the largest graph the pointer based Graph
+//                       engines are run on (1000000 by default)
+//          --ch-max     the largest graph a ContractionHierarchy
+//                       is built for (30000 by default)
+//          --dfs-max    the largest graph the recursive
+//                       Graph::depthFirst is run on (100000)
+//          --landmarks  ALT landmarks (16 by default, 0 for none)
+//
+// For every graph and engine the JSON holds the latency
+// percentiles in microseconds, the mean nodes expanded, the
+// queries per second, any preprocessing time, the memory the
+// engine's own structures take, the process's peak resident
+// memory so far, and how many answers differ from
+// CSRGraph::ucs (which should always be 0). Graph::depthFirst
+// and Graph::breadthFirstSearch count arcs, not weights, and
+// JumpPointSearch runs on an 8-connected GridMap with the
+// same obstacles, so their costs are not compared.
+////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib,"psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+#include "Graph.h"
+#include "GraphGenerators.h"
+#include "BidirectionalSearch.h"
+#include "ContractionHierarchy.h"
+#include "Landmarks.h"
+#include "JumpPointSearch.h"
+
+using namespace std;
+
+typedef Graph<pair<string, int>, int> GraphType;
+typedef GraphNode<pair<string, int>, int> Node;
+typedef CSRGraph<int>::NodeId NodeId;
+
+// what one engine measured over a query set.
+struct EngineResult {
+	string name;
+	vector<double> latencyUs;
+	double expanded;
+	int reached;
+	int mismatches;
+	double preprocessMs;
+	size_t memoryBytes;
+	size_t peakRssBytes;
+};
+
+// the workload an engine runs on.
+struct Workload {
+	string family;
+	CSRGraph<int> graph;
+	GridMap map;
+	vector<pair<NodeId, NodeId> > queries;
+	vector<int> expected;
+	double generateMs;
+
+	Workload() : map( 0, 0 ), generateMs( 0.0 ) {
+	}
+};
+
+// one query: the engine's cost for it (infinity() if the
+// destination is unreachable), and the nodes it expanded.
+typedef function<int (NodeId start, NodeId dest, size_t &expanded)> Query;
+
+size_t visits = 0;
+
+void countVisit(Node *) {
+	visits++;
+}
+
+double elapsedMs(chrono::high_resolution_clock::time_point since) {
+	return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - since).count();
+}
+
+size_t peakRss() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+	return counters.PeakWorkingSetSize;
+#else
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+	return usage.ru_maxrss;
+#else
+	return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+//runs an engine over the workload's queries. checked engines must
+//find the same costs as CSRGraph::ucs.
+EngineResult runEngine(Workload const &work, string const &name, Query const &query, bool checked,
+                       double preprocessMs = 0.0, size_t memoryBytes = 0) {
+	EngineResult result;
+	result.name = name;
+	result.expanded = 0.0;
+	result.reached = 0;
+	result.mismatches = 0;
+	result.preprocessMs = preprocessMs;
+	result.memoryBytes = memoryBytes;
+
+	for(size_t i = 0; i != work.queries.size(); i++) {
+		size_t expanded = 0;
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		int cost = query(work.queries[i].first, work.queries[i].second, expanded);
+		result.latencyUs.push_back(1000.0 * elapsedMs(start));
+
+		result.expanded += expanded;
+		if(cost != CSRGraph<int>::infinity()) {
+			result.reached++;
+		}
+		if(checked && cost != work.expected[i]) {
+			result.mismatches++;
+		}
+	}
+	result.peakRssBytes = peakRss();
+	return result;
+}
+
+double percentile(vector<double> sorted, double p) {
+	if(sorted.empty()) {
+		return 0.0;
+	}
+	sort(sorted.begin(), sorted.end());
+	size_t rank = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+	return sorted[rank];
+}
+
+void writeEngine(FILE *out, EngineResult const &result, bool last) {
+	double total = 0.0;
+	for(size_t i = 0; i != result.latencyUs.size(); i++) {
+		total += result.latencyUs[i];
+	}
+	size_t count = result.latencyUs.size();
+
+	fprintf(out, "        {\n");
+	fprintf(out, "          \"name\": \"%s\",\n", result.name.c_str());
+	fprintf(out, "          \"queries\": %u,\n", (unsigned)count);
+	fprintf(out, "          \"reached\": %d,\n", result.reached);
+	fprintf(out, "          \"mismatches\": %d,\n", result.mismatches);
+	fprintf(out, "          \"latencyUs\": { \"p50\": %.2f, \"p90\": %.2f, \"p99\": %.2f, \"max\": %.2f, \"mean\": %.2f },\n",
+		percentile(result.latencyUs, 0.5), percentile(result.latencyUs, 0.9), percentile(result.latencyUs, 0.99),
+		percentile(result.latencyUs, 1.0), count != 0 ? total / count : 0.0);
+	fprintf(out, "          \"expandedMean\": %.1f,\n", count != 0 ? result.expanded / count : 0.0);
+	fprintf(out, "          \"queriesPerSecond\": %.1f,\n", total > 0.0 ? count / (total / 1e6) : 0.0);
+	fprintf(out, "          \"preprocessMs\": %.1f,\n", result.preprocessMs);
+	fprintf(out, "          \"memoryBytes\": %llu,\n", (unsigned long long)result.memoryBytes);
+	fprintf(out, "          \"peakRssBytes\": %llu\n", (unsigned long long)result.peakRssBytes);
+	fprintf(out, "        }%s\n", last ? "" : ",");
+}
+
+//builds the pointer based Graph the original searches run on.
+void buildGraph(GraphType &graph, CSRGraph<int> const &frozen) {
+	for(NodeId node = 0; node != frozen.nodeCount(); node++) {
+		graph.addNode(pair<string, int>("", 0), node);
+		graph.nodeArray()[node]->setPosition(frozen.x(node), frozen.y(node));
+	}
+	for(NodeId node = 0; node != frozen.nodeCount(); node++) {
+		for(NodeId arc = frozen.arcBegin(node); arc != frozen.arcEnd(node); arc++) {
+			graph.addArc(node, frozen.target(arc), frozen.weight(arc));
+		}
+	}
+}
+
+struct Options {
+	vector<unsigned int> sizes;
+	vector<string> families;
+	int queries;
+	unsigned long long seed;
+	unsigned int graphMax;
+	unsigned int chMax;
+	unsigned int dfsMax;
+	int landmarks;
+};
+
+//runs every engine that applies on one workload.
+vector<EngineResult> runWorkload(Workload &work, Options const &options) {
+	CSRGraph<int> const &graph = work.graph;
+	vector<EngineResult> results;
+	CSRGraph<int>::Context context(graph.nodeCount());
+	vector<NodeId> path;
+
+	// csr.ucs first: it sets the costs the others are checked against.
+	work.expected.clear();
+	results.push_back(runEngine(work, "csr.ucs", [&](NodeId start, NodeId dest, size_t &expanded) {
+		path.clear();
+		int cost = graph.ucs(context, start, dest, path);
+		expanded = context.expanded();
+		work.expected.push_back(cost);
+		return cost;
+	}, false, 0.0, graph.memoryUsage()));
+
+	results.push_back(runEngine(work, "csr.aStar", [&](NodeId start, NodeId dest, size_t &expanded) {
+		path.clear();
+		int cost = graph.aStar(context, start, dest, path);
+		expanded = context.expanded();
+		return cost;
+	}, true, 0.0, graph.memoryUsage()));
+
+	if(options.landmarks > 0) {
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		Landmarks<int> landmarks(graph, options.landmarks);
+		double buildMs = elapsedMs(start);
+
+		results.push_back(runEngine(work, "csr.aStar.alt", [&](NodeId start, NodeId dest, size_t &expanded) {
+			path.clear();
+			int cost = graph.aStar(context, start, dest, path, landmarks);
+			expanded = context.expanded();
+			return cost;
+		}, true, buildMs, landmarks.memoryUsage()));
+	}
+
+	{
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		CSRGraph<int> reverse = graph.transpose();
+		BidirectionalSearch<int> bidirectional(graph, reverse);
+		double buildMs = elapsedMs(start);
+
+		results.push_back(runEngine(work, "bidirectional.ucs", [&](NodeId start, NodeId dest, size_t &expanded) {
+			path.clear();
+			int cost = bidirectional.ucs(start, dest, path);
+			expanded = bidirectional.stats().expanded();
+			return cost;
+		}, true, buildMs, reverse.memoryUsage()));
+
+		results.push_back(runEngine(work, "bidirectional.aStar", [&](NodeId start, NodeId dest, size_t &expanded) {
+			path.clear();
+			int cost = bidirectional.aStar(start, dest, path);
+			expanded = bidirectional.stats().expanded();
+			return cost;
+		}, true, buildMs, reverse.memoryUsage()));
+	}
+
+	if(graph.nodeCount() <= options.chMax) {
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		ContractionHierarchy<int> hierarchy = ContractionHierarchy<int>::build(graph);
+		double buildMs = elapsedMs(start);
+		CSRGraph<int>::Context forward, backward;
+
+		results.push_back(runEngine(work, "contractionHierarchy", [&](NodeId start, NodeId dest, size_t &expanded) {
+			path.clear();
+			int cost = hierarchy.query(forward, backward, start, dest, path);
+			expanded = forward.expanded() + backward.expanded();
+			return cost;
+		}, true, buildMs, hierarchy.memoryUsage()));
+	}
+
+	if(work.family == "grid") {
+		JumpPointSearch<int> jps(work.map);
+		vector<int> cells;
+
+		results.push_back(runEngine(work, "jumpPointSearch", [&](NodeId start, NodeId dest, size_t &expanded) {
+			cells.clear();
+			int cost = jps.search(start, dest, cells);
+			expanded = jps.context().expanded();
+			return cost;
+		}, false, 0.0, work.map.memoryUsage()));
+	}
+
+	if(graph.nodeCount() <= options.graphMax) {
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		GraphType pointerGraph(graph.nodeCount());
+		buildGraph(pointerGraph, graph);
+		double buildMs = elapsedMs(start);
+		Node **nodes = pointerGraph.nodeArray();
+		vector<Node*> nodePath;
+
+		// a list node holds the arc and two links; a GraphNode is
+		// counted without its name string.
+		size_t bytes = graph.nodeCount() * (sizeof(Node) + sizeof(Node*))
+			+ graph.arcCount() * (sizeof(GraphArc<pair<string, int>, int>) + 2 * sizeof(void*));
+
+		results.push_back(runEngine(work, "graph.ucs", [&](NodeId start, NodeId dest, size_t &expanded) {
+			nodePath.clear();
+			pointerGraph.ucs(context, nodes[start], nodes[dest], 0, nodePath);
+			expanded = context.expanded();
+			return context.reached(dest) ? context.cost(dest) : CSRGraph<int>::infinity();
+		}, true, buildMs, bytes));
+
+		results.push_back(runEngine(work, "graph.aStar", [&](NodeId start, NodeId dest, size_t &expanded) {
+			nodePath.clear();
+			pointerGraph.aStar(context, nodes[start], nodes[dest], 0, nodePath);
+			expanded = context.expanded();
+			return context.reached(dest) ? context.cost(dest) : CSRGraph<int>::infinity();
+		}, true, buildMs, bytes));
+
+		results.push_back(runEngine(work, "graph.breadthFirstSearch", [&](NodeId start, NodeId dest, size_t &expanded) {
+			visits = 0;
+			pointerGraph.breadthFirstSearch(context, nodes[start], countVisit, nodes[dest]);
+			expanded = visits;
+			return context.reached(dest) ? context.cost(dest) : CSRGraph<int>::infinity();
+		}, false, buildMs, bytes));
+
+		if(graph.nodeCount() <= options.dfsMax) {
+			// a traversal of the start's whole component.
+			results.push_back(runEngine(work, "graph.depthFirst", [&](NodeId start, NodeId, size_t &expanded) {
+				visits = 0;
+				pointerGraph.depthFirst(context, nodes[start], countVisit);
+				expanded = visits;
+				return static_cast<int>(visits);
+			}, false, buildMs, bytes));
+		}
+	}
+	return results;
+}
+
+void splitList(string const &list, vector<string> &out) {
+	out.clear();
+	size_t begin = 0;
+	while(begin <= list.size()) {
+		size_t end = list.find(',', begin);
+		if(end == string::npos) {
+			end = list.size();
+		}
+		if(end != begin) {
+			out.push_back(list.substr(begin, end - begin));
+		}
+		begin = end + 1;
+	}
+}
+
+int main(int argc, char *argv[]) {
+	Options options;
+	options.queries = 100;
+	options.seed = 42;
+	options.graphMax = 1000000;
+	options.chMax = 30000;
+	options.dfsMax = 100000;
+	options.landmarks = 16;
+	string outPath;
+
+	for(int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if(i + 1 >= argc) {
+			fprintf(stderr, "%s needs a value\n", arg.c_str());
+			return EXIT_FAILURE;
+		}
+		if(arg == "--sizes") {
+			vector<string> sizes;
+			splitList(argv[++i], sizes);
+			for(size_t s = 0; s != sizes.size(); s++) {
+				options.sizes.push_back(static_cast<unsigned int>(strtoul(sizes[s].c_str(), 0, 10)));
+			}
+		}
+		else if(arg == "--families") {
+			splitList(argv[++i], options.families);
+		}
+		else if(arg == "--queries") {
+			options.queries = atoi(argv[++i]);
+		}
+		else if(arg == "--seed") {
+			options.seed = strtoull(argv[++i], 0, 10);
+		}
+		else if(arg == "--out") {
+			outPath = argv[++i];
+		}
+		else if(arg == "--graph-max") {
+			options.graphMax = static_cast<unsigned int>(strtoul(argv[++i], 0, 10));
+		}
+		else if(arg == "--ch-max") {
+			options.chMax = static_cast<unsigned int>(strtoul(argv[++i], 0, 10));
+		}
+		else if(arg == "--dfs-max") {
+			options.dfsMax = static_cast<unsigned int>(strtoul(argv[++i], 0, 10));
+		}
+		else if(arg == "--landmarks") {
+			options.landmarks = atoi(argv[++i]);
+		}
+		else {
+			fprintf(stderr, "unknown option %s\n", arg.c_str());
+			return EXIT_FAILURE;
+		}
+	}
+	if(options.sizes.empty()) {
+		options.sizes.push_back(1000);
+		options.sizes.push_back(10000);
+		options.sizes.push_back(100000);
+	}
+	if(options.families.empty()) {
+		splitList("grid,geometric,scalefree", options.families);
+	}
+
+	FILE *out = stdout;
+	if(!outPath.empty()) {
+		out = fopen(outPath.c_str(), "w");
+		if(out == 0) {
+			fprintf(stderr, "cannot write %s\n", outPath.c_str());
+			return EXIT_FAILURE;
+		}
+	}
+
+	fprintf(out, "{\n  \"version\": 1,\n  \"seed\": %llu,\n  \"queries\": %d,\n  \"workloads\": [\n", options.seed, options.queries);
+
+	bool firstWorkload = true;
+	for(size_t f = 0; f != options.families.size(); f++) {
+		for(size_t s = 0; s != options.sizes.size(); s++) {
+			string const &family = options.families[f];
+			unsigned int size = options.sizes[s];
+			Workload work;
+			work.family = family;
+
+			chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+			if(family == "grid") {
+				int side = static_cast<int>(sqrt(static_cast<double>(size)) + 0.5);
+				work.map = GridMap(side, side);
+				work.graph = generateGrid(side, 0.2, options.seed, &work.map);
+			}
+			else if(family == "geometric") {
+				work.graph = generateGeometric(size, 6.0, options.seed);
+			}
+			else if(family == "scalefree") {
+				work.graph = generateScaleFree(size, 2, options.seed);
+			}
+			else {
+				fprintf(stderr, "unknown family %s\n", family.c_str());
+				continue;
+			}
+			work.generateMs = elapsedMs(start);
+
+			GeneratorRandom random(options.seed ^ 0x5155455249455321ull);
+			for(int q = 0; q != options.queries; q++) {
+				NodeId from = random.below(work.graph.nodeCount());
+				NodeId to = random.below(work.graph.nodeCount());
+				work.queries.push_back(make_pair(from, to));
+			}
+
+			fprintf(stderr, "%s, %u nodes...\n", family.c_str(), work.graph.nodeCount());
+			vector<EngineResult> results = runWorkload(work, options);
+
+			fprintf(out, "%s    {\n", firstWorkload ? "" : ",\n");
+			fprintf(out, "      \"family\": \"%s\",\n", family.c_str());
+			fprintf(out, "      \"nodes\": %u,\n", work.graph.nodeCount());
+			fprintf(out, "      \"arcs\": %u,\n", work.graph.arcCount());
+			fprintf(out, "      \"generateMs\": %.1f,\n", work.generateMs);
+			fprintf(out, "      \"engines\": [\n");
+			for(size_t r = 0; r != results.size(); r++) {
+				writeEngine(out, results[r], r + 1 == results.size());
+			}
+			fprintf(out, "      ]\n    }");
+			fflush(out);
+			firstWorkload = false;
+		}
+	}
+	fprintf(out, "\n  ]\n}\n");
+
+	if(out != stdout) {
+		fclose(out);
+	}
+	return EXIT_SUCCESS;
+}
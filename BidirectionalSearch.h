@@ -0,0 +1,174 @@
+#ifndef BIDIRECTIONALSEARCH_H
+#define BIDIRECTIONALSEARCH_H
+
+#include <vector>
+#include <algorithm>
+
+#include "CSRGraph.h"
+#include "SearchContext.h"
+
+// -------------------------------------------------------
+// Name:        BidirectionalSearch
+// Description: Searches a frozen graph from both ends at
+//              once: forwards from the start over the graph
+//              and backwards from the destination over its
+//              transpose, meeting in the middle. Two half-size
+//              discs are a lot fewer nodes than one full one,
+//              so on long queries this expands roughly half as
+//              many nodes as CSRGraph::ucs/aStar.
+//
+//              The A* mode gives both halves the average
+//              potential p(v) = (h(v, dest) - h(start, v)) / 2
+//              (and -p(v) backwards), which stays consistent
+//              in both directions, so neither half ever has to
+//              reopen a node and the stopping test below is
+//              exact. Keys are kept doubled to stay integral.
+//
+//              A BidirectionalSearch owns its two contexts, so
+//              give each thread its own; the graphs can be
+//              shared.
+// -------------------------------------------------------
+template<class ArcType>
+class BidirectionalSearch {
+public:
+	typedef typename CSRGraph<ArcType>::NodeId NodeId;
+
+	struct Stats {
+		size_t forwardExpanded;
+		size_t backwardExpanded;
+
+		size_t expanded() const {
+			return forwardExpanded + backwardExpanded;
+		}
+	};
+
+private:
+	CSRGraph<ArcType> const & m_graph;
+	CSRGraph<ArcType> const & m_reverse;
+
+	SearchContext<ArcType> m_forward;
+	SearchContext<ArcType> m_backward;
+
+	Stats m_stats;
+
+	ArcType potential( NodeId node, NodeId start, NodeId dest, bool heuristic ) const {
+		return heuristic ? m_graph.heuristic_eval(node, dest) - m_graph.heuristic_eval(start, node) : 0;
+	}
+
+	ArcType search( NodeId start, NodeId dest, std::vector<NodeId> &path, bool heuristic );
+
+public:
+	// reverse must be graph.transpose().
+	BidirectionalSearch( CSRGraph<ArcType> const &graph, CSRGraph<ArcType> const &reverse )
+		: m_graph( graph ), m_reverse( reverse ) {
+		m_stats.forwardExpanded = 0;
+		m_stats.backwardExpanded = 0;
+	}
+
+	ArcType ucs( NodeId start, NodeId dest, std::vector<NodeId> &path ) {
+		return search(start, dest, path, false);
+	}
+
+	ArcType aStar( NodeId start, NodeId dest, std::vector<NodeId> &path ) {
+		return search(start, dest, path, true);
+	}
+
+	// Expansion counts of the last query.
+	Stats const & stats() const {
+		return m_stats;
+	}
+};
+
+// ----------------------------------------------------------------
+//  Name:           search
+//  Description:    Alternates between the halves, always expanding
+//                  the one with the smaller key. When an arc
+//                  reaches a node the other half has already
+//                  reached, the joined path is a candidate mu. No
+//                  shorter path can be left once the two smallest
+//                  keys add up to mu or more (both keys are doubled,
+//                  and the two potentials cancel on every node).
+//  Arguments:      The start id, the destination id, the vector to
+//                  write the path into (destination first) and
+//                  whether to use the A* potential.
+//  Return Value:   The cost of the path, or infinity() if dest
+//                  cannot be reached (the path is then left empty).
+// ----------------------------------------------------------------
+template<class ArcType>
+ArcType BidirectionalSearch<ArcType>::search( NodeId start, NodeId dest, std::vector<NodeId> &path, bool heuristic ) {
+	m_forward.reset(m_graph.nodeCount());
+	m_backward.reset(m_reverse.nodeCount());
+	IndexedPriorityQueue<ArcType> &forwardPq = m_forward.open();
+	IndexedPriorityQueue<ArcType> &backwardPq = m_backward.open();
+
+	m_forward.setCost(start, 0, -1);
+	forwardPq.push(start, potential(start, start, dest, heuristic));
+	m_backward.setCost(dest, 0, -1);
+	backwardPq.push(dest, -potential(dest, start, dest, heuristic));
+
+	ArcType mu = SearchContext<ArcType>::infinity();
+	int meet = -1;
+	if(start == dest) {
+		mu = 0;
+		meet = start;
+	}
+
+	while(!forwardPq.empty() && !backwardPq.empty()) {
+		if(forwardPq.topKey() + backwardPq.topKey() >= mu + mu) {
+			break;
+		}
+
+		bool forwards = forwardPq.topKey() <= backwardPq.topKey();
+		CSRGraph<ArcType> const &graph = forwards ? m_graph : m_reverse;
+		SearchContext<ArcType> &context = forwards ? m_forward : m_backward;
+		SearchContext<ArcType> &other = forwards ? m_backward : m_forward;
+		IndexedPriorityQueue<ArcType> &pq = context.open();
+
+		NodeId top = pq.top();
+		pq.pop();
+		context.countExpansion();
+
+		for(NodeId arc = graph.arcBegin(top); arc != graph.arcEnd(top); arc++) {
+			NodeId child = graph.target(arc);
+			ArcType gC = context.cost(top) + graph.weight(arc);
+
+			if(gC < context.cost(child)) {
+				ArcType p = potential(child, start, dest, heuristic);
+				ArcType key = gC + gC + (forwards ? p : -p);
+				context.setCost(child, gC, top);
+				context.setEstimate(child, key);
+
+				if(pq.contains(child)) {
+					pq.decreaseKey(child, key);
+				}
+				else {
+					pq.push(child, key);
+				}
+
+				if(other.reached(child) && gC + other.cost(child) < mu) {
+					mu = gC + other.cost(child);
+					meet = child;
+				}
+			}
+		}
+	}
+
+	m_stats.forwardExpanded = m_forward.expanded();
+	m_stats.backwardExpanded = m_backward.expanded();
+
+	if(meet != -1) {
+		// meet..dest along the backward tree, turned round so dest
+		// comes first, then on back to start along the forward tree.
+		size_t first = path.size();
+		for(int node = meet; node != -1; node = m_backward.previous(node)) {
+			path.push_back(node);
+		}
+		std::reverse(path.begin() + first, path.end());
+		for(int node = m_forward.previous(meet); node != -1; node = m_forward.previous(node)) {
+			path.push_back(node);
+		}
+	}
+	return mu;
+}
+
+#endif
@@ -0,0 +1,583 @@
+#ifndef CSRGRAPH_H
+#define CSRGRAPH_H
+
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <utility>
+
+#include "SearchContext.h"
+#include "SearchStats.h"
+#include "HeuristicKernel.h"
+
+template<class ArcType, DistanceMetric Metric> struct CoordinateHeuristic;
+
+// -------------------------------------------------------
+// Name:        CSRGraph
+// Description: An immutable compressed-sparse-row snapshot of
+//              a graph, made by Graph::freeze(). The arcs
+//              leaving node u are the entries
+//              [offset(u), offset(u + 1)) of the target and
+//              weight arrays, so walking a node's neighbours
+//              reads contiguous memory instead of chasing list
+//              pointers. Node ids are 32-bit and are the same
+//              as the node indices in the graph it was made
+//              from.
+// -------------------------------------------------------
+template<class ArcType>
+class CSRGraph {
+public:
+	typedef unsigned int NodeId;
+
+private:
+// -------------------------------------------------------
+// Description: nodeCount() + 1 offsets into the arc arrays.
+// -------------------------------------------------------
+	NodeId const * m_pOffsets;
+
+// -------------------------------------------------------
+// Description: the node each arc points to.
+// -------------------------------------------------------
+	NodeId const * m_pTargets;
+
+// -------------------------------------------------------
+// Description: the weight of each arc.
+// -------------------------------------------------------
+	ArcType const * m_pWeights;
+
+// -------------------------------------------------------
+// Description: node coordinates, used by the heuristic.
+// -------------------------------------------------------
+	float const * m_pX;
+	float const * m_pY;
+
+	NodeId m_nodeCount;
+	NodeId m_arcCount;
+
+// -------------------------------------------------------
+// Description: aStar scores at most this many children of
+//              a node in one estimateBlock call.
+// -------------------------------------------------------
+	static const NodeId kEstimateBlock = 32;
+
+// -------------------------------------------------------
+// Description: The arrays above point into these, unless
+//              the graph is a view of memory it does not own
+//              (see view()); they are then empty.
+// -------------------------------------------------------
+	std::vector<NodeId> m_offsets;
+	std::vector<NodeId> m_targets;
+	std::vector<ArcType> m_weights;
+	std::vector<float> m_x;
+	std::vector<float> m_y;
+	bool m_owner;
+
+	void pointAtStorage() {
+		m_nodeCount = static_cast<NodeId>(m_offsets.size() - 1);
+		m_arcCount = static_cast<NodeId>(m_targets.size());
+		m_pOffsets = &m_offsets[0];
+		m_pTargets = m_targets.empty() ? 0 : &m_targets[0];
+		m_pWeights = m_weights.empty() ? 0 : &m_weights[0];
+		m_pX = m_x.empty() ? 0 : &m_x[0];
+		m_pY = m_y.empty() ? 0 : &m_y[0];
+		m_owner = true;
+	}
+
+public:
+	CSRGraph() {
+		m_offsets.push_back(0);
+		pointAtStorage();
+	}
+
+	// Takes ownership of prebuilt arrays (the vectors passed in are
+	// left empty).
+	CSRGraph( std::vector<NodeId> &offsets, std::vector<NodeId> &targets, std::vector<ArcType> &weights,
+	          std::vector<float> &x, std::vector<float> &y ) {
+		m_offsets.swap(offsets);
+		m_targets.swap(targets);
+		m_weights.swap(weights);
+		m_x.swap(x);
+		m_y.swap(y);
+		pointAtStorage();
+	}
+
+	CSRGraph( CSRGraph const &other ) {
+		*this = other;
+	}
+
+	// Moving keeps the vectors' buffers, so the arrays stay valid.
+	CSRGraph( CSRGraph &&other )
+		: m_pOffsets( other.m_pOffsets ), m_pTargets( other.m_pTargets ), m_pWeights( other.m_pWeights ),
+		  m_pX( other.m_pX ), m_pY( other.m_pY ), m_nodeCount( other.m_nodeCount ), m_arcCount( other.m_arcCount ),
+		  m_offsets( std::move(other.m_offsets) ), m_targets( std::move(other.m_targets) ),
+		  m_weights( std::move(other.m_weights) ), m_x( std::move(other.m_x) ), m_y( std::move(other.m_y) ),
+		  m_owner( other.m_owner ) {
+		other.m_offsets.assign(1, 0);
+		other.pointAtStorage();
+	}
+
+	CSRGraph & operator=( CSRGraph const &other ) {
+		if(this != &other) {
+			m_offsets = other.m_offsets;
+			m_targets = other.m_targets;
+			m_weights = other.m_weights;
+			m_x = other.m_x;
+			m_y = other.m_y;
+			if(other.m_owner) {
+				pointAtStorage();
+			}
+			else {
+				m_pOffsets = other.m_pOffsets;
+				m_pTargets = other.m_pTargets;
+				m_pWeights = other.m_pWeights;
+				m_pX = other.m_pX;
+				m_pY = other.m_pY;
+				m_nodeCount = other.m_nodeCount;
+				m_arcCount = other.m_arcCount;
+				m_owner = false;
+			}
+		}
+		return *this;
+	}
+
+	static CSRGraph view( NodeId nodeCount, NodeId arcCount, NodeId const *offsets, NodeId const *targets,
+	                      ArcType const *weights, float const *x, float const *y );
+
+	typedef SearchContext<ArcType> Context;
+
+	static ArcType infinity() {
+		return Context::infinity();
+	}
+
+	// Accessor functions
+	NodeId nodeCount() const {
+		return m_nodeCount;
+	}
+
+	NodeId arcCount() const {
+		return m_arcCount;
+	}
+
+	NodeId arcBegin( NodeId node ) const {
+		return m_pOffsets[node];
+	}
+
+	NodeId arcEnd( NodeId node ) const {
+		return m_pOffsets[node + 1];
+	}
+
+	NodeId target( NodeId arc ) const {
+		return m_pTargets[arc];
+	}
+
+	ArcType weight( NodeId arc ) const {
+		return m_pWeights[arc];
+	}
+
+	float x( NodeId node ) const {
+		return m_pX[node];
+	}
+
+	float y( NodeId node ) const {
+		return m_pY[node];
+	}
+
+	// every node's coordinates, nodeCount() of each.
+	float const * xCoordinates() const {
+		return m_pX;
+	}
+
+	float const * yCoordinates() const {
+		return m_pY;
+	}
+
+	bool ownsMemory() const {
+		return m_owner;
+	}
+
+	// The heap memory the graph owns; 0 for a view.
+	size_t memoryUsage() const {
+		return m_offsets.capacity() * sizeof(NodeId) + m_targets.capacity() * sizeof(NodeId)
+			+ m_weights.capacity() * sizeof(ArcType) + (m_x.capacity() + m_y.capacity()) * sizeof(float);
+	}
+
+// -------------------------------------------------------
+// Description: The heuristics computed from the node
+//              coordinates; Euclidean, heuristic_eval, is the
+//              default for aStar. Any functor with the same
+//              call operator (an admissible estimate of the
+//              cost from one node to another) can be passed
+//              instead, e.g. Landmarks.
+// -------------------------------------------------------
+	typedef CoordinateHeuristic<ArcType, METRIC_EUCLIDEAN> Euclidean;
+	typedef CoordinateHeuristic<ArcType, METRIC_OCTILE> Octile;
+	typedef CoordinateHeuristic<ArcType, METRIC_MANHATTAN> Manhattan;
+
+	CSRGraph transpose() const;
+	ArcType heuristic_eval( NodeId a, NodeId b, float grainOfSalt = 0.9f ) const;
+
+	ArcType ucs( Context &context, NodeId start, NodeId dest, std::vector<NodeId> &path ) const {
+		NoInstrumentation none;
+		return ucs(context, start, dest, path, none);
+	}
+
+	template<class Instrumentation>
+	ArcType ucs( Context &context, NodeId start, NodeId dest, std::vector<NodeId> &path, Instrumentation &instrumentation ) const;
+
+	NodeId ucsAll( Context &context, NodeId start, std::vector<ArcType> &distances, std::vector<int> &parents ) const;
+
+	ArcType aStar( Context &context, NodeId start, NodeId dest, std::vector<NodeId> &path ) const {
+		return aStar(context, start, dest, path, Euclidean(*this));
+	}
+
+	template<class Heuristic>
+	ArcType aStar( Context &context, NodeId start, NodeId dest, std::vector<NodeId> &path, Heuristic const &heuristic ) const {
+		NoInstrumentation none;
+		return aStar(context, start, dest, path, heuristic, none);
+	}
+
+	template<class Heuristic, class Instrumentation>
+	ArcType aStar( Context &context, NodeId start, NodeId dest, std::vector<NodeId> &path, Heuristic const &heuristic, Instrumentation &instrumentation ) const;
+};
+
+// -------------------------------------------------------
+// Name:        CoordinateHeuristic
+// Description: A heuristic from the distance between two
+//              nodes' coordinates under a metric, scaled by
+//              grainOfSalt (0.9 by default, as heuristic_eval)
+//              and truncated to ArcType. It is admissible when
+//              no path is cheaper than the metric says, e.g.
+//              Euclidean on graphs whose arcs weigh at least
+//              their length, Octile on 8-connected grids and
+//              Manhattan on 4-connected ones.
+//
+//              block() scores a node's whole neighbour list in
+//              one HeuristicKernel call, which aStar uses
+//              instead of a call per child.
+// -------------------------------------------------------
+template<class ArcType, DistanceMetric Metric>
+struct CoordinateHeuristic {
+	typedef typename CSRGraph<ArcType>::NodeId NodeId;
+
+	float const *x;
+	float const *y;
+	float grainOfSalt;
+
+	explicit CoordinateHeuristic( CSRGraph<ArcType> const &graph, float scale = 0.9f )
+		: x( graph.xCoordinates() ), y( graph.yCoordinates() ), grainOfSalt( scale ) {
+	}
+
+	ArcType operator()( NodeId node, NodeId dest ) const {
+		float distance = HeuristicKernel::distance<Metric>(x[dest] - x[node], y[dest] - y[node]);
+		return static_cast<ArcType>(static_cast<ArcType>(distance) * grainOfSalt);
+	}
+
+	// out[i] = (*this)(nodes[i], dest) for i < count.
+	void block( NodeId const *nodes, size_t count, NodeId dest, ArcType *out ) const {
+		float distances[kBlock];
+		for(size_t first = 0; first < count; first += kBlock) {
+			size_t size = count - first < kBlock ? count - first : kBlock;
+			HeuristicKernel::distances<Metric>(x, y, nodes + first, size, x[dest], y[dest], distances);
+			for(size_t i = 0; i != size; i++) {
+				out[first + i] = static_cast<ArcType>(static_cast<ArcType>(distances[i]) * grainOfSalt);
+			}
+		}
+	}
+
+	static const size_t kBlock = 64;
+};
+
+// ----------------------------------------------------------------
+//  Name:           estimateBlock
+//  Description:    Scores a block of children at once if the
+//                  heuristic can; aStar falls back to one call per
+//                  child (and only for the children it improves)
+//                  when it cannot, which is cheaper for costly
+//                  heuristics such as Landmarks.
+//  Arguments:      The heuristic, the children and their count, the
+//                  destination and where to write the estimates.
+//  Return Value:   true if the estimates were written.
+// ----------------------------------------------------------------
+template<class Heuristic, class NodeId, class ArcType>
+inline bool estimateBlock( Heuristic const &, NodeId const *, size_t, NodeId, ArcType * ) {
+	return false;
+}
+
+template<class ArcType, DistanceMetric Metric>
+inline bool estimateBlock( CoordinateHeuristic<ArcType, Metric> const &heuristic, unsigned int const *nodes, size_t count, unsigned int dest, ArcType *out ) {
+	heuristic.block(nodes, count, dest, out);
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           view
+//  Description:    Wraps arrays owned by someone else, e.g. a
+//                  memory-mapped file, without copying them. The
+//                  arrays must outlive the view and every copy of
+//                  it.
+//  Arguments:      The node and arc counts, nodeCount + 1 offsets,
+//                  arcCount targets and weights and nodeCount x and
+//                  y coordinates.
+//  Return Value:   The view.
+// ----------------------------------------------------------------
+template<class ArcType>
+CSRGraph<ArcType> CSRGraph<ArcType>::view( NodeId nodeCount, NodeId arcCount, NodeId const *offsets, NodeId const *targets,
+                                           ArcType const *weights, float const *x, float const *y ) {
+	CSRGraph graph;
+	graph.m_offsets.clear();
+	graph.m_pOffsets = offsets;
+	graph.m_pTargets = targets;
+	graph.m_pWeights = weights;
+	graph.m_pX = x;
+	graph.m_pY = y;
+	graph.m_nodeCount = nodeCount;
+	graph.m_arcCount = arcCount;
+	graph.m_owner = false;
+	return graph;
+}
+
+// ----------------------------------------------------------------
+//  Name:           transpose
+//  Description:    Makes the reverse graph: every arc u->v becomes
+//                  v->u with the same weight, so the arcs entering
+//                  a node can be walked as fast as those leaving
+//                  it. A counting sort keeps it O(N + A).
+//  Arguments:      None.
+//  Return Value:   The reversed snapshot, with the same node ids and
+//                  coordinates.
+// ----------------------------------------------------------------
+template<class ArcType>
+CSRGraph<ArcType> CSRGraph<ArcType>::transpose() const {
+	NodeId count = nodeCount();
+	std::vector<NodeId> offsets(count + 1, 0);
+	std::vector<NodeId> targets(arcCount());
+	std::vector<ArcType> weights(arcCount());
+
+	for(NodeId arc = 0; arc != arcCount(); arc++) {
+		offsets[m_pTargets[arc] + 1]++;
+	}
+	for(NodeId node = 0; node != count; node++) {
+		offsets[node + 1] += offsets[node];
+	}
+
+	std::vector<NodeId> next(offsets.begin(), offsets.end() - 1);
+	for(NodeId node = 0; node != count; node++) {
+		for(NodeId arc = arcBegin(node); arc != arcEnd(node); arc++) {
+			NodeId slot = next[m_pTargets[arc]]++;
+			targets[slot] = node;
+			weights[slot] = m_pWeights[arc];
+		}
+	}
+
+	std::vector<float> x(m_pX, m_pX + count), y(m_pY, m_pY + count);
+	return CSRGraph(offsets, targets, weights, x, y);
+}
+
+// ----------------------------------------------------------------
+//  Name:           heuristic_eval
+//  Description:    The same scaled euclidean estimate as
+//                  Graph::heuristic_eval.
+//  Arguments:      The two node ids and the scale factor.
+//  Return Value:   The estimated cost from a to b.
+// ----------------------------------------------------------------
+template<class ArcType>
+ArcType CSRGraph<ArcType>::heuristic_eval( NodeId a, NodeId b, float grainOfSalt ) const {
+	float dx = m_pX[b] - m_pX[a];
+	float dy = m_pY[b] - m_pY[a];
+
+	ArcType result = static_cast<ArcType>(std::sqrt(dx * dx + dy * dy));
+
+	return static_cast<ArcType>(result * grainOfSalt);
+}
+
+// ----------------------------------------------------------------
+//  Name:           ucs
+//  Description:    Uniform cost search (Dijkstra) over the snapshot.
+//  Arguments:      The search context (it is reset first), the start
+//                  id, the destination id, the vector to write the
+//                  path into (destination first) and, optionally, an
+//                  instrumentation policy (see SearchStats.h).
+//  Return Value:   The cost of the path, or infinity() if dest
+//                  cannot be reached (the path is then left empty).
+// ----------------------------------------------------------------
+template<class ArcType>
+template<class Instrumentation>
+ArcType CSRGraph<ArcType>::ucs( Context &context, NodeId start, NodeId dest, std::vector<NodeId> &path, Instrumentation &instrumentation ) const {
+	instrumentation.begin();
+	context.reset(nodeCount());
+	IndexedPriorityQueue<ArcType> &pq = context.open();
+
+	context.setCost(start, 0, -1);
+	pq.push(start, 0);
+	instrumentation.pushed(pq.size());
+
+	while(!pq.empty() && pq.top() != static_cast<int>(dest)) {
+		NodeId top = pq.top();
+		pq.pop();
+		context.countExpansion();
+		instrumentation.popped();
+		instrumentation.expanded();
+
+		for(NodeId arc = arcBegin(top); arc != arcEnd(top); arc++) {
+			NodeId child = m_pTargets[arc];
+			instrumentation.relaxed();
+			ArcType distC = context.cost(top) + m_pWeights[arc];
+
+			if(distC < context.cost(child)) {
+				context.setCost(child, distC, top);
+
+				if(pq.contains(child)) {
+					pq.decreaseKey(child, distC);
+					instrumentation.decreasedKey();
+				}
+				else {
+					pq.push(child, distC);
+					instrumentation.pushed(pq.size());
+				}
+			}
+		}
+	}
+
+	if(context.reached(dest)) {
+		for(int node = dest; node != -1; node = context.previous(node)) {
+			path.push_back(node);
+		}
+	}
+	instrumentation.end("CSRGraph::ucs");
+	return context.cost(dest);
+}
+
+// ----------------------------------------------------------------
+//  Name:           ucsAll
+//  Description:    Uniform cost search with no destination: it runs
+//                  until every node reachable from start is settled,
+//                  which is one row of a distance table in a single
+//                  search instead of one search per destination.
+//  Arguments:      The search context (it is reset first), the start
+//                  id and the vectors to write every node's distance
+//                  from start (infinity() if unreachable) and the
+//                  node before it on a shortest path (-1 for start
+//                  and the unreachable nodes) into; they are resized
+//                  to nodeCount().
+//  Return Value:   The number of nodes reached, start included.
+// ----------------------------------------------------------------
+template<class ArcType>
+typename CSRGraph<ArcType>::NodeId CSRGraph<ArcType>::ucsAll( Context &context, NodeId start, std::vector<ArcType> &distances, std::vector<int> &parents ) const {
+	context.reset(nodeCount());
+	IndexedPriorityQueue<ArcType> &pq = context.open();
+	NodeId reached = 0;
+
+	context.setCost(start, 0, -1);
+	pq.push(start, 0);
+
+	while(!pq.empty()) {
+		NodeId top = pq.top();
+		ArcType cost = pq.topKey();
+		pq.pop();
+		context.countExpansion();
+		reached++;
+
+		for(NodeId arc = arcBegin(top); arc != arcEnd(top); arc++) {
+			NodeId child = m_pTargets[arc];
+			ArcType distC = cost + m_pWeights[arc];
+
+			if(distC < context.cost(child)) {
+				context.setCost(child, distC, top);
+
+				if(pq.contains(child)) {
+					pq.decreaseKey(child, distC);
+				}
+				else {
+					pq.push(child, distC);
+				}
+			}
+		}
+	}
+
+	distances.resize(nodeCount());
+	parents.resize(nodeCount());
+	for(NodeId node = 0; node != nodeCount(); node++) {
+		distances[node] = context.cost(node);
+		parents[node] = context.previous(node);
+	}
+	return reached;
+}
+
+// ----------------------------------------------------------------
+//  Name:           aStar
+//  Description:    A* search over the snapshot. A node whose cost
+//                  drops after it was expanded is queued again, so
+//                  an admissible heuristic is enough for the result
+//                  to be exact even if it is not consistent.
+//  Arguments:      The search context (it is reset first), the start
+//                  id, the destination id, the vector to write the
+//                  path into (destination first), the heuristic and,
+//                  optionally, an instrumentation policy.
+//  Return Value:   The cost of the path, or infinity() if dest
+//                  cannot be reached (the path is then left empty).
+// ----------------------------------------------------------------
+template<class ArcType>
+template<class Heuristic, class Instrumentation>
+ArcType CSRGraph<ArcType>::aStar( Context &context, NodeId start, NodeId dest, std::vector<NodeId> &path, Heuristic const &heuristic, Instrumentation &instrumentation ) const {
+	instrumentation.begin();
+	context.reset(nodeCount());
+	IndexedPriorityQueue<ArcType> &pq = context.open();
+
+	context.setCost(start, 0, -1);
+	pq.push(start, heuristic(start, dest));
+	instrumentation.pushed(pq.size());
+
+	while(!pq.empty() && pq.top() != static_cast<int>(dest)) {
+		NodeId top = pq.top();
+		pq.pop();
+		context.countExpansion();
+		instrumentation.popped();
+		instrumentation.expanded();
+
+		// the children whose cost drops are collected first and then
+		// scored together, if the heuristic can score a block.
+		for(NodeId first = arcBegin(top); first < arcEnd(top); first += kEstimateBlock) {
+			NodeId last = arcEnd(top) - first < kEstimateBlock ? arcEnd(top) : first + kEstimateBlock;
+			NodeId improved[kEstimateBlock];
+			ArcType estimates[kEstimateBlock];
+			size_t count = 0;
+
+			for(NodeId arc = first; arc != last; arc++) {
+				NodeId child = m_pTargets[arc];
+				instrumentation.relaxed();
+				ArcType gC = context.cost(top) + m_pWeights[arc];
+
+				if(gC < context.cost(child)) {
+					context.setCost(child, gC, top);
+					improved[count++] = child;
+				}
+			}
+
+			bool estimated = estimateBlock(heuristic, improved, count, dest, estimates);
+			for(size_t i = 0; i != count; i++) {
+				NodeId child = improved[i];
+				ArcType fC = context.cost(child) + (estimated ? estimates[i] : heuristic(child, dest));
+				context.setEstimate(child, fC);
+
+				if(pq.contains(child)) {
+					pq.decreaseKey(child, fC);
+					instrumentation.decreasedKey();
+				}
+				else {
+					pq.push(child, fC);
+					instrumentation.pushed(pq.size());
+				}
+			}
+		}
+	}
+
+	if(context.reached(dest)) {
+		for(int node = dest; node != -1; node = context.previous(node)) {
+			path.push_back(node);
+		}
+	}
+	instrumentation.end("CSRGraph::aStar");
+	return context.cost(dest);
+}
+
+#endif
@@ -0,0 +1,770 @@
+#ifndef CONTRACTIONHIERARCHY_H
+#define CONTRACTIONHIERARCHY_H
+
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <algorithm>
+#include <climits>
+
+#include "CSRGraph.h"
+#include "SearchContext.h"
+#include "IndexedPriorityQueue.h"
+
+template<class NodeType, class ArcType> class Graph;
+
+// -------------------------------------------------------
+// Name:        ContractionHierarchy
+// Description: A graph preprocessed for fast exact queries.
+//              Nodes are contracted one at a time, least
+//              important first; contracting a node adds a
+//              shortcut u->x for every path u->v->x through it
+//              that nothing else matches, so the distances
+//              between the nodes left over never change. Every
+//              shortest path then climbs the node order and
+//              comes back down, so a query is two small upward
+//              searches, one from each end.
+//
+//              The upward arcs (lower to higher rank, by their
+//              source) and the downward arcs (higher to lower
+//              rank, by their target) are kept as two CSR
+//              arrays. A shortcut remembers the node it skips,
+//              which is how paths are unpacked back into the
+//              original nodes.
+// -------------------------------------------------------
+template<class ArcType>
+class ContractionHierarchy {
+public:
+	typedef typename CSRGraph<ArcType>::NodeId NodeId;
+	typedef SearchContext<ArcType> Context;
+
+private:
+// -------------------------------------------------------
+// Description: One side of the hierarchy. The arcs of node
+//              u are [offsets[u], offsets[u + 1]); each has
+//              the node at its other end, its weight and the
+//              node a shortcut skips (-1 for an original
+//              arc).
+// -------------------------------------------------------
+	struct Half {
+		std::vector<NodeId> offsets;
+		std::vector<NodeId> nodes;
+		std::vector<ArcType> weights;
+		std::vector<int> middles;
+	};
+
+	Half m_up;
+	Half m_down;
+	NodeId m_shortcuts;
+
+	// an arc of the graph while it is being contracted.
+	struct WorkArc {
+		NodeId node;
+		ArcType weight;
+		int middle;
+	};
+	typedef std::vector<std::vector<WorkArc> > WorkLists;
+
+// -------------------------------------------------------
+// Description: witness searches give up after settling this
+//              many nodes. A search that gives up early only
+//              costs a shortcut that was not strictly needed,
+//              so the searches that just rank nodes use a much
+//              smaller limit than the ones that add shortcuts.
+// -------------------------------------------------------
+	static const int kWitnessLimit = 64;
+	static const int kSimulateLimit = 16;
+
+	// load reads arrays in blocks of this many values, so a corrupt
+	// count runs out of stream before it runs out of memory.
+	static const size_t kReadBlock = 1 << 16;
+
+	static void addWorkArc( std::vector<WorkArc> &arcs, NodeId node, ArcType weight, int middle );
+	static void removeWorkArc( std::vector<WorkArc> &arcs, NodeId node );
+	static int contract( NodeId node, WorkLists &out, WorkLists &in, Context &witness, bool simulate );
+	static void compile( Half &half, std::vector<std::vector<WorkArc> > const &lists );
+	static bool writeHalf( std::ostream &stream, Half const &half );
+	static bool readHalf( std::istream &stream, Half &half, NodeId nodeCount );
+	template<class T>
+	static bool readArray( std::istream &stream, std::vector<T> &values, size_t count );
+
+	int findArc( NodeId from, NodeId to ) const;
+	int middle( NodeId from, NodeId to ) const;
+	bool checkMiddles() const;
+	void unpack( NodeId from, NodeId to, std::vector<NodeId> &nodes ) const;
+
+public:
+	ContractionHierarchy() : m_shortcuts( 0 ) {
+		m_up.offsets.push_back(0);
+		m_down.offsets.push_back(0);
+	}
+
+	static ContractionHierarchy build( CSRGraph<ArcType> const &graph );
+
+	template<class NodeType>
+	static ContractionHierarchy build( Graph<NodeType, ArcType> const &graph ) {
+		return build(graph.freeze());
+	}
+
+	// Accessor functions
+	NodeId nodeCount() const {
+		return static_cast<NodeId>(m_up.offsets.size() - 1);
+	}
+
+	NodeId arcCount() const {
+		return static_cast<NodeId>(m_up.nodes.size() + m_down.nodes.size());
+	}
+
+	NodeId shortcutCount() const {
+		return m_shortcuts;
+	}
+
+	size_t memoryUsage() const {
+		return (m_up.offsets.capacity() + m_up.nodes.capacity() + m_down.offsets.capacity() + m_down.nodes.capacity()) * sizeof(NodeId)
+			+ (m_up.weights.capacity() + m_down.weights.capacity()) * sizeof(ArcType)
+			+ (m_up.middles.capacity() + m_down.middles.capacity()) * sizeof(int);
+	}
+
+	ArcType query( Context &forward, Context &backward, NodeId start, NodeId dest, std::vector<NodeId> &path ) const;
+
+	template<class Visitor>
+	void upward( Context &context, NodeId start, bool forwards, Visitor &visit ) const;
+
+	bool save( std::ostream &stream ) const;
+	bool load( std::istream &stream );
+};
+
+// ----------------------------------------------------------------
+//  Name:           build
+//  Description:    Contracts every node of a graph. The next node is
+//                  the one whose contraction adds the fewest arcs
+//                  over those it removes, nudged up by how many of
+//                  its neighbours are already gone and how deep it
+//                  would sit in the hierarchy, so the order spreads
+//                  evenly over the graph. Priorities mostly grow as
+//                  the graph shrinks, so they are only recomputed
+//                  when a node comes to the top, and it is put back
+//                  if it is no longer the best. This is offline
+//                  work and grows faster than linearly on graphs
+//                  with no natural hierarchy, such as grids.
+//  Arguments:      The graph, frozen.
+//  Return Value:   The hierarchy.
+// ----------------------------------------------------------------
+template<class ArcType>
+ContractionHierarchy<ArcType> ContractionHierarchy<ArcType>::build( CSRGraph<ArcType> const &graph ) {
+	NodeId count = graph.nodeCount();
+	WorkLists out(count), in(count);
+
+	for(NodeId node = 0; node != count; node++) {
+		for(NodeId arc = graph.arcBegin(node); arc != graph.arcEnd(node); arc++) {
+			NodeId to = graph.target(arc);
+			if(to != node) {
+				addWorkArc(out[node], to, graph.weight(arc), -1);
+				addWorkArc(in[to], node, graph.weight(arc), -1);
+			}
+		}
+	}
+
+	// the arcs each node still has when it is contracted are exactly
+	// its arcs to higher ranked nodes.
+	WorkLists up(count), down(count);
+	std::vector<int> removedNeighbours(count, 0), depth(count, 0);
+	Context witness(count);
+	IndexedPriorityQueue<int> order(count);
+
+	for(NodeId node = 0; node != count; node++) {
+		order.push(node, 2 * contract(node, out, in, witness, true));
+	}
+
+	ContractionHierarchy hierarchy;
+	while(!order.empty()) {
+		NodeId node = order.top();
+		order.pop();
+
+		int priority = 2 * contract(node, out, in, witness, true) + removedNeighbours[node] + depth[node];
+		if(!order.empty() && priority > order.topKey()) {
+			order.push(node, priority);
+			continue;
+		}
+
+		up[node] = out[node];
+		down[node] = in[node];
+		hierarchy.m_shortcuts += contract(node, out, in, witness, false);
+
+		for(size_t i = 0; i != up[node].size(); i++) {
+			NodeId next = up[node][i].node;
+			removeWorkArc(in[next], node);
+			removedNeighbours[next]++;
+			depth[next] = std::max(depth[next], depth[node] + 1);
+		}
+		for(size_t i = 0; i != down[node].size(); i++) {
+			NodeId previous = down[node][i].node;
+			removeWorkArc(out[previous], node);
+			removedNeighbours[previous]++;
+			depth[previous] = std::max(depth[previous], depth[node] + 1);
+		}
+		std::vector<WorkArc>().swap(out[node]);
+		std::vector<WorkArc>().swap(in[node]);
+	}
+
+	compile(hierarchy.m_up, up);
+	compile(hierarchy.m_down, down);
+	return hierarchy;
+}
+
+// ----------------------------------------------------------------
+//  Name:           contract
+//  Description:    Finds the shortcuts contracting a node needs. For
+//                  every arc u->node, a search from u that avoids
+//                  the node looks for a path to each x (node->x) no
+//                  longer than going through the node; a shortcut
+//                  u->x is needed wherever it finds none.
+//  Arguments:      The node, the outgoing and incoming arcs of the
+//                  nodes not yet contracted, a context for the
+//                  witness searches and whether to only count the
+//                  shortcuts instead of adding them.
+//  Return Value:   When simulating, the edge difference: shortcuts
+//                  needed less arcs removed. Otherwise the number of
+//                  shortcuts added.
+// ----------------------------------------------------------------
+template<class ArcType>
+int ContractionHierarchy<ArcType>::contract( NodeId node, WorkLists &out, WorkLists &in, Context &witness, bool simulate ) {
+	std::vector<WorkArc> const &outArcs = out[node];
+	std::vector<WorkArc> const &inArcs = in[node];
+
+	ArcType longestOut = 0;
+	for(size_t i = 0; i != outArcs.size(); i++) {
+		longestOut = std::max(longestOut, outArcs[i].weight);
+	}
+
+	int shortcuts = 0;
+	for(size_t i = 0; i != inArcs.size(); i++) {
+		NodeId from = inArcs[i].node;
+		ArcType limit = inArcs[i].weight + longestOut;
+
+		witness.reset(static_cast<int>(out.size()));
+		IndexedPriorityQueue<ArcType> &pq = witness.open();
+		witness.setCost(from, 0, -1);
+		pq.push(from, 0);
+
+		// the search can stop once every x has been settled.
+		size_t targets = 0;
+		for(size_t o = 0; o != outArcs.size(); o++) {
+			if(outArcs[o].node != from) {
+				witness.setMarked(outArcs[o].node);
+				targets++;
+			}
+		}
+
+		for(int settled = 0; targets != 0 && !pq.empty() && pq.topKey() <= limit && settled != (simulate ? kSimulateLimit : kWitnessLimit); settled++) {
+			NodeId top = pq.top();
+			pq.pop();
+			if(witness.marked(top)) {
+				targets--;
+			}
+
+			std::vector<WorkArc> const &arcs = out[top];
+			for(size_t a = 0; a != arcs.size(); a++) {
+				NodeId child = arcs[a].node;
+				ArcType cost = witness.cost(top) + arcs[a].weight;
+				if(child != node && cost < witness.cost(child)) {
+					witness.setCost(child, cost, top);
+					if(pq.contains(child)) {
+						pq.decreaseKey(child, cost);
+					}
+					else {
+						pq.push(child, cost);
+					}
+				}
+			}
+		}
+
+		for(size_t o = 0; o != outArcs.size(); o++) {
+			NodeId to = outArcs[o].node;
+			ArcType via = inArcs[i].weight + outArcs[o].weight;
+			if(to == from || witness.cost(to) <= via) {
+				continue;
+			}
+
+			shortcuts++;
+			if(!simulate) {
+				addWorkArc(out[from], to, via, node);
+				addWorkArc(in[to], from, via, node);
+			}
+		}
+	}
+
+	if(simulate) {
+		return shortcuts - static_cast<int>(inArcs.size() + outArcs.size());
+	}
+	return shortcuts;
+}
+
+template<class ArcType>
+void ContractionHierarchy<ArcType>::addWorkArc( std::vector<WorkArc> &arcs, NodeId node, ArcType weight, int middle ) {
+	for(size_t i = 0; i != arcs.size(); i++) {
+		if(arcs[i].node == node) {
+			if(weight < arcs[i].weight) {
+				arcs[i].weight = weight;
+				arcs[i].middle = middle;
+			}
+			return;
+		}
+	}
+
+	WorkArc arc;
+	arc.node = node;
+	arc.weight = weight;
+	arc.middle = middle;
+	arcs.push_back(arc);
+}
+
+template<class ArcType>
+void ContractionHierarchy<ArcType>::removeWorkArc( std::vector<WorkArc> &arcs, NodeId node ) {
+	for(size_t i = 0; i != arcs.size(); i++) {
+		if(arcs[i].node == node) {
+			arcs[i] = arcs.back();
+			arcs.pop_back();
+			return;
+		}
+	}
+}
+
+template<class ArcType>
+void ContractionHierarchy<ArcType>::compile( Half &half, std::vector<std::vector<WorkArc> > const &lists ) {
+	half.offsets.assign(1, 0);
+	half.nodes.clear();
+	half.weights.clear();
+	half.middles.clear();
+
+	for(size_t node = 0; node != lists.size(); node++) {
+		for(size_t i = 0; i != lists[node].size(); i++) {
+			half.nodes.push_back(lists[node][i].node);
+			half.weights.push_back(lists[node][i].weight);
+			half.middles.push_back(lists[node][i].middle);
+		}
+		half.offsets.push_back(static_cast<NodeId>(half.nodes.size()));
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           query
+//  Description:    Searches upwards from both ends; the best node
+//                  where the two meet gives the distance. Each side
+//                  stops once its smallest key is no better than
+//                  the best meeting found.
+//  Arguments:      A context for each direction (both are reset
+//                  first), the start id, the destination id and the
+//                  vector to write the path into (destination
+//                  first), in original nodes.
+//  Return Value:   The cost of the path, or infinity() if dest
+//                  cannot be reached (the path is then left empty).
+// ----------------------------------------------------------------
+template<class ArcType>
+ArcType ContractionHierarchy<ArcType>::query( Context &forward, Context &backward, NodeId start, NodeId dest, std::vector<NodeId> &path ) const {
+	forward.reset(nodeCount());
+	backward.reset(nodeCount());
+	IndexedPriorityQueue<ArcType> &forwardPq = forward.open();
+	IndexedPriorityQueue<ArcType> &backwardPq = backward.open();
+
+	forward.setCost(start, 0, -1);
+	forwardPq.push(start, 0);
+	backward.setCost(dest, 0, -1);
+	backwardPq.push(dest, 0);
+
+	ArcType mu = Context::infinity();
+	int meet = -1;
+	if(start == dest) {
+		mu = 0;
+		meet = start;
+	}
+
+	for(;;) {
+		bool forwards;
+		if(forwardPq.empty() || forwardPq.topKey() >= mu) {
+			if(backwardPq.empty() || backwardPq.topKey() >= mu) {
+				break;
+			}
+			forwards = false;
+		}
+		else {
+			forwards = backwardPq.empty() || backwardPq.topKey() >= mu || forwardPq.topKey() <= backwardPq.topKey();
+		}
+
+		Half const &half = forwards ? m_up : m_down;
+		Context &context = forwards ? forward : backward;
+		Context &other = forwards ? backward : forward;
+		IndexedPriorityQueue<ArcType> &pq = context.open();
+
+		Half const &opposite = forwards ? m_down : m_up;
+		NodeId top = pq.top();
+		pq.pop();
+		context.countExpansion();
+
+		// stall on demand: if a higher node already reached offers a
+		// shorter way in, top is not on a shortest path and its arcs
+		// need not be searched.
+		bool stalled = false;
+		for(NodeId arc = opposite.offsets[top]; arc != opposite.offsets[top + 1] && !stalled; arc++) {
+			stalled = context.cost(opposite.nodes[arc]) + opposite.weights[arc] < context.cost(top);
+		}
+		if(stalled) {
+			continue;
+		}
+
+		for(NodeId arc = half.offsets[top]; arc != half.offsets[top + 1]; arc++) {
+			NodeId child = half.nodes[arc];
+			ArcType gC = context.cost(top) + half.weights[arc];
+
+			if(gC < context.cost(child)) {
+				context.setCost(child, gC, top);
+				if(pq.contains(child)) {
+					pq.decreaseKey(child, gC);
+				}
+				else {
+					pq.push(child, gC);
+				}
+
+				if(other.reached(child) && gC + other.cost(child) < mu) {
+					mu = gC + other.cost(child);
+					meet = child;
+				}
+			}
+		}
+	}
+
+	if(meet != -1) {
+		// the hierarchy path start..meet..dest, then each of its arcs
+		// unpacked into the original nodes.
+		std::vector<NodeId> climb;
+		for(int node = meet; node != -1; node = forward.previous(node)) {
+			climb.push_back(node);
+		}
+		std::reverse(climb.begin(), climb.end());
+		for(int node = backward.previous(meet); node != -1; node = backward.previous(node)) {
+			climb.push_back(node);
+		}
+
+		std::vector<NodeId> nodes(1, start);
+		for(size_t i = 0; i + 1 < climb.size(); i++) {
+			unpack(climb[i], climb[i + 1], nodes);
+		}
+		path.insert(path.end(), nodes.rbegin(), nodes.rend());
+	}
+	return mu;
+}
+
+// ----------------------------------------------------------------
+//  Name:           upward
+//  Description:    One half of a query on its own: a search from a
+//                  node that only climbs the hierarchy, run until
+//                  nothing is left to climb. Forwards it follows
+//                  the arcs leaving nodes, backwards the arcs
+//                  entering them, as query does from the start and
+//                  the destination. Every distance to a node from
+//                  start (or to start from it) is the shortest that
+//                  the node can be met with by the other half, which
+//                  is what DistanceTable builds its buckets from.
+//                  Nodes that stall on demand are not visited.
+//  Arguments:      The search context (it is reset first), the node
+//                  to start from, the direction and a functor called
+//                  as visit(node, cost) on each node settled.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType>
+template<class Visitor>
+void ContractionHierarchy<ArcType>::upward( Context &context, NodeId start, bool forwards, Visitor &visit ) const {
+	Half const &half = forwards ? m_up : m_down;
+	Half const &opposite = forwards ? m_down : m_up;
+	context.reset(nodeCount());
+	IndexedPriorityQueue<ArcType> &pq = context.open();
+
+	context.setCost(start, 0, -1);
+	pq.push(start, 0);
+
+	while(!pq.empty()) {
+		NodeId top = pq.top();
+		ArcType cost = pq.topKey();
+		pq.pop();
+		context.countExpansion();
+
+		bool stalled = false;
+		for(NodeId arc = opposite.offsets[top]; arc != opposite.offsets[top + 1] && !stalled; arc++) {
+			stalled = context.cost(opposite.nodes[arc]) + opposite.weights[arc] < cost;
+		}
+		if(stalled) {
+			continue;
+		}
+		visit(top, cost);
+
+		for(NodeId arc = half.offsets[top]; arc != half.offsets[top + 1]; arc++) {
+			NodeId child = half.nodes[arc];
+			ArcType gC = cost + half.weights[arc];
+
+			if(gC < context.cost(child)) {
+				context.setCost(child, gC, top);
+				if(pq.contains(child)) {
+					pq.decreaseKey(child, gC);
+				}
+				else {
+					pq.push(child, gC);
+				}
+			}
+		}
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           findArc
+//  Description:    Finds the hierarchy arc from->to. Up arcs are
+//                  numbered first, then down arcs follow them.
+//  Arguments:      The two ends of the arc.
+//  Return Value:   The arc's number, or -1 if there is none.
+// ----------------------------------------------------------------
+template<class ArcType>
+int ContractionHierarchy<ArcType>::findArc( NodeId from, NodeId to ) const {
+	for(NodeId arc = m_up.offsets[from]; arc != m_up.offsets[from + 1]; arc++) {
+		if(m_up.nodes[arc] == to) {
+			return static_cast<int>(arc);
+		}
+	}
+	for(NodeId arc = m_down.offsets[to]; arc != m_down.offsets[to + 1]; arc++) {
+		if(m_down.nodes[arc] == from) {
+			return static_cast<int>(m_up.nodes.size() + arc);
+		}
+	}
+	return -1;
+}
+
+// ----------------------------------------------------------------
+//  Name:           middle
+//  Description:    Finds the node the hierarchy arc from->to skips.
+//  Arguments:      The two ends of the arc.
+//  Return Value:   The skipped node, or -1 for an original arc.
+// ----------------------------------------------------------------
+template<class ArcType>
+int ContractionHierarchy<ArcType>::middle( NodeId from, NodeId to ) const {
+	int arc = findArc(from, to);
+	if(arc == -1) {
+		return -1;
+	}
+	NodeId upArcs = static_cast<NodeId>(m_up.nodes.size());
+	return static_cast<NodeId>(arc) < upArcs ? m_up.middles[arc] : m_down.middles[arc - upArcs];
+}
+
+// ----------------------------------------------------------------
+//  Name:           checkMiddles
+//  Description:    Makes sure every shortcut unpacks in a finite
+//                  number of steps, i.e. that no shortcut depends
+//                  on itself through the arcs its middle splits it
+//                  into. A hierarchy from build always passes; this
+//                  is for ones read by load.
+//  Arguments:      None.
+//  Return Value:   false if unpacking some shortcut would never end.
+// ----------------------------------------------------------------
+template<class ArcType>
+bool ContractionHierarchy<ArcType>::checkMiddles() const {
+	NodeId upArcs = static_cast<NodeId>(m_up.nodes.size());
+	NodeId arcs = arcCount();
+
+	// the two ends and the middle of every arc, numbered as findArc does.
+	std::vector<NodeId> from(arcs), to(arcs);
+	std::vector<int> middles(arcs);
+	for(NodeId node = 0; node != nodeCount(); node++) {
+		for(NodeId arc = m_up.offsets[node]; arc != m_up.offsets[node + 1]; arc++) {
+			from[arc] = node;
+			to[arc] = m_up.nodes[arc];
+			middles[arc] = m_up.middles[arc];
+		}
+		for(NodeId arc = m_down.offsets[node]; arc != m_down.offsets[node + 1]; arc++) {
+			from[upArcs + arc] = m_down.nodes[arc];
+			to[upArcs + arc] = node;
+			middles[upArcs + arc] = m_down.middles[arc];
+		}
+	}
+
+	// depth-first over "arc needs arc", failing on an arc that is
+	// still on the stack. 0 = not seen, 1 = on the stack, 2 = done.
+	std::vector<char> state(arcs, 0);
+	std::vector<NodeId> stack;
+	for(NodeId root = 0; root != arcs; root++) {
+		if(state[root] != 0 || middles[root] == -1) {
+			continue;
+		}
+		state[root] = 1;
+		stack.push_back(root);
+
+		while(!stack.empty()) {
+			NodeId arc = stack.back();
+			NodeId skipped = static_cast<NodeId>(middles[arc]);
+			int halves[2] = { findArc(from[arc], skipped), findArc(skipped, to[arc]) };
+
+			bool pushed = false;
+			for(int i = 0; i != 2 && !pushed; i++) {
+				if(halves[i] == -1 || middles[halves[i]] == -1 || state[halves[i]] == 2) {
+					continue;
+				}
+				if(state[halves[i]] == 1) {
+					return false;
+				}
+				state[halves[i]] = 1;
+				stack.push_back(static_cast<NodeId>(halves[i]));
+				pushed = true;
+			}
+			if(!pushed) {
+				state[arc] = 2;
+				stack.pop_back();
+			}
+		}
+	}
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           unpack
+//  Description:    Expands the hierarchy arc from->to into original
+//                  arcs.
+//  Arguments:      The two ends of the arc and the vector to append
+//                  the nodes after from (up to and including to) to.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType>
+void ContractionHierarchy<ArcType>::unpack( NodeId from, NodeId to, std::vector<NodeId> &nodes ) const {
+	std::vector<std::pair<NodeId, NodeId> > pending(1, std::make_pair(from, to));
+
+	while(!pending.empty()) {
+		std::pair<NodeId, NodeId> arc = pending.back();
+		pending.pop_back();
+
+		int skipped = middle(arc.first, arc.second);
+		if(skipped == -1) {
+			nodes.push_back(arc.second);
+		}
+		else {
+			// the first half goes on last so it comes off first.
+			pending.push_back(std::make_pair(static_cast<NodeId>(skipped), arc.second));
+			pending.push_back(std::make_pair(arc.first, static_cast<NodeId>(skipped)));
+		}
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           save
+//  Description:    Writes the hierarchy in a binary format that load
+//                  reads back. The stream should be opened with
+//                  std::ios::binary.
+//  Arguments:      The stream to write to.
+//  Return Value:   true if everything was written.
+// ----------------------------------------------------------------
+template<class ArcType>
+bool ContractionHierarchy<ArcType>::save( std::ostream &stream ) const {
+	char const magic[4] = { 'A', 'S', 'C', 'H' };
+	unsigned int header[3] = { 1, static_cast<unsigned int>(sizeof(ArcType)), nodeCount() };
+
+	stream.write(magic, sizeof(magic));
+	stream.write(reinterpret_cast<char const *>(header), sizeof(header));
+	stream.write(reinterpret_cast<char const *>(&m_shortcuts), sizeof(m_shortcuts));
+	return writeHalf(stream, m_up) && writeHalf(stream, m_down);
+}
+
+// ----------------------------------------------------------------
+//  Name:           load
+//  Description:    Replaces this hierarchy with one written by save.
+//  Arguments:      The stream to read from.
+//  Return Value:   true if it loaded. On false (a different format,
+//                  arc type or a truncated file) the hierarchy is
+//                  left empty.
+// ----------------------------------------------------------------
+template<class ArcType>
+bool ContractionHierarchy<ArcType>::load( std::istream &stream ) {
+	*this = ContractionHierarchy();
+
+	char magic[4];
+	unsigned int header[3];
+	NodeId shortcuts;
+	stream.read(magic, sizeof(magic));
+	stream.read(reinterpret_cast<char *>(header), sizeof(header));
+	stream.read(reinterpret_cast<char *>(&shortcuts), sizeof(shortcuts));
+
+	if(!stream || magic[0] != 'A' || magic[1] != 'S' || magic[2] != 'C' || magic[3] != 'H'
+		|| header[0] != 1 || header[1] != sizeof(ArcType) || header[2] == static_cast<unsigned int>(-1)) {
+		return false;
+	}
+
+	ContractionHierarchy loaded;
+	loaded.m_shortcuts = shortcuts;
+	if(!readHalf(stream, loaded.m_up, header[2]) || !readHalf(stream, loaded.m_down, header[2])
+		|| !loaded.checkMiddles()) {
+		return false;
+	}
+
+	*this = loaded;
+	return true;
+}
+
+template<class ArcType>
+bool ContractionHierarchy<ArcType>::writeHalf( std::ostream &stream, Half const &half ) {
+	NodeId arcs = static_cast<NodeId>(half.nodes.size());
+	stream.write(reinterpret_cast<char const *>(&arcs), sizeof(arcs));
+	stream.write(reinterpret_cast<char const *>(&half.offsets[0]), half.offsets.size() * sizeof(NodeId));
+	if(arcs != 0) {
+		stream.write(reinterpret_cast<char const *>(&half.nodes[0]), arcs * sizeof(NodeId));
+		stream.write(reinterpret_cast<char const *>(&half.weights[0]), arcs * sizeof(ArcType));
+		stream.write(reinterpret_cast<char const *>(&half.middles[0]), arcs * sizeof(int));
+	}
+	return !stream.fail();
+}
+
+template<class ArcType>
+template<class T>
+bool ContractionHierarchy<ArcType>::readArray( std::istream &stream, std::vector<T> &values, size_t count ) {
+	values.clear();
+	while(values.size() != count && stream) {
+		size_t start = values.size();
+		values.resize(start + (count - start < kReadBlock ? count - start : kReadBlock));
+		stream.read(reinterpret_cast<char *>(&values[start]), (values.size() - start) * sizeof(T));
+	}
+	return !stream.fail();
+}
+
+template<class ArcType>
+bool ContractionHierarchy<ArcType>::readHalf( std::istream &stream, Half &half, NodeId nodeCount ) {
+	NodeId arcs = 0;
+	stream.read(reinterpret_cast<char *>(&arcs), sizeof(arcs));
+	if(!stream || arcs > static_cast<NodeId>(INT_MAX)) {
+		return false;
+	}
+
+	if(!readArray(stream, half.offsets, static_cast<size_t>(nodeCount) + 1)
+		|| !readArray(stream, half.nodes, arcs)
+		|| !readArray(stream, half.weights, arcs)
+		|| !readArray(stream, half.middles, arcs)) {
+		return false;
+	}
+
+	// reject offsets that would index outside the arc arrays.
+	if(half.offsets[0] != 0 || half.offsets[nodeCount] != arcs) {
+		return false;
+	}
+	for(NodeId node = 0; node != nodeCount; node++) {
+		if(half.offsets[node] > half.offsets[node + 1]) {
+			return false;
+		}
+	}
+
+	// a middle is -1 or a node other than the arc's own two ends;
+	// checkMiddles rules out longer loops once both halves are in.
+	for(NodeId node = 0; node != nodeCount; node++) {
+		for(NodeId arc = half.offsets[node]; arc != half.offsets[node + 1]; arc++) {
+			int skipped = half.middles[arc];
+			if(half.nodes[arc] >= nodeCount
+				|| (skipped != -1 && (skipped < 0 || static_cast<NodeId>(skipped) >= nodeCount
+					|| static_cast<NodeId>(skipped) == node || static_cast<NodeId>(skipped) == half.nodes[arc]))) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+#endif
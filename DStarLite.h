@@ -0,0 +1,447 @@
+#ifndef DSTARLITE_H
+#define DSTARLITE_H
+
+#include <vector>
+#include <list>
+#include <algorithm>
+
+#include "Graph.h"
+#include "IndexedPriorityQueue.h"
+#include "SearchContext.h"
+#include "GraphObserver.h"
+
+// -------------------------------------------------------
+// Name:        DStarLite
+// Description: An incremental planner (D* Lite) on a Graph
+//              whose arc weights change. It searches backwards
+//              from the goal and keeps its search tree between
+//              calls: g(v) is the cost from v to the goal the
+//              last search settled on, and rhs(v) the best cost
+//              through v's successors now. When arcs change only
+//              the nodes whose g and rhs then disagree, and the
+//              ones that depend on them, are searched again, so
+//              a replan costs about as much as the part of the
+//              tree the change affects rather than the graph.
+//              With a fixed start it is LPA*; D* Lite adds a
+//              start that moves along the path between replans,
+//              by raising every later key by the heuristic
+//              distance travelled (m_km) instead of re-keying
+//              the queue.
+//
+//              Use: plan() once, then after changing the graph
+//              through Graph/GraphArc, report every changed arc
+//              to arcChanged(); call moveStart() as the agent
+//              advances, and replan() to get the new path. The
+//              heuristic must be admissible and consistent, and
+//              a node in the plan must not be removed while the
+//              plan is live. The planner observes the graph only
+//              to grow with it: a node added after plan() starts
+//              with no way to the goal until arcs to it are
+//              reported.
+// -------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic = typename Graph<NodeType, ArcType>::Euclidean>
+class DStarLite : public GraphObserver<ArcType> {
+public:
+	typedef Graph<NodeType, ArcType> GraphType;
+	typedef GraphNode<NodeType, ArcType> Node;
+	typedef GraphArc<NodeType, ArcType> Arc;
+
+	// keys order by the first value, then the second.
+	struct Key {
+		ArcType first;
+		ArcType second;
+
+		bool operator<( Key const &other ) const {
+			return first < other.first || (first == other.first && second < other.second);
+		}
+	};
+
+private:
+	GraphType & m_graph;
+	Heuristic m_heuristic;
+
+	std::vector<ArcType> m_g;
+	std::vector<ArcType> m_rhs;
+	IndexedPriorityQueue<Key> m_open;
+
+	int m_start;
+	int m_goal;
+	// where the start was when the keys were last raised.
+	int m_last;
+	ArcType m_km;
+	size_t m_expanded;
+
+	static ArcType infinity() {
+		return SearchContext<ArcType>::infinity();
+	}
+
+	static ArcType add( ArcType a, ArcType b ) {
+		return a == infinity() || b == infinity() ? infinity() : a + b;
+	}
+
+	Key key( int node ) const {
+		ArcType best = m_g[node] < m_rhs[node] ? m_g[node] : m_rhs[node];
+		Key result = { add(add(best, m_heuristic(m_start, node)), m_km), best };
+		return result;
+	}
+
+	// the queued keys were made for the start as it was; raising
+	// later keys by the heuristic distance it has moved since keeps
+	// them comparable.
+	void followStart() {
+		if(m_last != m_start) {
+			m_km = add(m_km, m_heuristic(m_last, m_start));
+			m_last = m_start;
+		}
+	}
+
+	ArcType weight( int from, int to ) const;
+	ArcType bestThroughSuccessors( int node ) const;
+	void update( int node );
+	void search();
+
+	// not copyable
+	DStarLite( DStarLite const & );
+	DStarLite & operator=( DStarLite const & );
+
+public:
+	explicit DStarLite( GraphType &graph )
+		: m_graph( graph ), m_heuristic( graph ), m_start( -1 ), m_goal( -1 ), m_last( -1 ), m_km( 0 ), m_expanded( 0 ) {
+		m_graph.addObserver(this);
+	}
+
+	DStarLite( GraphType &graph, Heuristic const &heuristic )
+		: m_graph( graph ), m_heuristic( heuristic ), m_start( -1 ), m_goal( -1 ), m_last( -1 ), m_km( 0 ), m_expanded( 0 ) {
+		m_graph.addObserver(this);
+	}
+
+	~DStarLite() {
+		m_graph.removeObserver(this);
+	}
+
+	ArcType plan( int start, int goal );
+	void arcChanged( int from, int to, ArcType oldWeight );
+	void moveStart( int start );
+	ArcType replan();
+
+	int next( int node ) const;
+	void path( std::vector<Node*> &path ) const;
+
+	// Accessor functions
+	int start() const {
+		return m_start;
+	}
+
+	int goal() const {
+		return m_goal;
+	}
+
+	// the cost from the start to the goal, as of the last (re)plan.
+	ArcType cost() const {
+		return m_g[m_start];
+	}
+
+	// the nodes the last plan() or replan() expanded.
+	size_t expanded() const {
+		return m_expanded;
+	}
+
+	// GraphObserver: arc changes are reported through arcChanged(),
+	// so that several can be batched before a replan.
+	void nodeAdded( int index );
+
+	void arcAdded( int, int, ArcType ) {
+	}
+
+	void arcRemoved( int, int ) {
+	}
+
+	void arcWeightChanged( int, int, ArcType, ArcType ) {
+	}
+
+	void nodeRemoved( int ) {
+	}
+};
+
+// ----------------------------------------------------------------
+//  Name:           nodeAdded
+//  Description:    Grows g, rhs and the queue to cover a node added to the
+//                  graph (which may have grown), and starts the
+//                  node with no way to the goal, which is right for
+//                  a node with no arcs yet and forgets whatever a
+//                  removed node in the same slot had.
+//  Arguments:      The new node's index.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+void DStarLite<NodeType, ArcType, Heuristic>::nodeAdded( int index ) {
+	if(m_goal == -1) {
+		return;
+	}
+	if(index >= static_cast<int>(m_g.size())) {
+		m_g.resize(m_graph.getMaxNodes(), infinity());
+		m_rhs.resize(m_graph.getMaxNodes(), infinity());
+		m_open.reserve(m_graph.getMaxNodes());
+	}
+	m_g[index] = infinity();
+	m_rhs[index] = infinity();
+	if(m_open.contains(index)) {
+		m_open.remove(index);
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           plan
+//  Description:    Forgets any previous plan and searches from
+//                  scratch.
+//  Arguments:      The start and goal node indices.
+//  Return Value:   The cost of the path, or infinity() if the goal
+//                  cannot be reached.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+ArcType DStarLite<NodeType, ArcType, Heuristic>::plan( int start, int goal ) {
+	int count = m_graph.getMaxNodes();
+	m_g.assign(count, infinity());
+	m_rhs.assign(count, infinity());
+	m_open.clear();
+	m_open.reserve(count);
+
+	m_start = start;
+	m_last = start;
+	m_goal = goal;
+	m_km = 0;
+
+	m_rhs[goal] = 0;
+	m_open.push(goal, key(goal));
+	m_expanded = 0;
+	search();
+	return cost();
+}
+
+// ----------------------------------------------------------------
+//  Name:           arcChanged
+//  Description:    Tells the planner that the arc from -> to now
+//                  has a different weight, or has been added or
+//                  removed (the graph must already show the
+//                  change). Only rhs(from) is repaired here; the
+//                  search happens in replan(), so several changes
+//                  can be batched.
+//  Arguments:      The two node indices and the arc's weight before
+//                  the change (infinity() if it did not exist).
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+void DStarLite<NodeType, ArcType, Heuristic>::arcChanged( int from, int to, ArcType oldWeight ) {
+	followStart();
+
+	if(from == m_goal) {
+		return;
+	}
+	ArcType newWeight = weight(from, to);
+	if(newWeight < oldWeight) {
+		ArcType through = add(newWeight, m_g[to]);
+		if(through < m_rhs[from]) {
+			m_rhs[from] = through;
+		}
+	}
+	else if(m_rhs[from] == add(oldWeight, m_g[to])) {
+		// the best way out of from may have been this arc.
+		m_rhs[from] = bestThroughSuccessors(from);
+	}
+	update(from);
+}
+
+// ----------------------------------------------------------------
+//  Name:           moveStart
+//  Description:    Moves the start, e.g. to the next node on the
+//                  path once the agent has reached it. Nothing is
+//                  searched until replan().
+//  Arguments:      The new start node index.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+void DStarLite<NodeType, ArcType, Heuristic>::moveStart( int start ) {
+	m_start = start;
+}
+
+// ----------------------------------------------------------------
+//  Name:           replan
+//  Description:    Repairs the search tree after arcChanged() and
+//                  moveStart() calls.
+//  Arguments:      None.
+//  Return Value:   The cost of the path from the current start, or
+//                  infinity() if the goal cannot be reached.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+ArcType DStarLite<NodeType, ArcType, Heuristic>::replan() {
+	followStart();
+	m_expanded = 0;
+	search();
+	return cost();
+}
+
+// ----------------------------------------------------------------
+//  Name:           next
+//  Description:    The step to take from a node: the successor
+//                  that minimises arc weight + g.
+//  Arguments:      The node index.
+//  Return Value:   The successor's index, or -1 if there is no way
+//                  to the goal (or node is the goal).
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+int DStarLite<NodeType, ArcType, Heuristic>::next( int node ) const {
+	if(node == m_goal) {
+		return -1;
+	}
+
+	int best = -1;
+	ArcType bestCost = infinity();
+	Node *pNode = m_graph.nodeArray()[node];
+	typename Node::ArcList::const_iterator iter = pNode->arcList().begin();
+	for( ; iter != pNode->arcList().end(); ++iter) {
+		ArcType through = add(iter->weight(), m_g[iter->node()->index()]);
+		if(through < bestCost) {
+			bestCost = through;
+			best = iter->node()->index();
+		}
+	}
+	return best;
+}
+
+// ----------------------------------------------------------------
+//  Name:           path
+//  Description:    Follows next() from the start to the goal.
+//  Arguments:      The vector to write the path into (destination
+//                  first, as Graph::aStar does). It is left empty
+//                  if the goal cannot be reached.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+void DStarLite<NodeType, ArcType, Heuristic>::path( std::vector<Node*> &path ) const {
+	if(cost() == infinity()) {
+		return;
+	}
+
+	size_t first = path.size();
+	int node = m_start;
+	for(int steps = 0; node != -1 && steps <= m_graph.getMaxNodes(); steps++) {
+		path.push_back(m_graph.nodeArray()[node]);
+		node = next(node);
+	}
+	std::reverse(path.begin() + first, path.end());
+}
+
+// the weight of the arc from -> to, or infinity() if there is none;
+// GraphNode::getArc finds it through the node's ArcIndex once the
+// node has many arcs.
+template<class NodeType, class ArcType, class Heuristic>
+ArcType DStarLite<NodeType, ArcType, Heuristic>::weight( int from, int to ) const {
+	Node **nodes = m_graph.nodeArray();
+	if(nodes[from] == 0 || nodes[to] == 0) {
+		return infinity();
+	}
+	Arc *pArc = nodes[from]->getArc(nodes[to]);
+	return pArc != 0 ? pArc->weight() : infinity();
+}
+
+template<class NodeType, class ArcType, class Heuristic>
+ArcType DStarLite<NodeType, ArcType, Heuristic>::bestThroughSuccessors( int node ) const {
+	ArcType best = infinity();
+	Node *pNode = m_graph.nodeArray()[node];
+	if(pNode == 0) {
+		return best;
+	}
+	typename Node::ArcList::const_iterator iter = pNode->arcList().begin();
+	for( ; iter != pNode->arcList().end(); ++iter) {
+		ArcType through = add(iter->weight(), m_g[iter->node()->index()]);
+		if(through < best) {
+			best = through;
+		}
+	}
+	return best;
+}
+
+// ----------------------------------------------------------------
+//  Name:           update
+//  Description:    Queues a node whose g and rhs disagree, with its
+//                  current key, and takes one whose agree out.
+//  Arguments:      The node index.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+void DStarLite<NodeType, ArcType, Heuristic>::update( int node ) {
+	bool queued = m_open.contains(node);
+	if(m_g[node] != m_rhs[node]) {
+		if(queued) {
+			m_open.changeKey(node, key(node));
+		}
+		else {
+			m_open.push(node, key(node));
+		}
+	}
+	else if(queued) {
+		m_open.remove(node);
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           search
+//  Description:    Expands inconsistent nodes in key order until
+//                  the start is consistent and nothing queued could
+//                  still lower its cost.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+void DStarLite<NodeType, ArcType, Heuristic>::search() {
+	Node **nodes = m_graph.nodeArray();
+
+	while(!m_open.empty() && (m_open.topKey() < key(m_start) || m_rhs[m_start] != m_g[m_start])) {
+		int top = m_open.top();
+		Key old = m_open.topKey();
+		Key now = key(top);
+
+		if(old < now) {
+			// queued before the start moved; it belongs further back.
+			m_open.changeKey(top, now);
+			continue;
+		}
+
+		m_open.pop();
+		m_expanded++;
+		std::vector<Node*> const &predecessors = nodes[top]->incoming();
+
+		if(m_rhs[top] < m_g[top]) {
+			// overconsistent: its cost has dropped, settle it.
+			m_g[top] = m_rhs[top];
+			for(size_t i = 0; i != predecessors.size(); i++) {
+				int predecessor = predecessors[i]->index();
+				if(predecessor != m_goal) {
+					ArcType through = add(weight(predecessor, top), m_g[top]);
+					if(through < m_rhs[predecessor]) {
+						m_rhs[predecessor] = through;
+					}
+				}
+				update(predecessor);
+			}
+		}
+		else {
+			// underconsistent: its cost has risen, so it and everything
+			// that went through it must find another way.
+			ArcType oldCost = m_g[top];
+			m_g[top] = infinity();
+			for(size_t i = 0; i <= predecessors.size(); i++) {
+				int predecessor = i != predecessors.size() ? predecessors[i]->index() : top;
+				if(predecessor != m_goal) {
+					ArcType through = predecessor == top ? oldCost : add(weight(predecessor, top), oldCost);
+					if(m_rhs[predecessor] == through || predecessor == top) {
+						m_rhs[predecessor] = bestThroughSuccessors(predecessor);
+					}
+				}
+				update(predecessor);
+			}
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,359 @@
+#ifndef DISTANCETABLE_H
+#define DISTANCETABLE_H
+
+#include <vector>
+#include <chrono>
+#include <cstddef>
+
+#include "CSRGraph.h"
+#include "ContractionHierarchy.h"
+#include "SearchContext.h"
+#include "ThreadPool.h"
+
+// -------------------------------------------------------
+// Name:        DistanceMatrix
+// Description: A dense rows x columns table of costs. Each row
+//              starts on a 64-byte boundary (rows are padded up
+//              to a whole number of cache lines), so threads
+//              filling different rows never write to the same
+//              cache line.
+// -------------------------------------------------------
+template<class ArcType>
+class DistanceMatrix {
+private:
+	static const size_t kCacheLine = 64;
+
+	std::vector<ArcType> m_storage;
+	// where the first row starts in m_storage; an index rather than
+	// a pointer, so the matrix can be copied.
+	size_t m_first;
+	size_t m_rows;
+	size_t m_columns;
+	size_t m_stride;
+
+public:
+	DistanceMatrix() : m_first( 0 ), m_rows( 0 ), m_columns( 0 ), m_stride( 0 ) {
+	}
+
+	// Accessor functions
+	size_t rows() const {
+		return m_rows;
+	}
+
+	size_t columns() const {
+		return m_columns;
+	}
+
+	// the distance in elements from one row to the next.
+	size_t stride() const {
+		return m_stride;
+	}
+
+	ArcType * row( size_t r ) {
+		return &m_storage[m_first + r * m_stride];
+	}
+
+	ArcType const * row( size_t r ) const {
+		return &m_storage[m_first + r * m_stride];
+	}
+
+	ArcType & at( size_t r, size_t c ) {
+		return m_storage[m_first + r * m_stride + c];
+	}
+
+	ArcType const & at( size_t r, size_t c ) const {
+		return m_storage[m_first + r * m_stride + c];
+	}
+
+	size_t memoryUsage() const {
+		return m_storage.capacity() * sizeof(ArcType);
+	}
+
+	// Makes the matrix rows x columns with every entry set to value.
+	void assign( size_t rows, size_t columns, ArcType value ) {
+		size_t perLine = kCacheLine / sizeof(ArcType) > 0 ? kCacheLine / sizeof(ArcType) : 1;
+		m_rows = rows;
+		m_columns = columns;
+		m_stride = (columns + perLine - 1) / perLine * perLine;
+		// one line more than needed, to slide the start onto a boundary
+		m_storage.assign(rows * m_stride + perLine, value);
+		size_t address = reinterpret_cast<size_t>(&m_storage[0]);
+		size_t misalignment = address % kCacheLine;
+		m_first = misalignment == 0 ? 0 : (kCacheLine - misalignment) / sizeof(ArcType);
+	}
+};
+
+// -------------------------------------------------------
+// Name:        DistanceTable
+// Description: Fills distance matrices between a set of
+//              sources and a set of targets on a frozen graph,
+//              with the rows spread over a ThreadPool.
+//
+//              On a CSRGraph each row is one uniform cost
+//              search from its source that stops once every
+//              target is settled, so a row costs one search
+//              rather than one per target.
+//
+//              On a ContractionHierarchy the work is shared
+//              between sources as well (the bucket method): an
+//              upward search backwards from each target leaves
+//              (target, distance) in a bucket at every node it
+//              settles; an upward search forwards from each
+//              source then scans the buckets of the nodes it
+//              settles, and the shortest source -> node ->
+//              target sum is the distance. Each source and each
+//              target is searched once, however large the
+//              table, instead of twice per entry.
+//
+//              Unreachable pairs are left at infinity().
+// -------------------------------------------------------
+template<class ArcType>
+class DistanceTable {
+public:
+	typedef typename CSRGraph<ArcType>::NodeId NodeId;
+	typedef DistanceMatrix<ArcType> Matrix;
+
+	struct Stats {
+		size_t sources;
+		size_t targets;
+		int threads;
+		// nodes settled by all the searches together
+		size_t settled;
+		// bucket entries left by the target searches (CH only)
+		size_t bucketEntries;
+		double seconds;
+	};
+
+private:
+	ThreadPool m_pool;
+	std::vector<SearchContext<ArcType> > m_contexts;
+
+// -------------------------------------------------------
+// Description: the bucket entries of the hierarchy method,
+//              grouped by node: those of node u are
+//              [m_bucketOffsets[u], m_bucketOffsets[u + 1]).
+// -------------------------------------------------------
+	struct BucketEntry {
+		NodeId column;
+		ArcType cost;
+	};
+	std::vector<NodeId> m_bucketOffsets;
+	std::vector<BucketEntry> m_buckets;
+
+	// what a target search leaves behind, before grouping by node.
+	struct Visit {
+		NodeId node;
+		ArcType cost;
+	};
+
+	struct CollectVisits {
+		std::vector<Visit> *visits;
+
+		void operator()( NodeId node, ArcType cost ) {
+			Visit visit = { node, cost };
+			visits->push_back(visit);
+		}
+	};
+
+	struct ScanBuckets {
+		NodeId const *offsets;
+		BucketEntry const *buckets;
+		ArcType *row;
+
+		void operator()( NodeId node, ArcType cost ) {
+			for(NodeId entry = offsets[node]; entry != offsets[node + 1]; entry++) {
+				ArcType distance = cost + buckets[entry].cost;
+				if(distance < row[buckets[entry].column]) {
+					row[buckets[entry].column] = distance;
+				}
+			}
+		}
+	};
+
+	// not copyable
+	DistanceTable( DistanceTable const & );
+	DistanceTable & operator=( DistanceTable const & );
+
+	static double secondsSince( std::chrono::steady_clock::time_point start ) {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+public:
+	explicit DistanceTable( int threads = 0 ) : m_pool( threads ), m_contexts( m_pool.workerCount() ) {
+	}
+
+	int threadCount() const {
+		return m_pool.workerCount();
+	}
+
+	Stats compute( CSRGraph<ArcType> const &graph, NodeId const *sources, size_t sourceCount,
+	               NodeId const *targets, size_t targetCount, Matrix &table );
+
+	Stats compute( ContractionHierarchy<ArcType> const &hierarchy, NodeId const *sources, size_t sourceCount,
+	               NodeId const *targets, size_t targetCount, Matrix &table );
+};
+
+// ----------------------------------------------------------------
+//  Name:           compute
+//  Description:    Fills a table by one uniform cost search per
+//                  source, each stopped when the last target is
+//                  settled.
+//  Arguments:      The graph, the sources and their count, the
+//                  targets and their count (either list may repeat
+//                  nodes) and the matrix to fill: it is made
+//                  sourceCount x targetCount, and entry (i, j) is
+//                  the distance from sources[i] to targets[j].
+//  Return Value:   What the computation took.
+// ----------------------------------------------------------------
+template<class ArcType>
+typename DistanceTable<ArcType>::Stats DistanceTable<ArcType>::compute( CSRGraph<ArcType> const &graph, NodeId const *sources, size_t sourceCount,
+                                                                      NodeId const *targets, size_t targetCount, Matrix &table ) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	table.assign(sourceCount, targetCount, SearchContext<ArcType>::infinity());
+
+	// which nodes are targets, and how many different ones there are.
+	std::vector<char> isTarget(graph.nodeCount(), 0);
+	size_t distinct = 0;
+	for(size_t j = 0; j != targetCount; j++) {
+		if(!isTarget[targets[j]]) {
+			isTarget[targets[j]] = 1;
+			distinct++;
+		}
+	}
+
+	std::vector<size_t> settled(m_pool.workerCount(), 0);
+	std::vector<SearchContext<ArcType> > &contexts = m_contexts;
+
+	m_pool.parallelFor(sourceCount, 1, [&](int worker, size_t begin, size_t end) {
+		SearchContext<ArcType> &context = contexts[worker];
+
+		for(size_t i = begin; i != end; i++) {
+			context.reset(graph.nodeCount());
+			IndexedPriorityQueue<ArcType> &pq = context.open();
+			context.setCost(sources[i], 0, -1);
+			pq.push(sources[i], 0);
+			size_t remaining = distinct;
+
+			while(!pq.empty() && remaining != 0) {
+				NodeId top = pq.top();
+				ArcType cost = pq.topKey();
+				pq.pop();
+				context.countExpansion();
+				if(isTarget[top]) {
+					remaining--;
+				}
+
+				for(NodeId arc = graph.arcBegin(top); arc != graph.arcEnd(top); arc++) {
+					NodeId child = graph.target(arc);
+					ArcType distC = cost + graph.weight(arc);
+
+					if(distC < context.cost(child)) {
+						context.setCost(child, distC, top);
+						if(pq.contains(child)) {
+							pq.decreaseKey(child, distC);
+						}
+						else {
+							pq.push(child, distC);
+						}
+					}
+				}
+			}
+
+			ArcType *row = table.row(i);
+			for(size_t j = 0; j != targetCount; j++) {
+				row[j] = context.cost(targets[j]);
+			}
+			settled[worker] += context.expanded();
+		}
+	});
+
+	Stats stats;
+	stats.sources = sourceCount;
+	stats.targets = targetCount;
+	stats.threads = m_pool.workerCount();
+	stats.settled = 0;
+	for(size_t w = 0; w != settled.size(); w++) {
+		stats.settled += settled[w];
+	}
+	stats.bucketEntries = 0;
+	stats.seconds = secondsSince(start);
+	return stats;
+}
+
+// ----------------------------------------------------------------
+//  Name:           compute
+//  Description:    Fills a table with the bucket method on a
+//                  contraction hierarchy: the target searches run in
+//                  parallel, their visits are grouped into buckets
+//                  by node with a counting sort, and then the source
+//                  searches run in parallel, each writing only its
+//                  own row.
+//  Arguments:      As for the CSRGraph version, with the hierarchy
+//                  built from the graph instead.
+//  Return Value:   What the computation took.
+// ----------------------------------------------------------------
+template<class ArcType>
+typename DistanceTable<ArcType>::Stats DistanceTable<ArcType>::compute( ContractionHierarchy<ArcType> const &hierarchy, NodeId const *sources, size_t sourceCount,
+                                                                      NodeId const *targets, size_t targetCount, Matrix &table ) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	table.assign(sourceCount, targetCount, SearchContext<ArcType>::infinity());
+
+	std::vector<std::vector<Visit> > visits(targetCount);
+	std::vector<size_t> settled(m_pool.workerCount(), 0);
+	std::vector<SearchContext<ArcType> > &contexts = m_contexts;
+
+	m_pool.parallelFor(targetCount, 4, [&](int worker, size_t begin, size_t end) {
+		for(size_t j = begin; j != end; j++) {
+			CollectVisits collect = { &visits[j] };
+			hierarchy.upward(contexts[worker], targets[j], false, collect);
+			settled[worker] += contexts[worker].expanded();
+		}
+	});
+
+	// group the visits by node, keeping them in column order.
+	NodeId nodeCount = hierarchy.nodeCount();
+	m_bucketOffsets.assign(nodeCount + 1, 0);
+	for(size_t j = 0; j != targetCount; j++) {
+		for(size_t v = 0; v != visits[j].size(); v++) {
+			m_bucketOffsets[visits[j][v].node + 1]++;
+		}
+	}
+	for(NodeId node = 0; node != nodeCount; node++) {
+		m_bucketOffsets[node + 1] += m_bucketOffsets[node];
+	}
+	m_buckets.resize(m_bucketOffsets[nodeCount]);
+	std::vector<NodeId> next(m_bucketOffsets.begin(), m_bucketOffsets.end() - 1);
+	for(size_t j = 0; j != targetCount; j++) {
+		for(size_t v = 0; v != visits[j].size(); v++) {
+			BucketEntry &entry = m_buckets[next[visits[j][v].node]++];
+			entry.column = static_cast<NodeId>(j);
+			entry.cost = visits[j][v].cost;
+		}
+		std::vector<Visit>().swap(visits[j]);
+	}
+
+	NodeId const *offsets = &m_bucketOffsets[0];
+	BucketEntry const *buckets = m_buckets.empty() ? 0 : &m_buckets[0];
+
+	m_pool.parallelFor(sourceCount, 4, [&](int worker, size_t begin, size_t end) {
+		for(size_t i = begin; i != end; i++) {
+			ScanBuckets scan = { offsets, buckets, table.row(i) };
+			hierarchy.upward(contexts[worker], sources[i], true, scan);
+			settled[worker] += contexts[worker].expanded();
+		}
+	});
+
+	Stats stats;
+	stats.sources = sourceCount;
+	stats.targets = targetCount;
+	stats.threads = m_pool.workerCount();
+	stats.settled = 0;
+	for(size_t w = 0; w != settled.size(); w++) {
+		stats.settled += settled[w];
+	}
+	stats.bucketEntries = m_buckets.size();
+	stats.seconds = secondsSince(start);
+	return stats;
+}
+
+#endif
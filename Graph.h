@@ -3,8 +3,21 @@
 
 #include <list>
 #include <queue>
+#include <vector>
+#include <string>
+#include <limits>
+#include <climits>
+#include <cmath>
+#include <algorithm>
 #include <utility> // for STL pair
 
+#include "IndexedPriorityQueue.h"
+#include "CSRGraph.h"
+#include "SearchContext.h"
+#include "SearchStats.h"
+#include "GraphObserver.h"
+#include "GraphArena.h"
+
 
 using namespace std;
 
@@ -12,30 +25,12 @@ template <class NodeType, class ArcType> class GraphArc;
 template <class NodeType, class ArcType> class GraphNode;
 
 
-template<class NodeType, class ArcType>
-class NodeSearchCostComparer {
-
-public:
-	bool operator()(GraphNode<NodeType, ArcType> * n1, GraphNode<NodeType, ArcType> * n2) {
-		return n1->data().second > n2->data().second;
-	}
-};
-
-template<class NodeType, class ArcType>
-class NodeHeuristicCostComparer {
-
-public:
-	bool operator()(GraphNode<NodeType, ArcType> * n1, GraphNode<NodeType, ArcType> * n2) {
-		cout << "cmp | " << n1->data().first << "["<<n1->F_Value<<"]" << " vs " << n2->data().first << "["<<n1->F_Value<<"]" << endl;
-		return n1->F_Value < n2->F_Value;
-	}
-};
-
-
 // ----------------------------------------------------------------
 //  Name:           Graph
 //  Description:    This is the graph class, it contains all the
-//                  nodes.
+//                  nodes. It holds only topology, weights and
+//                  node positions, so it can be used without any
+//                  rendering library; drawing lives in GraphView.
 // ----------------------------------------------------------------
 template<class NodeType, class ArcType>
 class Graph {
@@ -46,25 +41,111 @@ private:
     typedef GraphNode<NodeType, ArcType> Node;
 
 // ----------------------------------------------------------------
-//  Description:    An array of all the nodes in the graph.
+//  Description:    Where the nodes and their arc list cells are
+//                  allocated, so building the graph takes a few
+//                  large blocks and destroying it frees them at
+//                  once. m_pNodePool is the arena's pool for nodes.
+// ----------------------------------------------------------------
+    GraphArena m_arena;
+    ObjectPool* m_pNodePool;
+
+// ----------------------------------------------------------------
+//  Description:    An array of all the nodes in the graph, with
+//                  room for m_capacity; it grows (doubling) as
+//                  nodes are added past its end.
 // ----------------------------------------------------------------
     Node** m_pNodes;
+    int m_capacity;
 
 // ----------------------------------------------------------------
-//  Description:    The maximum number of nodes in the graph.
+//  Description:    The number of node slots: one past the highest
+//                  index ever used, or the size the graph was made
+//                  with if that is more. Empty slots hold 0.
 // ----------------------------------------------------------------
     int m_maxNodes;
 
+// ----------------------------------------------------------------
+//  Description:    The generation of each slot, bumped when its
+//                  node is removed, so that a NodeHandle to the
+//                  old node no longer matches once the slot is
+//                  reused.
+// ----------------------------------------------------------------
+    vector<unsigned int> m_generations;
+
+// ----------------------------------------------------------------
+//  Description:    Empty slots, taken by addNode(data) before
+//                  the graph grows, last in first out, so that
+//                  removing and adding nodes keeps them packed. An entry
+//                  may have been filled since by addNode(data,
+//                  index); those are skipped when popped.
+// ----------------------------------------------------------------
+    vector<int> m_freeSlots;
+
+// ----------------------------------------------------------------
+//  Description:    The index of every node in the graph, in no
+//                  particular order, so loops over the nodes never
+//                  visit empty slots; m_livePosition[i] is where
+//                  slot i is in m_live (-1 if it is empty), so a
+//                  node is taken out in O(1).
+// ----------------------------------------------------------------
+    vector<int> m_live;
+    vector<int> m_livePosition;
+
 
 // ----------------------------------------------------------------
 //  Description:    The actual number of nodes in the graph.
 // ----------------------------------------------------------------
     int m_count;
 
+// ----------------------------------------------------------------
+//  Description:    Told about every change to the graph.
+// ----------------------------------------------------------------
+    vector<GraphObserver<ArcType>*> m_observers;
+
+    void depthFirstVisit( SearchContext<ArcType>& context, Node* pNode, void (*pProcess)(Node*) ) const;
+    void grow( int slots );
+
+    // the node at an index, or 0 if the slot is empty or out of range.
+    Node* slot( int index ) const {
+        return index >= 0 && index < m_maxNodes ? m_pNodes[index] : 0;
+    }
+
 
 public:           
+    // The per-query search state the searches work in.
+    typedef SearchContext<ArcType> Context;
+
+// ----------------------------------------------------------------
+//  Description:    Names a node for as long as it is in the graph.
+//                  A Node* or index kept after the node is removed
+//                  would name whatever is put in its slot next; a
+//                  handle to it just stops matching (getNode()
+//                  returns 0).
+// ----------------------------------------------------------------
+    struct NodeHandle {
+        int index;
+        unsigned int generation;
+    };
+
+// ----------------------------------------------------------------
+//  Description:    The default heuristic for aStar, heuristic_eval
+//                  on node indices. Any functor taking two node
+//                  indices and returning an admissible estimate
+//                  can be passed instead, e.g. Landmarks.
+// ----------------------------------------------------------------
+    struct Euclidean {
+        Graph const & graph;
+
+        explicit Euclidean( Graph const & g ) : graph( g ) {
+        }
+
+        ArcType operator()( int node, int dest ) const {
+            return graph.heuristic_eval(graph.m_pNodes[node], graph.m_pNodes[dest]);
+        }
+    };
+
     // Constructor and destructor functions
-    Graph( int size );
+    Graph( int size = 0, bool pooled = true );
     ~Graph();
 
     // Accessors
@@ -72,43 +153,133 @@ public:
        return m_pNodes;
     }
 
+    int getMaxNodes() const {
+       return m_maxNodes;
+    }
+
+    // the indices of the nodes in the graph, in no particular order.
+    vector<int> const & liveNodes() const {
+       return m_live;
+    }
+
+    // What the node and arc allocations have cost so far.
+    PoolStats allocatorStats() const {
+       return m_arena.stats();
+    }
+
+    void addObserver( GraphObserver<ArcType>* pObserver ) {
+       m_observers.push_back(pObserver);
+    }
+
+    void removeObserver( GraphObserver<ArcType>* pObserver ) {
+       m_observers.erase(std::remove(m_observers.begin(), m_observers.end(), pObserver), m_observers.end());
+    }
+
     // Public member functions.
-	bool addNode( NodeType data, int index, sf::Font const &font );
+	bool addNode( NodeType data, int index );
+    NodeHandle addNode( NodeType data );
+    // a handle to the node at an index, or one that names no node
+    // (index -1) if the slot is empty or out of range.
+    NodeHandle handle( int index ) const {
+       NodeHandle h = { -1, 0 };
+       if( slot(index) != 0 ) {
+           h.index = index;
+           h.generation = m_generations[index];
+       }
+       return h;
+    }
+    Node* getNode( NodeHandle h ) const {
+       return h.index >= 0 && h.index < m_maxNodes && m_generations[h.index] == h.generation ? m_pNodes[h.index] : 0;
+    }
     void removeNode( int index );
     bool addArc( int from, int to, ArcType weight );
-	bool addDualArc( int from, int to, ArcType weight, int startX, int startY, int endX, int endY, sf::Font const &font );
+	bool addDualArc( int from, int to, ArcType weight, int startX, int startY, int endX, int endY );
     void removeArc( int from, int to );
+    bool setArcWeight( int from, int to, ArcType weight );
+    bool setNodePosition( int index, float x, float y );
     Arc* getArc( int from, int to );        
-    void clearMarks();
-    void depthFirst( Node* pNode, void (*pProcess)(Node*) );
-    void breadthFirst( Node* pNode, void (*pProcess)(Node*) );
-	void breadthFirstSearch( Node* pNode, void (*pProcess)(Node*), Node* nodeToFind);
-	void ucs( Node* pStart, Node* pDest, void (*pVisitFunc)(Node*),std::vector<Node *>& path );
-	void aStar( Node* pStart, Node* pDest, void (*pProcess)(Node*), std::vector<Node *>& path );
-	ArcType heuristic_eval( Node* A, Node* B, float grainOfSalt = 0.9f);
-	int getTotalNodes();
-	void resetMarked();
+    void depthFirst( Context& context, Node* pNode, void (*pProcess)(Node*) ) const;
+    void breadthFirst( Context& context, Node* pNode, void (*pProcess)(Node*) ) const;
+	void breadthFirstSearch( Context& context, Node* pNode, void (*pProcess)(Node*), Node* nodeToFind) const {
+		NoInstrumentation none;
+		breadthFirstSearch(context, pNode, pProcess, nodeToFind, none);
+	}
+	template<class Instrumentation>
+	void breadthFirstSearch( Context& context, Node* pNode, void (*pProcess)(Node*), Node* nodeToFind, Instrumentation& instrumentation ) const;
+	void ucs( Context& context, Node* pStart, Node* pDest, void (*pVisitFunc)(Node*),std::vector<Node *>& path ) const {
+		NoInstrumentation none;
+		ucs(context, pStart, pDest, pVisitFunc, path, none);
+	}
+	template<class Instrumentation>
+	void ucs( Context& context, Node* pStart, Node* pDest, void (*pVisitFunc)(Node*),std::vector<Node *>& path, Instrumentation& instrumentation ) const;
+	void aStar( Context& context, Node* pStart, Node* pDest, void (*pProcess)(Node*), std::vector<Node *>& path ) const {
+		aStar(context, pStart, pDest, pProcess, path, Euclidean(*this));
+	}
+	template<class Heuristic>
+	void aStar( Context& context, Node* pStart, Node* pDest, void (*pProcess)(Node*), std::vector<Node *>& path, Heuristic const & heuristic ) const {
+		NoInstrumentation none;
+		aStar(context, pStart, pDest, pProcess, path, heuristic, none);
+	}
+	template<class Heuristic, class Instrumentation>
+	void aStar( Context& context, Node* pStart, Node* pDest, void (*pProcess)(Node*), std::vector<Node *>& path, Heuristic const & heuristic, Instrumentation& instrumentation ) const;
+	ArcType heuristic_eval( Node* A, Node* B, float grainOfSalt = 0.9f) const;
+	int getTotalNodes() const;
+	CSRGraph<ArcType> freeze() const;
 };
 
 // ----------------------------------------------------------------
 //  Name:           Graph
 //  Description:    Constructor, this constructs an empty graph
-//  Arguments:      The maximum number of nodes.
+//  Arguments:      The number of node slots to start with (the
+//                  graph grows past it as needed), and whether
+//                  nodes and arcs are taken from pools (the
+//                  default) or allocated one by one, e.g. for
+//                  comparison.
 //  Return Value:   None.
 // ----------------------------------------------------------------
 template<class NodeType, class ArcType>
-Graph<NodeType, ArcType>::Graph( int size ) : m_maxNodes( size ) {
-   int i;
-   m_pNodes = new Node * [m_maxNodes];
-   // go through every index and clear it to null (0)
-   for( i = 0; i < m_maxNodes; i++ ) {
-        m_pNodes[i] = 0;
-   }
+Graph<NodeType, ArcType>::Graph( int size, bool pooled ) : m_arena( pooled ), m_pNodes( 0 ), m_capacity( 0 ), m_maxNodes( 0 ) {
+   m_pNodePool = &m_arena.pool( sizeof(Node) );
+   grow( size > 0 ? size : 0 );
 
    // set the node count to 0.
    m_count = 0;
 }
 
+// ----------------------------------------------------------------
+//  Name:           grow
+//  Description:    Makes sure there are at least a number of node
+//                  slots, reallocating the array (to at least twice
+//                  its size) if they do not fit. The new slots are
+//                  empty and go on the free list, lowest first.
+//  Arguments:      The number of slots needed.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void Graph<NodeType, ArcType>::grow( int slots ) {
+   if( slots <= m_maxNodes ) {
+       return;
+   }
+
+   if( slots > m_capacity ) {
+       int capacity = std::max( slots, 2 * m_capacity );
+       Node** pNodes = new Node * [capacity];
+       std::copy( m_pNodes, m_pNodes + m_maxNodes, pNodes );
+       delete [] m_pNodes;
+       m_pNodes = pNodes;
+       m_capacity = capacity;
+   }
+
+   // go through every new index and clear it to null (0)
+   for( int i = slots - 1; i >= m_maxNodes; i-- ) {
+       m_pNodes[i] = 0;
+       m_freeSlots.push_back(i);
+   }
+   m_generations.resize( slots, 0 );
+   m_livePosition.resize( slots, -1 );
+   m_maxNodes = slots;
+}
+
 // ----------------------------------------------------------------
 //  Name:           ~Graph
 //  Description:    destructor, This deletes every node
@@ -118,40 +289,88 @@ Graph<NodeType, ArcType>::Graph( int size ) : m_maxNodes( size ) {
 template<class NodeType, class ArcType>
 Graph<NodeType, ArcType>::~Graph() {
    int index;
-   for( index = 0; index < m_maxNodes; index++ ) {
-        if( m_pNodes[index] != 0 ) {
-            delete m_pNodes[index];
-        }
+   // the nodes' destructors give their arc cells back to the arena,
+   // and each node goes back to its pool (which frees it at once if
+   // the graph is not pooled); the arena's blocks are then freed
+   // with it.
+   for( size_t i = 0; i != m_live.size(); i++ ) {
+        index = m_live[i];
+        m_pNodes[index]->~Node();
+        m_pNodePool->release( m_pNodes[index] );
    }
    // Delete the actual array
-   delete m_pNodes;
+   delete [] m_pNodes;
 }
 
 // ----------------------------------------------------------------
 //  Name:           addNode
-//  Description:    This adds a node at a given index in the graph.
+//  Description:    This adds a node at a given index in the graph,
+//                  growing the graph if the index is past its end.
 //  Arguments:      The first parameter is the data to store in the node.
 //                  The second parameter is the index to store the node.
-//  Return Value:   true if successful
+//  Return Value:   true if successful, false if the index is
+//                  negative or taken.
 // ----------------------------------------------------------------
 template<class NodeType, class ArcType>
-bool Graph<NodeType, ArcType>::addNode( NodeType data, int index, sf::Font const &font ) {
+bool Graph<NodeType, ArcType>::addNode( NodeType data, int index ) {
    bool nodeNotPresent = false;
+   if( index < 0 ) {
+      return false;
+   }
+   grow( index + 1 );
+
    // find out if a node does not exist at that index.
    if ( m_pNodes[index] == 0) {
       nodeNotPresent = true;
       // create a new node, put the data in it, and unmark it.
-      m_pNodes[index] = new Node(font);
+      m_pNodes[index] = new (m_pNodePool->allocate()) Node( &m_arena );
       m_pNodes[index]->setData(data);
-      m_pNodes[index]->setMarked(false);
+      m_pNodes[index]->setIndex(index);
 
       // increase the count and return success.
       m_count++;
+      m_livePosition[index] = static_cast<int>(m_live.size());
+      m_live.push_back(index);
+      if( !m_freeSlots.empty() && m_freeSlots.back() == index ) {
+          m_freeSlots.pop_back();
+      }
+      for( size_t i = 0; i != m_observers.size(); i++ ) {
+          m_observers[i]->nodeAdded(index);
+      }
     }
         
     return nodeNotPresent;
 }
 
+// ----------------------------------------------------------------
+//  Name:           addNode
+//  Description:    Adds a node in a free slot, growing the graph if
+//                  there is none. The free list is a stack, last in
+//                  first out: the slot removeNode freed most
+//                  recently is taken first. The empty slots the
+//                  graph is made or grown with are pushed highest
+//                  index first, so among those the lowest is taken
+//                  first.
+//  Arguments:      The data to store in the node.
+//  Return Value:   A handle to the new node; its index is
+//                  handle.index.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+typename Graph<NodeType, ArcType>::NodeHandle Graph<NodeType, ArcType>::addNode( NodeType data ) {
+   // skip slots filled through addNode(data, index) since they were freed.
+   while( !m_freeSlots.empty() && m_pNodes[m_freeSlots.back()] != 0 ) {
+       m_freeSlots.pop_back();
+   }
+
+   int index = m_maxNodes;
+   if( !m_freeSlots.empty() ) {
+       index = m_freeSlots.back();
+       m_freeSlots.pop_back();
+   }
+   addNode( data, index );
+   return handle( index );
+}
+
 // ----------------------------------------------------------------
 //  Name:           removeNode
 //  Description:    This removes a node from the graph
@@ -161,32 +380,34 @@ bool Graph<NodeType, ArcType>::addNode( NodeType data, int index, sf::Font const
 template<class NodeType, class ArcType>
 void Graph<NodeType, ArcType>::removeNode( int index ) {
      // Only proceed if node does exist.
-     if( m_pNodes[index] != 0 ) {
-         // now find every arc that points to the node that
-         // is being removed and remove it.
-         int node;
-         Arc* arc;
-
-         // loop through every node
-         for( node = 0; node < m_maxNodes; node++ ) {
-              // if the node is valid...
-              if( m_pNodes[node] != 0 ) {
-                  // see if the node has an arc pointing to the current node.
-                  arc = m_pNodes[node]->getArc( m_pNodes[index] );
-              }
-              // if it has an arc pointing to the current node, then
-              // remove the arc.
-              if( arc != 0 ) {
-                  removeArc( node, index );
-              }
+     if( slot(index) != 0 ) {
+         for( size_t i = 0; i != m_observers.size(); i++ ) {
+             m_observers[i]->nodeRemoved(index);
          }
-        
+
+         // remove every arc that points to the node that is being
+         // removed (found through its incoming list, so this costs
+         // O(degree) rather than a scan of every node), and every
+         // arc that leaves it.
+         m_pNodes[index]->removeAllArcs();
 
         // now that every arc pointing to the current node has been removed,
         // the node can be deleted.
-        delete m_pNodes[index];
+        m_pNodes[index]->~Node();
+        m_pNodePool->release( m_pNodes[index] );
         m_pNodes[index] = 0;
         m_count--;
+
+        // the last live node takes the removed one's place.
+        int last = m_live.back();
+        m_live[m_livePosition[index]] = last;
+        m_livePosition[last] = m_livePosition[index];
+        m_live.pop_back();
+        m_livePosition[index] = -1;
+
+        // handles to the node stop matching, and the slot is reused first.
+        m_generations[index]++;
+        m_freeSlots.push_back(index);
     }
 }
 
@@ -203,42 +424,52 @@ template<class NodeType, class ArcType>
 bool Graph<NodeType, ArcType>::addArc( int from, int to, ArcType weight ) {
      bool proceed = true; 
      // make sure both nodes exist.
-     if( m_pNodes[from] == 0 || m_pNodes[to] == 0 ) {
+     if( slot(from) == 0 || slot(to) == 0 ) {
          proceed = false;
      }
-        
      // if an arc already exists we should not proceed
-     if( m_pNodes[from]->getArc( m_pNodes[to] ) != 0 ) {
+     else if( m_pNodes[from]->getArc( m_pNodes[to] ) != 0 ) {
          proceed = false;
      }
 
      if (proceed == true) {
         // add the arc to the "from" node.
         m_pNodes[from]->addArc( m_pNodes[to], weight );
+        for( size_t i = 0; i != m_observers.size(); i++ ) {
+            m_observers[i]->arcAdded(from, to, weight);
+        }
      }
         
      return proceed;
 }
 
 template<class NodeType, class ArcType>
-bool Graph<NodeType, ArcType>::addDualArc( int from, int to, ArcType weight, int startX, int startY, int endX, int endY, sf::Font const &font ) {
+bool Graph<NodeType, ArcType>::addDualArc( int from, int to, ArcType weight, int startX, int startY, int endX, int endY ) {
      bool proceed = true; 
      // make sure both nodes exist.
-     if( m_pNodes[from] == 0 || m_pNodes[to] == 0 ) {
+     if( slot(from) == 0 || slot(to) == 0 ) {
          proceed = false;
      }
-        
      // if an arc already exists we should not proceed
-     if( m_pNodes[from]->getArc( m_pNodes[to] ) != 0 ) {
+     else if( m_pNodes[from]->getArc( m_pNodes[to] ) != 0 ) {
          proceed = false;
      }
 
      if (proceed == true) {
         // add the arc to the "from" node.
-        m_pNodes[from]->addArc( m_pNodes[to], weight, startX, startY, endX, endY, font);
-		m_pNodes[to]->addArc( m_pNodes[from], weight, startX, startY, endX, endY, font);
-		m_pNodes[from]->setPosition(startX, startY);
-		m_pNodes[to]->setPosition(endX, endY);
+        m_pNodes[from]->addArc( m_pNodes[to], weight );
+		bool reverse = m_pNodes[to]->getArc( m_pNodes[from] ) == 0;
+		if( reverse ) {
+			m_pNodes[to]->addArc( m_pNodes[from], weight );
+		}
+		setNodePosition(from, static_cast<float>(startX), static_cast<float>(startY));
+		setNodePosition(to, static_cast<float>(endX), static_cast<float>(endY));
+		for( size_t i = 0; i != m_observers.size(); i++ ) {
+			m_observers[i]->arcAdded(from, to, weight);
+			if( reverse ) {
+				m_observers[i]->arcAdded(to, from, weight);
+			}
+		}
      }
         
      return proceed;
@@ -256,14 +487,66 @@ void Graph<NodeType, ArcType>::removeArc( int from, int to ) {
      // Make sure that the node exists before trying to remove
      // an arc from it.
      bool nodeExists = true;
-     if( m_pNodes[from] == 0 || m_pNodes[to] == 0 ) {
+     if( slot(from) == 0 || slot(to) == 0 ) {
          nodeExists = false;
      }
 
-     if (nodeExists == true) {
+     if (nodeExists == true && m_pNodes[from]->getArc( m_pNodes[to] ) != 0) {
         // remove the arc.
         m_pNodes[from]->removeArc( m_pNodes[to] );
+        for( size_t i = 0; i != m_observers.size(); i++ ) {
+            m_observers[i]->arcRemoved(from, to);
+        }
+     }
+}
+
+// ----------------------------------------------------------------
+//  Name:           setArcWeight
+//  Description:    Changes the weight of the arc from the first
+//                  index to the second, and tells the observers.
+//  Arguments:      The originating node index, the ending node
+//                  index and the new weight.
+//  Return Value:   true if the arc exists.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool Graph<NodeType, ArcType>::setArcWeight( int from, int to, ArcType weight ) {
+     Arc* pArc = getArc( from, to );
+     if( pArc == 0 ) {
+         return false;
+     }
+
+     ArcType oldWeight = pArc->weight();
+     pArc->setWeight( weight );
+     for( size_t i = 0; i != m_observers.size(); i++ ) {
+         m_observers[i]->arcWeightChanged(from, to, oldWeight, weight);
+     }
+     return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           setNodePosition
+//  Description:    Moves a node, and tells the observers if it
+//                  actually moved.
+//  Arguments:      The node's index and its new position.
+//  Return Value:   true if the node exists.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool Graph<NodeType, ArcType>::setNodePosition( int index, float x, float y ) {
+     Node* pNode = slot( index );
+     if( pNode == 0 ) {
+         return false;
+     }
+
+     float oldX = pNode->x(), oldY = pNode->y();
+     if( oldX == x && oldY == y ) {
+         return true;
+     }
+
+     pNode->setPosition( x, y );
+     for( size_t i = 0; i != m_observers.size(); i++ ) {
+         m_observers[i]->nodeMoved(index, oldX, oldY);
      }
+     return true;
 }
 
 
@@ -280,7 +563,7 @@ template<class NodeType, class ArcType>
 GraphArc<NodeType, ArcType>* Graph<NodeType, ArcType>::getArc( int from, int to ) {
      Arc* pArc = 0;
      // make sure the to and from nodes exist
-     if( m_pNodes[from] != 0 && m_pNodes[to] != 0 ) {
+     if( slot(from) != 0 && slot(to) != 0 ) {
          pArc = m_pNodes[from]->getArc( m_pNodes[to] );
      }
                 
@@ -288,47 +571,37 @@ GraphArc<NodeType, ArcType>* Graph<NodeType, ArcType>::getArc( int from, int to
 }
 
 
-// ----------------------------------------------------------------
-//  Name:           clearMarks
-//  Description:    This clears every mark on every node.
-//  Arguments:      None.
-//  Return Value:   None.
-// ----------------------------------------------------------------
-template<class NodeType, class ArcType>
-void Graph<NodeType, ArcType>::clearMarks() {
-     int index;
-     for( index = 0; index < m_maxNodes; index++ ) {
-          if( m_pNodes[index] != 0 ) {
-              m_pNodes[index]->setMarked(false);
-			  m_pNodes[index]->setColor(0,0,255);
-          }
-     }
-}
-
-
 // ----------------------------------------------------------------
 //  Name:           depthFirst
 //  Description:    Performs a depth-first traversal on the specified 
 //                  node.
-//  Arguments:      The first argument is the starting node
-//                  The second argument is the processing function.
+//  Arguments:      The first argument is the search context to mark
+//                  nodes in (it is reset first).
+//                  The second argument is the starting node
+//                  The third argument is the processing function.
 //  Return Value:   None.
 // ----------------------------------------------------------------
 template<class NodeType, class ArcType>
-void Graph<NodeType, ArcType>::depthFirst( Node* pNode, void (*pProcess)(Node*) ) {
+void Graph<NodeType, ArcType>::depthFirst( Context& context, Node* pNode, void (*pProcess)(Node*) ) const {
+     context.reset(m_maxNodes);
+     depthFirstVisit(context, pNode, pProcess);
+}
+
+template<class NodeType, class ArcType>
+void Graph<NodeType, ArcType>::depthFirstVisit( Context& context, Node* pNode, void (*pProcess)(Node*) ) const {
      if( pNode != 0 ) {
            // process the current node and mark it
            pProcess( pNode );
-           pNode->setMarked(true);
+           context.setMarked(pNode->index());
 
            // go through each connecting node
-           list<Arc>::iterator iter = pNode->arcList().begin();
-           list<Arc>::iterator endIter = pNode->arcList().end();
+           typename Node::ArcList::const_iterator iter = pNode->arcList().begin();
+           typename Node::ArcList::const_iterator endIter = pNode->arcList().end();
         
 		   for( ; iter != endIter; ++iter) {
 			    // process the linked node if it isn't already marked.
-                if ( (*iter).node()->marked() == false ) {
-                   depthFirst( (*iter).node(), pProcess);
+                if ( context.marked((*iter).node()->index()) == false ) {
+                   depthFirstVisit( context, (*iter).node(), pProcess);
                 }            
            }
      }
@@ -339,17 +612,21 @@ void Graph<NodeType, ArcType>::depthFirst( Node* pNode, void (*pProcess)(Node*)
 //  Name:           breadthFirst
 //  Description:    Performs a depth-first traversal the starting node
 //                  specified as an input parameter.
-//  Arguments:      The first parameter is the starting node
-//                  The second parameter is the processing function.
+//  Arguments:      The first parameter is the search context to mark
+//                  nodes in (it is reset first).
+//                  The second parameter is the starting node
+//                  The third parameter is the processing function.
 //  Return Value:   None.
 // ----------------------------------------------------------------
 template<class NodeType, class ArcType>
-void Graph<NodeType, ArcType>::breadthFirst( Node* pNode, void (*pProcess)(Node*) ) {
+void Graph<NodeType, ArcType>::breadthFirst( Context& context, Node* pNode, void (*pProcess)(Node*) ) const {
+   context.reset(m_maxNodes);
+
    if( pNode != 0 ) {
 	  queue<Node*> nodeQueue;        
 	  // place the first node on the queue, and mark it.
       nodeQueue.push( pNode );
-      pNode->setMarked(true);
+      context.setMarked(pNode->index());
 
       // loop through the queue while there are nodes in it.
       while( nodeQueue.size() != 0 ) {
@@ -358,13 +635,13 @@ void Graph<NodeType, ArcType>::breadthFirst( Node* pNode, void (*pProcess)(Node*
 
          // add all of the child nodes that have not been 
          // marked into the queue
-         list<Arc>::const_iterator iter = nodeQueue.front()->arcList().begin();
-         list<Arc>::const_iterator endIter = nodeQueue.front()->arcList().end();
+         typename Node::ArcList::const_iterator iter = nodeQueue.front()->arcList().begin();
+         typename Node::ArcList::const_iterator endIter = nodeQueue.front()->arcList().end();
          
 		 for( ; iter != endIter; iter++ ) {
-              if ( (*iter).node()->marked() == false) {
+              if ( context.marked((*iter).node()->index()) == false) {
 				 // mark the node and add it to the queue.
-                 (*iter).node()->setMarked(true);
+                 context.setMarked((*iter).node()->index());
                  nodeQueue.push( (*iter).node() );
               }
          }
@@ -375,234 +652,317 @@ void Graph<NodeType, ArcType>::breadthFirst( Node* pNode, void (*pProcess)(Node*
    }  
 }
 
+// ----------------------------------------------------------------
+//  Name:           breadthFirstSearch
+//  Description:    A breadth-first traversal that stops once
+//                  nodeToFind is reached. Follow context.previous()
+//                  back from nodeToFind to get the path.
+//  Arguments:      The search context (it is reset first), the
+//                  starting node, the processing function, the
+//                  node to look for and, optionally, an
+//                  instrumentation policy (see SearchStats.h).
+//  Return Value:   None.
+// ----------------------------------------------------------------
 template<class NodeType, class ArcType>
-void Graph<NodeType, ArcType>::breadthFirstSearch( Node* pNode, void (*pProcess)(Node*) , Node* nodeToFind){
+template<class Instrumentation>
+void Graph<NodeType, ArcType>::breadthFirstSearch( Context& context, Node* pNode, void (*pProcess)(Node*) , Node* nodeToFind, Instrumentation& instrumentation) const {
 	bool goalReached = false;
+	context.reset(m_maxNodes);
+	instrumentation.begin();
+
 	if( pNode != 0 ) {
 	  queue<Node*> nodeQueue;        
 	  // place the first node on the queue, and mark it.
       nodeQueue.push( pNode );
+      instrumentation.pushed(nodeQueue.size());
 
-      pNode->setMarked(true);
+      context.setMarked(pNode->index());
+      context.setCost(pNode->index(), 0, -1);
 
       // loop through the queue while there are nodes in it.
       while((nodeQueue.size() != 0) && (goalReached == false)) {
          // process the node at the front of the queue.
-         pProcess( nodeQueue.front() );
+         Node* front = nodeQueue.front();
+         pProcess( front );
+         instrumentation.expanded();
 
          // add all of the child nodes that have not been 
          // marked into the queue
-         list<Arc>::const_iterator iter = nodeQueue.front()->arcList().begin();
-         list<Arc>::const_iterator endIter = nodeQueue.front()->arcList().end();
+         typename Node::ArcList::const_iterator iter = front->arcList().begin();
+         typename Node::ArcList::const_iterator endIter = front->arcList().end();
          
 		 for( ; (iter != endIter) && (goalReached == false); iter++ ) {
-			  if((*iter).node() == nodeToFind){
-				  cout << "found"<<endl;
-				  goalReached = true;
-				  (*iter).node()->setPreviousPointer(nodeQueue.front());
-			  }
-              if ( (*iter).node()->marked() == false) {
-				  (*iter).node()->setPreviousPointer(nodeQueue.front());
-				 // mark the node and add it to the queue.
-                 (*iter).node()->setMarked(true);
+			  int child = (*iter).node()->index();
+			  instrumentation.relaxed();
+
+              if ( context.marked(child) == false) {
+				 // record the way back, mark the node and add it to the queue.
+				 context.setCost(child, context.cost(front->index()) + 1, front->index());
+                 context.setMarked(child);
                  nodeQueue.push( (*iter).node() );
+                 instrumentation.pushed(nodeQueue.size());
               }
 
+			  if((*iter).node() == nodeToFind){
+				  goalReached = true;
+			  }
          }
 
          // dequeue the current node.
          nodeQueue.pop();
+         instrumentation.popped();
       }
+   }
 
-
-
-   }  
-
+   instrumentation.end("Graph::breadthFirstSearch");
 }
 
+// ----------------------------------------------------------------
+//  Name:           ucs
+//  Description:    Uniform cost search (Dijkstra) from pStart to
+//                  pDest. The open set is an indexed heap keyed on
+//                  d[v], so when a cheaper route to a queued node
+//                  is found its entry is moved up in place.
+//  Arguments:      The search context (it is reset first), the start
+//                  node, the destination node, a function called on
+//                  every expanded node, the vector to write the
+//                  path into (destination first) and, optionally,
+//                  an instrumentation policy (see SearchStats.h).
+//  Return Value:   None. The path is left empty if pDest cannot be
+//                  reached.
+// ----------------------------------------------------------------
 template<class NodeType, class ArcType>
-void Graph<NodeType, ArcType>::ucs( Node* pStart, Node* pDest, void (*pVisitFunc)(Node*),std::vector<Node *>& path ){
-	cout << "\Commencing UCS..." << endl;
-
-	//Let pq = a new priority queue
-	priority_queue<Node*, vector<Node*>, NodeSearchCostComparer<NodeType, ArcType>> pq;
+template<class Instrumentation>
+void Graph<NodeType, ArcType>::ucs( Context& context, Node* pStart, Node* pDest, void (*pVisitFunc)(Node*),std::vector<Node *>& path, Instrumentation& instrumentation ) const {
+	instrumentation.begin();
 
-	//For each node v in graph G
-	for(int i = 0; (i != m_maxNodes) ; i++ ){
+	//Initialise d[v] to infinity for every node v in graph G
+	//(a fresh generation of the context reads as infinity everywhere)
+	context.reset(m_maxNodes);
 
-	//	Initialise d[v] to infinity // don’t yet know the distances to these nodes
-		m_pNodes[i]->setData(pair<string, int>(m_pNodes[i]->data().first, INT_MAX));
-	}
+	//Let pq = a new indexed priority queue keyed on d[v]
+	IndexedPriorityQueue<ArcType>& pq = context.open();
 
 	//Initialise d[s] to 0
-	pStart->setData(pair<string, int>(pStart->data().first, 0));
+	context.setCost(pStart->index(), 0, -1);
 
 	//Add s to the pq
-	pq.push(pStart);
+	pq.push(pStart->index(), 0);
+	instrumentation.pushed(pq.size());
 
 	//Mark(s)
-	pq.top()->setMarked(true);
+	context.setMarked(pStart->index());
 
 	//While the queue is not empty AND pq.top() != g
-	while(!pq.empty() && (pq.top() != pDest)){
-	//	For each child node c of pq.top()
-		 list<Arc>::const_iterator itr = pq.top()->arcList().begin();
-         list<Arc>::const_iterator endItr = pq.top()->arcList().end();
+	while(!pq.empty() && pq.top() != pDest->index()) {
+		//Remove pq.top()
+		Node* top = m_pNodes[pq.top()];
+		pq.pop();
+		instrumentation.popped();
+		context.countExpansion();
+		instrumentation.expanded();
 
-		 pVisitFunc(pq.top());
+		if(pVisitFunc != 0) {
+			pVisitFunc(top);
+		}
 
-		 for( ; (itr != endItr) ; itr++ ) {
-			
+		//For each child node c of top
+		typename Node::ArcList::const_iterator itr = top->arcList().begin();
+		typename Node::ArcList::const_iterator endItr = top->arcList().end();
 
-			//If (c != previous(pq.top()) // don’t go back to a predecessor
-			if(itr->node() != pq.top()->getPrevious()){
+		for( ; itr != endItr; itr++) {
+			int child = itr->node()->index();
+			instrumentation.relaxed();
 
-				//Let distC = (pq.top(), c) + d[pq.top] 
-				ArcType distC = pq.top()->getArc(itr->node())->weight()  + pq.top()->data().second;
+			//Let distC = (top, c) + d[top]
+			ArcType distC = itr->weight() + context.cost(top->index());
 
-				//If ( distC < d[c] )
-				if(distC < itr->node()->data().second){
-					//let d[c] = distC
-					itr->node()->setData(pair<string, int>(itr->node()->data().first, distC));
-					//Set previous pointer of c to pq.top()
-					itr->node()->setPrevious(pq.top());
+			//If ( distC < d[c] )
+			if(distC < context.cost(child)) {
+				//let d[c] = distC and set previous pointer of c to top
+				context.setCost(child, distC, top->index());
+
+				//If c is already queued, move it up to its new place
+				if(pq.contains(child)) {
+					pq.decreaseKey(child, distC);
+					instrumentation.decreasedKey();
 				}
-				//If (notMarked(c))
-				if(itr->node()->marked() != true){
-					//Add c to the pq 
-					pq.push(itr->node());
+				else {
+					//Add c to the pq
+					pq.push(child, distC);
+					instrumentation.pushed(pq.size());
 					//Mark(c)
-					itr->node()->setMarked(true);
-					itr->node()->setColor(100,100,100);
+					context.setMarked(child);
 				}
 			}
 		}
-	//   Remove pq.top()
-		pq.pop();
 	}
 
 	//add to vector
-	while (pDest->getPrevious() != NULL)
-	{
-		path.push_back(pDest);
-		pDest = pDest->getPrevious();
+	if(context.reached(pDest->index())) {
+		for(int node = pDest->index(); node != -1; node = context.previous(node)) {
+			path.push_back(m_pNodes[node]);
+		}
 	}
-	path.push_back(pDest);
 
-	cout << "\nFinished UCS." << endl;
+	instrumentation.end("Graph::ucs");
 }
 
+// ----------------------------------------------------------------
+//  Name:           aStar
+//  Description:    A* search from pStart to pDest. Nodes are kept in
+//                  an indexed heap keyed on f(c) = g(c) + h(c), and
+//                  a node whose g value drops is moved up in place
+//                  (or queued again if it had already been expanded)
+//                  so each step costs O(log n).
+//  Arguments:      The search context (it is reset first), the start
+//                  node, the destination node, a function called on
+//                  every expanded node, the vector to write the
+//                  path into (destination first), the heuristic
+//                  (heuristic_eval if none is given) and, optionally,
+//                  an instrumentation policy (see SearchStats.h).
+//  Return Value:   None. The path is left empty if pDest cannot be
+//                  reached.
+// ----------------------------------------------------------------
 template<class NodeType, class ArcType>
-void Graph<NodeType, ArcType>::aStar( Node* pStart, Node* pDest, void (*pProcess)(Node*), std::vector<Node *>& path ){
-	cout << "\Commencing A*..." << endl;
-	//Let s = the starting node
-	//Let pq = a new priority queue
-	//priority_queue<Node*, vector<Node*>, NodeHeuristicCostComparer<NodeType, ArcType>> pq;
-	list<Node*> nodeList;
+template<class Heuristic, class Instrumentation>
+void Graph<NodeType, ArcType>::aStar( Context& context, Node* pStart, Node* pDest, void (*pProcess)(Node*), std::vector<Node *>& path, Heuristic const & heuristic, Instrumentation& instrumentation ) const {
+	instrumentation.begin();
 
-	//For each node v in graph G
-	for(int i = 0; i != m_maxNodes; i++) {
-		 m_pNodes[i]->F_Value =  INT_MAX / 2;
-	}
+	//For each node v in graph G, g(v) = f(v) = infinity
+	context.reset(m_maxNodes);
+
+	//Let s = the starting node
+	//Let pq = a new indexed priority queue keyed on f(c)
+	IndexedPriorityQueue<ArcType>& pq = context.open();
 
-	pStart->H_Value = INT_MAX / 2;
+	context.setCost(pStart->index(), 0, -1);
+	context.setEstimate(pStart->index(), heuristic(pStart->index(), pDest->index()));
 
 	//Add s to the pq
-	nodeList.push_front(pStart);
+	pq.push(pStart->index(), context.estimate(pStart->index()));
+	instrumentation.pushed(pq.size());
 
 	//Mark(s)
-	nodeList.front()->setMarked(true);
-	Node* pqTopAtStartOfWhileLoop = NULL;
-	
-	//While the queue is not empty AND pq.top() != g
-	while(nodeList.empty() != true && nodeList.front() != pDest) {
-		cout << "\n\tFrom " << nodeList.front()->data().first << ":" <<endl;
-		pqTopAtStartOfWhileLoop = nodeList.front();
-
-		//For each child node c of pq.top()
-		//auto end = pq.top()->arcList().end();
-		//for(auto itr = pq.top()->arclist().begin(); itr != end; itr++){
-		 list<Arc>::const_iterator iter = nodeList.front()->arcList().begin();
-         list<Arc>::const_iterator endIter = nodeList.front()->arcList().end();
-
-		 for( ; (iter != endIter) ; iter++ ) {
-			//If (c != previous(pq.top())
-			 Node* node = iter->node();
-
-			if(node != nodeList.front()->getPrevious()) {
-				//Let distC = h(c) + g(c) // g(c) is actual path cost to child
-				ArcType hC = heuristic_eval(node, pDest);
-				ArcType distC = hC + node->data().second;
-				
-				node->H_Value = hC;
-				node->setColor(100,100,100);
-
-				//If ( distC < g(c) )
-				 if(distC < node->F_Value){
-
-					//let f[c] = distC
-					 node->F_Value = distC;
-
-					//Set previous pointer of c to pq.top()
-					node->setPrevious(nodeList.front());
-					//make_heap(const_cast<Node**>(&pq.top()), const_cast<Node**>(&pq.top()) + pq.size(), NodeHeuristicCostComparer<NodeType, ArcType>());
-				 }//End if
-
-				//If (notMarked(c))
-				if(!node->marked()) {
-					pProcess(node);
-					//Add c to the pq
-					nodeList.push_back(node);
-					//Mark(c)
-					node->setMarked(true);
-				}//End if
-			}//End if
-		}//End for
+	context.setMarked(pStart->index());
 
+	//While the queue is not empty AND pq.top() != g
+	while(!pq.empty() && pq.top() != pDest->index()) {
 		//Remove pq.top()
-		 _ASSERT(nodeList.front() == pqTopAtStartOfWhileLoop);
-		nodeList.pop_front();
-		nodeList.sort(NodeHeuristicCostComparer<NodeType, ArcType>());
-		//if(!pq.empty())
-		//	make_heap(const_cast<Node**>(&pq.top()), const_cast<Node**>(&pq.top()) + pq.size(), NodeHeuristicCostComparer<NodeType, ArcType>());
-
-	}//End while
+		Node* top = m_pNodes[pq.top()];
+		pq.pop();
+		instrumentation.popped();
+		context.countExpansion();
+		instrumentation.expanded();
 
+		if(pProcess != 0) {
+			pProcess(top);
+		}
 
-	//_ASSERT(!nodeList.empty());
-	if(nodeList.empty())
-		cout << "\a\a\aNode List is empty. Did you remember to clear the marks?" <<endl;
+		//For each child node c of top
+		typename Node::ArcList::const_iterator iter = top->arcList().begin();
+		typename Node::ArcList::const_iterator endIter = top->arcList().end();
+
+		for( ; iter != endIter; iter++) {
+			Node* node = iter->node();
+			int child = node->index();
+			instrumentation.relaxed();
+
+			//Let gC = g(top) + (top, c) // g(c) is actual path cost to child
+			ArcType gC = context.cost(top->index()) + iter->weight();
+
+			//If ( gC < g(c) )
+			if(gC < context.cost(child)) {
+				//let g[c] = gC, f[c] = g[c] + h[c] and set previous pointer of c to top
+				ArcType fC = gC + heuristic(child, pDest->index());
+				context.setCost(child, gC, top->index());
+				context.setEstimate(child, fC);
+
+				//Move c up if it is queued, otherwise (re)open it
+				if(pq.contains(child)) {
+					pq.decreaseKey(child, fC);
+					instrumentation.decreasedKey();
+				}
+				else {
+					pq.push(child, fC);
+					instrumentation.pushed(pq.size());
+					context.setMarked(child);
+				}
+			}//End if
+		}//End for
+	}//End while
 
+	if(context.reached(pDest->index())) {
 		//get the best path back to the start
-	for( Node* node = pDest; node != pStart; node = node->getPrevious() ) {
-		path.push_back(node);
+		for(int node = pDest->index(); node != -1; node = context.previous(node)) {
+			path.push_back(m_pNodes[node]);
+		}
 	}
-	path.push_back(pStart);
 
-	cout << "\nFinished A*." << endl;
+	instrumentation.end("Graph::aStar");
 }
 
 template<class NodeType, class ArcType>
-ArcType Graph<NodeType, ArcType>::heuristic_eval( Node* A, Node* B, float grainOfSalt) {
-	sf::Vector2f aPos = A->getPosition(), bPos = B->getPosition();
-	
-	ArcType result = sqrt(pow(bPos.x - aPos.x, 2) + pow(bPos.y - aPos.y, 2));
+ArcType Graph<NodeType, ArcType>::heuristic_eval( Node* A, Node* B, float grainOfSalt) const {
+	// in float, as the coordinates are; pow() and the double square
+	// root cost several times as much.
+	float dx = B->x() - A->x();
+	float dy = B->y() - A->y();
+	ArcType result = static_cast<ArcType>(std::sqrt(dx * dx + dy * dy));
 
 	return result * grainOfSalt;
 }
 
 template<class NodeType, class ArcType>
-int Graph<NodeType, ArcType>::getTotalNodes(){
+int Graph<NodeType, ArcType>::getTotalNodes() const {
 	return m_count;
 }
 
 
+// ----------------------------------------------------------------
+//  Name:           freeze
+//  Description:    Compiles the current nodes and arcs into an
+//                  immutable CSRGraph. Node ids in the snapshot are
+//                  the indices used here; empty slots become nodes
+//                  with no arcs. Later changes to this graph are
+//                  not reflected in the snapshot.
+//  Arguments:      None.
+//  Return Value:   The snapshot.
+// ----------------------------------------------------------------
 template<class NodeType, class ArcType>
-void Graph<NodeType, ArcType>::resetMarked(){
+CSRGraph<ArcType> Graph<NodeType, ArcType>::freeze() const {
+	typedef typename CSRGraph<ArcType>::NodeId NodeId;
+
+	vector<NodeId> offsets(m_maxNodes + 1, 0);
+	vector<float> x(m_maxNodes, 0.0f), y(m_maxNodes, 0.0f);
+
+	// count the arcs first so the arc arrays are allocated once; only
+	// the nodes are visited, and empty slots just get no arcs.
+	for(size_t n = 0; n != m_live.size(); n++) {
+		int i = m_live[n];
+		offsets[i + 1] = static_cast<NodeId>(m_pNodes[i]->arcList().size());
+		x[i] = m_pNodes[i]->x();
+		y[i] = m_pNodes[i]->y();
+	}
 	for(int i = 0; i != m_maxNodes; i++) {
-		 m_pNodes[i]->setColor(0,125,0);
-		 m_pNodes[i]->setMarked(false);
+		offsets[i + 1] += offsets[i];
 	}
+	vector<NodeId> targets(offsets[m_maxNodes]);
+	vector<ArcType> weights(offsets[m_maxNodes]);
+
+	for(size_t n = 0; n != m_live.size(); n++) {
+		int i = m_live[n];
+		NodeId arc = offsets[i];
+		typename Node::ArcList::const_iterator iter = m_pNodes[i]->arcList().begin();
+		typename Node::ArcList::const_iterator endIter = m_pNodes[i]->arcList().end();
+
+		for( ; iter != endIter; iter++, arc++) {
+			targets[arc] = static_cast<NodeId>(iter->node()->index());
+			weights[arc] = iter->weight();
+		}
+	}
+
+	return CSRGraph<ArcType>(offsets, targets, weights, x, y);
 }
 
 
@@ -2,7 +2,6 @@
 #define GRAPHARC_H
 
 #include "GraphNode.h"
-#include <sstream>
 
 // -------------------------------------------------------
 // Name:        GraphArc
@@ -24,24 +23,11 @@ private:
 // -------------------------------------------------------
     ArcType m_weight;
 
-	sf::Text m_text;
-
-	//start and end of the arc
-	sf::Vertex m_line[2];
-
-	//buffer for converting integer to string
-	char buffer[4];
-	
-	//start and end positions of arc
-	//int m_startX, m_startY, m_endX, m_endY;
-
 public:   
 
-	GraphArc(Font const &font) {
-		m_text.setFont(font);
-		m_text.setCharacterSize(8);
+	GraphArc() : m_pNode(0), m_weight() {
 	}
-    
+
     // Accessor functions
     GraphNode<NodeType, ArcType>* node() const {
         return m_pNode;
@@ -61,26 +47,6 @@ public:
        m_weight = weight;
 	   
     }
-
-	void setStartEnd(int startX, int startY, int endX, int endY) {
-		m_line[0] = sf::Vertex(sf::Vector2f( startX, startY ));
-		m_line[1] = sf::Vertex(sf::Vector2f( endX, endY ));
-		m_text.setPosition((startX + endX)/2.0f, (startY + endY)/2.0f);
-    }
-
-
-
-
-	void DrawArc(sf::RenderWindow & const w){
-		//draw the arc line
-		w.draw(m_line, 2, sf::Lines);
-
-		//draw the arc text
-		_itoa_s(m_weight,buffer,sizeof(buffer),10);
-		m_text.setString(buffer);
-		w.draw(m_text);
-			
-	}
     
 };
 
@@ -0,0 +1,291 @@
+#ifndef GRAPHARENA_H
+#define GRAPHARENA_H
+
+#include <vector>
+#include <cstddef>
+#include <new>
+
+// -------------------------------------------------------
+// Name:        PoolStats
+// Description: The counters of one ObjectPool.
+// -------------------------------------------------------
+struct PoolStats {
+	// objects handed out, and how many of those were slots
+	// given back earlier rather than new memory
+	size_t allocations;
+	size_t reused;
+	size_t releases;
+	size_t live;
+	size_t peak;
+	// calls to the system allocator, and the bytes they got
+	size_t blocks;
+	size_t reservedBytes;
+};
+
+// -------------------------------------------------------
+// Name:        ObjectPool
+// Description: Hands out memory for objects of one size. New
+//              slots are bumped off blocks that grow from 64
+//              to 64K objects, so a graph of a million nodes
+//              costs about thirty calls to the system allocator
+//              instead of a million; released slots go on a
+//              free list that allocate() takes from first. The
+//              blocks are freed together when the pool goes, so
+//              the objects must have been destroyed (or need no
+//              destructor) by then.
+//
+//              When pooling is off every object is a separate
+//              operator new, which is how the graph allocated
+//              before; the counters still work, for comparison.
+// -------------------------------------------------------
+class ObjectPool {
+private:
+	// a released slot holds the next free one.
+	struct FreeSlot {
+		FreeSlot *next;
+	};
+
+	static const size_t kFirstBlock = 64;
+	static const size_t kLargestBlock = 65536;
+
+	size_t m_size;
+	bool m_pooled;
+	std::vector<void*> m_blocks;
+	char *m_next;
+	char *m_end;
+	size_t m_nextBlock;
+	FreeSlot *m_free;
+	PoolStats m_stats;
+
+	void grow() {
+		size_t bytes = m_nextBlock * m_size;
+		m_next = static_cast<char*>(::operator new(bytes));
+		m_end = m_next + bytes;
+		m_blocks.push_back(m_next);
+		m_stats.blocks++;
+		m_stats.reservedBytes += bytes;
+		if(m_nextBlock < kLargestBlock) {
+			m_nextBlock *= 2;
+		}
+	}
+
+	// not copyable
+	ObjectPool( ObjectPool const & );
+	ObjectPool & operator=( ObjectPool const & );
+
+public:
+	ObjectPool( size_t size, bool pooled = true )
+		: m_size( slotSize(size) ), m_pooled( pooled ), m_next( 0 ), m_end( 0 ), m_nextBlock( kFirstBlock ), m_free( 0 ) {
+		m_stats = PoolStats();
+	}
+
+	// the bytes a slot for an object of the given size takes: two
+	// pointers' alignment suits anything the graph stores.
+	static size_t slotSize( size_t size ) {
+		size_t align = 2 * sizeof(void*);
+		size_t bytes = size < sizeof(FreeSlot) ? sizeof(FreeSlot) : size;
+		return (bytes + align - 1) / align * align;
+	}
+
+	~ObjectPool() {
+		for(size_t i = 0; i != m_blocks.size(); i++) {
+			::operator delete(m_blocks[i]);
+		}
+	}
+
+	size_t objectSize() const {
+		return m_size;
+	}
+
+	PoolStats const & stats() const {
+		return m_stats;
+	}
+
+	void * allocate() {
+		void *slot;
+		if(!m_pooled) {
+			slot = ::operator new(m_size);
+			m_stats.blocks++;
+			m_stats.reservedBytes += m_size;
+		}
+		else if(m_free != 0) {
+			slot = m_free;
+			m_free = m_free->next;
+			m_stats.reused++;
+		}
+		else {
+			if(m_next == m_end) {
+				grow();
+			}
+			slot = m_next;
+			m_next += m_size;
+		}
+		m_stats.allocations++;
+		if(++m_stats.live > m_stats.peak) {
+			m_stats.peak = m_stats.live;
+		}
+		return slot;
+	}
+
+	void release( void *slot ) {
+		if(!m_pooled) {
+			::operator delete(slot);
+			m_stats.reservedBytes -= m_size;
+		}
+		else {
+			FreeSlot *freed = static_cast<FreeSlot*>(slot);
+			freed->next = m_free;
+			m_free = freed;
+		}
+		m_stats.releases++;
+		m_stats.live--;
+	}
+};
+
+// -------------------------------------------------------
+// Name:        GraphArena
+// Description: The pools a Graph allocates its nodes and arc
+//              list cells from: one pool per object size,
+//              created on first use (a graph needs two).
+// -------------------------------------------------------
+class GraphArena {
+private:
+	std::vector<ObjectPool*> m_pools;
+	bool m_pooled;
+
+	// not copyable
+	GraphArena( GraphArena const & );
+	GraphArena & operator=( GraphArena const & );
+
+public:
+	explicit GraphArena( bool pooled = true ) : m_pooled( pooled ) {
+	}
+
+	~GraphArena() {
+		for(size_t i = 0; i != m_pools.size(); i++) {
+			delete m_pools[i];
+		}
+	}
+
+	bool pooled() const {
+		return m_pooled;
+	}
+
+	ObjectPool & pool( size_t size ) {
+		for(size_t i = 0; i != m_pools.size(); i++) {
+			if(m_pools[i]->objectSize() == ObjectPool::slotSize(size)) {
+				return *m_pools[i];
+			}
+		}
+		m_pools.push_back(new ObjectPool(size, m_pooled));
+		return *m_pools.back();
+	}
+
+	// the counters of every pool added together.
+	PoolStats stats() const {
+		PoolStats total = PoolStats();
+		for(size_t i = 0; i != m_pools.size(); i++) {
+			PoolStats const &stats = m_pools[i]->stats();
+			total.allocations += stats.allocations;
+			total.reused += stats.reused;
+			total.releases += stats.releases;
+			total.live += stats.live;
+			total.peak += stats.peak;
+			total.blocks += stats.blocks;
+			total.reservedBytes += stats.reservedBytes;
+		}
+		return total;
+	}
+};
+
+// -------------------------------------------------------
+// Name:        PoolAllocator
+// Description: A standard allocator over a GraphArena, for
+//              the containers inside a graph (the arc lists).
+//              Single objects come from the arena's pool for
+//              their size; arrays, and everything when there is
+//              no arena, from operator new.
+// -------------------------------------------------------
+template<class T>
+class PoolAllocator {
+public:
+	typedef T value_type;
+	typedef T * pointer;
+	typedef T const * const_pointer;
+	typedef T & reference;
+	typedef T const & const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+
+	template<class U>
+	struct rebind {
+		typedef PoolAllocator<U> other;
+	};
+
+	GraphArena *arena;
+	ObjectPool *pool;
+
+	PoolAllocator() : arena( 0 ), pool( 0 ) {
+	}
+
+	explicit PoolAllocator( GraphArena *pArena ) : arena( pArena ), pool( 0 ) {
+	}
+
+	template<class U>
+	PoolAllocator( PoolAllocator<U> const &other ) : arena( other.arena ), pool( 0 ) {
+	}
+
+	pointer allocate( size_type count, void const * = 0 ) {
+		if(count != 1 || arena == 0) {
+			return static_cast<pointer>(::operator new(count * sizeof(T)));
+		}
+		if(pool == 0) {
+			pool = &arena->pool(sizeof(T));
+		}
+		return static_cast<pointer>(pool->allocate());
+	}
+
+	void deallocate( pointer p, size_type count ) {
+		if(count != 1 || arena == 0) {
+			::operator delete(p);
+		}
+		else {
+			if(pool == 0) {
+				pool = &arena->pool(sizeof(T));
+			}
+			pool->release(p);
+		}
+	}
+
+	void construct( pointer p, T const &value ) {
+		new(p) T(value);
+	}
+
+	void destroy( pointer p ) {
+		p->~T();
+	}
+
+	size_type max_size() const {
+		return static_cast<size_type>(-1) / sizeof(T);
+	}
+
+	pointer address( reference value ) const {
+		return &value;
+	}
+
+	const_pointer address( const_reference value ) const {
+		return &value;
+	}
+
+	template<class U>
+	bool operator==( PoolAllocator<U> const &other ) const {
+		return arena == other.arena;
+	}
+
+	template<class U>
+	bool operator!=( PoolAllocator<U> const &other ) const {
+		return arena != other.arena;
+	}
+};
+
+#endif
@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////
+// GraphConvert
+//
+// Converts the nodes.txt / arcs.txt pair the demo reads into
+// the binary format of GraphFile.h, which MappedGraph opens
+// without parsing anything.
+//
+// Usage:   GraphConvert nodes.txt arcs.txt graph.bin
+//
+//          nodes.txt holds one name per node, and arcs.txt
+//          "from to weight startX startY endX endY" per arc;
+//          arcs are two-way, as in the demo, and the positions
+//          they give become the node coordinates. The arc file
+//          is read by ArcImporter, in blocks, so only the graph
+//          itself has to fit in memory.
+////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "ArcImporter.h"
+#include "GraphFile.h"
+
+using namespace std;
+
+int main(int argc, char *argv[]) {
+	if(argc != 4) {
+		cerr << "usage: GraphConvert nodes.txt arcs.txt graph.bin" << endl;
+		return EXIT_FAILURE;
+	}
+
+	//read nodes
+	ifstream nodeFile(argv[1]);
+	if(!nodeFile) {
+		cerr << "cannot open " << argv[1] << endl;
+		return EXIT_FAILURE;
+	}
+	vector<string> names;
+	string name;
+	while(nodeFile >> name) {
+		names.push_back(name);
+	}
+
+	//read arcs, straight into the frozen form
+	ArcImporter<int> importer;
+	CSRGraph<int> frozen;
+	if(!importer.load(argv[2], frozen, static_cast<CSRGraph<int>::NodeId>(names.size()))) {
+		cerr << "cannot open " << argv[2] << endl;
+		return EXIT_FAILURE;
+	}
+	ImportStats const &stats = importer.stats();
+	cout << argv[2] << ": " << stats.lines << " arcs read at " << stats.megabytesPerSecond() << " MB/s, "
+		<< stats.duplicates << " duplicates, " << stats.malformed << " lines skipped" << endl;
+
+	if(!writeGraphFile(argv[3], frozen, names)) {
+		cerr << "cannot write " << argv[3] << endl;
+		return EXIT_FAILURE;
+	}
+
+	cout << argv[3] << ": " << frozen.nodeCount() << " nodes, " << frozen.arcCount() << " arcs" << endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,359 @@
+#ifndef GRAPHFILE_H
+#define GRAPHFILE_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <limits>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "CSRGraph.h"
+
+// -------------------------------------------------------
+// Name:        GraphFileHeader
+// Description: The start of a binary graph file. Every
+//              section is an array of fixed-size values in
+//              the byte order of the machine that wrote it,
+//              starting at an 8-byte aligned offset, so a
+//              reader can use them straight out of a mapped
+//              file:
+//
+//                names    nodeCount + 1 unsigned offsets into
+//                         the text that follows them; name i is
+//                         the '\0' terminated string there
+//                x, y     nodeCount floats each
+//                offsets  nodeCount + 1 unsigned ints
+//                targets  arcCount unsigned ints
+//                weights  arcCount ArcType values
+//
+//              byteOrder is 0x01020304 as written, so a file
+//              from a machine of the other endianness is
+//              recognised and refused.
+// -------------------------------------------------------
+struct GraphFileHeader {
+	char magic[8];
+	unsigned int version;
+	unsigned int byteOrder;
+	unsigned int weightSize;
+	unsigned int weightIsInteger;
+	unsigned int nodeCount;
+	unsigned int arcCount;
+	unsigned long long namesOffset;
+	unsigned long long xOffset;
+	unsigned long long yOffset;
+	unsigned long long offsetsOffset;
+	unsigned long long targetsOffset;
+	unsigned long long weightsOffset;
+	unsigned long long fileSize;
+
+	static char const * expectedMagic() {
+		return "ASTARGRF";
+	}
+
+	static unsigned int currentVersion() {
+		return 1;
+	}
+};
+
+// ----------------------------------------------------------------
+//  Name:           writeGraphFile
+//  Description:    Writes a frozen graph and its node names in the
+//                  format above.
+//  Arguments:      The path to write, the graph and one name per
+//                  node (missing names are written empty).
+//  Return Value:   true if the whole file was written.
+// ----------------------------------------------------------------
+template<class ArcType>
+bool writeGraphFile( char const *path, CSRGraph<ArcType> const &graph, std::vector<std::string> const &names ) {
+	typedef typename CSRGraph<ArcType>::NodeId NodeId;
+	NodeId nodes = graph.nodeCount(), arcs = graph.arcCount();
+
+	std::vector<unsigned int> nameOffsets(nodes + 1, 0);
+	std::string text;
+	for(NodeId node = 0; node != nodes; node++) {
+		nameOffsets[node] = static_cast<unsigned int>(text.size());
+		if(node < names.size()) {
+			text += names[node];
+		}
+		text += '\0';
+	}
+	nameOffsets[nodes] = static_cast<unsigned int>(text.size());
+
+	// lay the sections out one after another, 8-byte aligned.
+	GraphFileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, GraphFileHeader::expectedMagic(), sizeof(header.magic));
+	header.version = GraphFileHeader::currentVersion();
+	header.byteOrder = 0x01020304;
+	header.weightSize = sizeof(ArcType);
+	header.weightIsInteger = std::numeric_limits<ArcType>::is_integer;
+	header.nodeCount = nodes;
+	header.arcCount = arcs;
+
+	unsigned long long end = sizeof(GraphFileHeader);
+	unsigned long long *sections[6] = { &header.namesOffset, &header.xOffset, &header.yOffset,
+		&header.offsetsOffset, &header.targetsOffset, &header.weightsOffset };
+	unsigned long long sizes[6] = { nameOffsets.size() * sizeof(unsigned int) + text.size(), nodes * sizeof(float),
+		nodes * sizeof(float), (nodes + 1ull) * sizeof(NodeId), arcs * sizeof(NodeId), arcs * sizeof(ArcType) };
+	for(int i = 0; i != 6; i++) {
+		end = (end + 7) & ~7ull;
+		*sections[i] = end;
+		end += sizes[i];
+	}
+	header.fileSize = end;
+
+	std::vector<float> x(nodes), y(nodes);
+	std::vector<NodeId> offsets(nodes + 1), targets(arcs);
+	std::vector<ArcType> weights(arcs);
+	for(NodeId node = 0; node != nodes; node++) {
+		x[node] = graph.x(node);
+		y[node] = graph.y(node);
+		offsets[node] = graph.arcBegin(node);
+	}
+	offsets[nodes] = arcs;
+	for(NodeId arc = 0; arc != arcs; arc++) {
+		targets[arc] = graph.target(arc);
+		weights[arc] = graph.weight(arc);
+	}
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	char const zeros[8] = { 0 };
+	unsigned long long written = sizeof(header);
+	file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+
+	char const *data[6] = { 0, reinterpret_cast<char const *>(x.data()), reinterpret_cast<char const *>(y.data()),
+		reinterpret_cast<char const *>(offsets.data()), reinterpret_cast<char const *>(targets.data()),
+		reinterpret_cast<char const *>(weights.data()) };
+	for(int i = 0; i != 6; i++) {
+		file.write(zeros, static_cast<std::streamsize>(*sections[i] - written));
+		if(i == 0) {
+			file.write(reinterpret_cast<char const *>(nameOffsets.data()), nameOffsets.size() * sizeof(unsigned int));
+			file.write(text.data(), text.size());
+		}
+		else {
+			file.write(data[i], static_cast<std::streamsize>(sizes[i]));
+		}
+		written = *sections[i] + sizes[i];
+	}
+	return file.good();
+}
+
+// -------------------------------------------------------
+// Name:        MappedGraph
+// Description: A graph file mapped read-only into memory.
+//              graph() is a CSRGraph view straight onto the
+//              mapping, so opening a file costs a header check
+//              and an O(N + A) bounds check of the offsets and
+//              targets, with no parsing and no copying; the
+//              pages are read in by the OS as searches touch
+//              them.
+// -------------------------------------------------------
+template<class ArcType>
+class MappedGraph {
+public:
+	typedef typename CSRGraph<ArcType>::NodeId NodeId;
+
+private:
+	char const * m_pData;
+	size_t m_size;
+	CSRGraph<ArcType> m_graph;
+	unsigned int const * m_pNameOffsets;
+	char const * m_pNames;
+
+#ifdef _WIN32
+	HANDLE m_file;
+	HANDLE m_mapping;
+#else
+	int m_file;
+#endif
+
+	bool check() const;
+
+	// not copyable
+	MappedGraph( MappedGraph const & );
+	MappedGraph & operator=( MappedGraph const & );
+
+public:
+	MappedGraph() : m_pData( 0 ), m_size( 0 ), m_pNameOffsets( 0 ), m_pNames( 0 ) {
+#ifdef _WIN32
+		m_file = INVALID_HANDLE_VALUE;
+		m_mapping = 0;
+#else
+		m_file = -1;
+#endif
+	}
+
+	~MappedGraph() {
+		close();
+	}
+
+	bool open( char const *path );
+	void close();
+
+	// Accessor functions
+	bool isOpen() const {
+		return m_pData != 0;
+	}
+
+	CSRGraph<ArcType> const & graph() const {
+		return m_graph;
+	}
+
+	char const * name( NodeId node ) const {
+		return m_pNames + m_pNameOffsets[node];
+	}
+
+	size_t fileSize() const {
+		return m_size;
+	}
+};
+
+// ----------------------------------------------------------------
+//  Name:           open
+//  Description:    Maps a file written by writeGraphFile.
+//  Arguments:      The path of the file.
+//  Return Value:   true if it was mapped. false if it could not be
+//                  opened, or is not a graph file of this version,
+//                  arc type and byte order, or is damaged; the
+//                  graph is then empty.
+// ----------------------------------------------------------------
+template<class ArcType>
+bool MappedGraph<ArcType>::open( char const *path ) {
+	close();
+
+#ifdef _WIN32
+	m_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	LARGE_INTEGER size;
+	if(m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &size) || size.QuadPart < (LONGLONG)sizeof(GraphFileHeader)) {
+		close();
+		return false;
+	}
+	m_mapping = CreateFileMappingA(m_file, 0, PAGE_READONLY, 0, 0, 0);
+	m_pData = m_mapping != 0 ? static_cast<char const *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0)) : 0;
+	m_size = static_cast<size_t>(size.QuadPart);
+#else
+	m_file = ::open(path, O_RDONLY);
+	struct stat info;
+	if(m_file == -1 || fstat(m_file, &info) != 0 || info.st_size < (off_t)sizeof(GraphFileHeader)) {
+		close();
+		return false;
+	}
+	void *data = mmap(0, info.st_size, PROT_READ, MAP_SHARED, m_file, 0);
+	m_pData = data != MAP_FAILED ? static_cast<char const *>(data) : 0;
+	m_size = static_cast<size_t>(info.st_size);
+#endif
+
+	if(m_pData == 0 || !check()) {
+		close();
+		return false;
+	}
+
+	GraphFileHeader const &header = *reinterpret_cast<GraphFileHeader const *>(m_pData);
+	m_pNameOffsets = reinterpret_cast<unsigned int const *>(m_pData + header.namesOffset);
+	m_pNames = reinterpret_cast<char const *>(m_pNameOffsets + header.nodeCount + 1);
+	m_graph = CSRGraph<ArcType>::view(header.nodeCount, header.arcCount,
+		reinterpret_cast<NodeId const *>(m_pData + header.offsetsOffset),
+		reinterpret_cast<NodeId const *>(m_pData + header.targetsOffset),
+		reinterpret_cast<ArcType const *>(m_pData + header.weightsOffset),
+		reinterpret_cast<float const *>(m_pData + header.xOffset),
+		reinterpret_cast<float const *>(m_pData + header.yOffset));
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           close
+//  Description:    Unmaps the file. graph() is empty afterwards.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType>
+void MappedGraph<ArcType>::close() {
+	m_graph = CSRGraph<ArcType>();
+	m_pNameOffsets = 0;
+	m_pNames = 0;
+
+#ifdef _WIN32
+	if(m_pData != 0) {
+		UnmapViewOfFile(m_pData);
+	}
+	if(m_mapping != 0) {
+		CloseHandle(m_mapping);
+	}
+	if(m_file != INVALID_HANDLE_VALUE) {
+		CloseHandle(m_file);
+	}
+	m_mapping = 0;
+	m_file = INVALID_HANDLE_VALUE;
+#else
+	if(m_pData != 0) {
+		munmap(const_cast<char *>(m_pData), m_size);
+	}
+	if(m_file != -1) {
+		::close(m_file);
+	}
+	m_file = -1;
+#endif
+
+	m_pData = 0;
+	m_size = 0;
+}
+
+template<class ArcType>
+bool MappedGraph<ArcType>::check() const {
+	GraphFileHeader const &header = *reinterpret_cast<GraphFileHeader const *>(m_pData);
+	if(std::memcmp(header.magic, GraphFileHeader::expectedMagic(), sizeof(header.magic)) != 0
+		|| header.version != GraphFileHeader::currentVersion() || header.byteOrder != 0x01020304
+		|| header.weightSize != sizeof(ArcType) || header.weightIsInteger != std::numeric_limits<ArcType>::is_integer
+		|| header.fileSize != m_size) {
+		return false;
+	}
+
+	// every section must lie inside the file and be aligned.
+	unsigned long long nodes = header.nodeCount, arcs = header.arcCount;
+	unsigned long long offsets[6] = { header.namesOffset, header.xOffset, header.yOffset,
+		header.offsetsOffset, header.targetsOffset, header.weightsOffset };
+	unsigned long long sizes[6] = { (nodes + 1) * sizeof(unsigned int), nodes * sizeof(float), nodes * sizeof(float),
+		(nodes + 1) * sizeof(NodeId), arcs * sizeof(NodeId), arcs * sizeof(ArcType) };
+	for(int i = 0; i != 6; i++) {
+		if(offsets[i] % 8 != 0 || offsets[i] > m_size || sizes[i] > m_size - offsets[i]) {
+			return false;
+		}
+	}
+
+	// and no offset or target may point outside its array, or the
+	// searches would read past the mapping.
+	unsigned int const *nameOffsets = reinterpret_cast<unsigned int const *>(m_pData + header.namesOffset);
+	unsigned long long textStart = header.namesOffset + sizes[0];
+	if(nameOffsets[nodes] > m_size - textStart || (nameOffsets[nodes] != 0 && m_pData[textStart + nameOffsets[nodes] - 1] != '\0')) {
+		return false;
+	}
+	NodeId const *arcOffsets = reinterpret_cast<NodeId const *>(m_pData + header.offsetsOffset);
+	NodeId const *targets = reinterpret_cast<NodeId const *>(m_pData + header.targetsOffset);
+	if(arcOffsets[0] != 0 || arcOffsets[nodes] != arcs) {
+		return false;
+	}
+	for(unsigned long long node = 0; node != nodes; node++) {
+		if(arcOffsets[node] > arcOffsets[node + 1] || nameOffsets[node] > nameOffsets[node + 1]) {
+			return false;
+		}
+	}
+	for(unsigned long long arc = 0; arc != arcs; arc++) {
+		if(targets[arc] >= nodes) {
+			return false;
+		}
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,283 @@
+#ifndef GRAPHGENERATORS_H
+#define GRAPHGENERATORS_H
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "CSRGraph.h"
+#include "GridMap.h"
+
+// -------------------------------------------------------
+// Name:        GeneratorRandom
+// Description: The random numbers the generators use: a
+//              splitmix64 stream, so that a seed gives the same
+//              graph on every compiler and platform (rand() and
+//              the <random> distributions do not promise that).
+// -------------------------------------------------------
+class GeneratorRandom {
+private:
+	unsigned long long m_state;
+
+public:
+	explicit GeneratorRandom( unsigned long long seed ) : m_state( seed ) {
+	}
+
+	unsigned long long next() {
+		unsigned long long z = (m_state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	// in [0, bound)
+	unsigned int below( unsigned int bound ) {
+		return static_cast<unsigned int>(next() % bound);
+	}
+
+	// in [0, 1)
+	double unit() {
+		return (next() >> 11) * (1.0 / 9007199254740992.0);
+	}
+};
+
+// -------------------------------------------------------
+// Name:        GeneratedArc
+// Description: A two-way arc for buildGeneratedGraph.
+// -------------------------------------------------------
+struct GeneratedArc {
+	unsigned int from;
+	unsigned int to;
+	int weight;
+};
+
+// ----------------------------------------------------------------
+//  Name:           buildGeneratedGraph
+//  Description:    Makes a CSRGraph with every arc in both
+//                  directions; repeated arcs and loops are dropped.
+//  Arguments:      The number of nodes, the arcs (emptied), and the
+//                  node coordinates (taken over).
+//  Return Value:   The graph.
+// ----------------------------------------------------------------
+inline CSRGraph<int> buildGeneratedGraph( unsigned int nodes, std::vector<GeneratedArc> &arcs, std::vector<float> &x, std::vector<float> &y ) {
+	typedef CSRGraph<int>::NodeId NodeId;
+
+	std::vector<NodeId> offsets(nodes + 1, 0);
+	for(size_t i = 0; i != arcs.size(); i++) {
+		if(arcs[i].from != arcs[i].to) {
+			offsets[arcs[i].from + 1]++;
+			offsets[arcs[i].to + 1]++;
+		}
+	}
+	for(NodeId node = 0; node != nodes; node++) {
+		offsets[node + 1] += offsets[node];
+	}
+
+	std::vector<std::pair<NodeId, int> > placed(offsets[nodes]);
+	std::vector<NodeId> next(offsets.begin(), offsets.end() - 1);
+	for(size_t i = 0; i != arcs.size(); i++) {
+		if(arcs[i].from != arcs[i].to) {
+			placed[next[arcs[i].from]++] = std::make_pair(arcs[i].to, arcs[i].weight);
+			placed[next[arcs[i].to]++] = std::make_pair(arcs[i].from, arcs[i].weight);
+		}
+	}
+	std::vector<GeneratedArc>().swap(arcs);
+
+	std::vector<NodeId> targets;
+	std::vector<int> weights;
+	targets.reserve(placed.size());
+	weights.reserve(placed.size());
+	NodeId begin = 0;
+	for(NodeId node = 0; node != nodes; node++) {
+		NodeId end = offsets[node + 1];
+		std::sort(placed.begin() + begin, placed.begin() + end);
+		offsets[node] = static_cast<NodeId>(targets.size());
+		for(NodeId arc = begin; arc != end; arc++) {
+			// the cheapest of any repeats sorts first.
+			if(arc == begin || placed[arc].first != placed[arc - 1].first) {
+				targets.push_back(placed[arc].first);
+				weights.push_back(placed[arc].second);
+			}
+		}
+		begin = end;
+	}
+	offsets[nodes] = static_cast<NodeId>(targets.size());
+
+	return CSRGraph<int>(offsets, targets, weights, x, y);
+}
+
+// every generator spaces its nodes about this far apart, and
+// no arc is cheaper than the straight line between its ends, so
+// the euclidean heuristic stays admissible.
+const int kGeneratorSpacing = 10;
+
+// ----------------------------------------------------------------
+//  Name:           generateGrid
+//  Description:    A side x side 4-connected grid. Each cell is
+//                  blocked with the given probability, and blocked
+//                  cells have no arcs. Arc weights are random in
+//                  [spacing, 2 * spacing).
+//  Arguments:      The side, the obstacle probability, the seed and,
+//                  optionally, a map to mark the same obstacles in
+//                  (it must be side x side).
+//  Return Value:   The graph; node y * side + x is cell (x, y).
+// ----------------------------------------------------------------
+inline CSRGraph<int> generateGrid( int side, double obstacles, unsigned long long seed, GridMap *map = 0 ) {
+	GeneratorRandom random(seed);
+	unsigned int nodes = static_cast<unsigned int>(side) * side;
+
+	std::vector<bool> blocked(nodes);
+	std::vector<float> x(nodes), y(nodes);
+	for(unsigned int node = 0; node != nodes; node++) {
+		blocked[node] = random.unit() < obstacles;
+		x[node] = static_cast<float>(node % side * kGeneratorSpacing);
+		y[node] = static_cast<float>(node / side * kGeneratorSpacing);
+		if(map != 0) {
+			map->setWalkable(node % side, node / side, !blocked[node]);
+		}
+	}
+
+	std::vector<GeneratedArc> arcs;
+	arcs.reserve(2 * static_cast<size_t>(nodes));
+	for(unsigned int node = 0; node != nodes; node++) {
+		unsigned int cx = node % side;
+		unsigned int right = node + 1, down = node + side;
+		if(cx + 1 != static_cast<unsigned int>(side) && !blocked[node] && !blocked[right]) {
+			GeneratedArc arc = { node, right, kGeneratorSpacing + static_cast<int>(random.below(kGeneratorSpacing)) };
+			arcs.push_back(arc);
+		}
+		if(down < nodes && !blocked[node] && !blocked[down]) {
+			GeneratedArc arc = { node, down, kGeneratorSpacing + static_cast<int>(random.below(kGeneratorSpacing)) };
+			arcs.push_back(arc);
+		}
+	}
+	return buildGeneratedGraph(nodes, arcs, x, y);
+}
+
+// ----------------------------------------------------------------
+//  Name:           generateGeometric
+//  Description:    A random geometric graph: nodes scattered
+//                  uniformly over a square, about spacing apart,
+//                  and every pair closer than the radius that gives
+//                  the requested average degree joined by an arc
+//                  weighing their distance, rounded up.
+//  Arguments:      The number of nodes, the average degree and the
+//                  seed.
+//  Return Value:   The graph.
+// ----------------------------------------------------------------
+inline CSRGraph<int> generateGeometric( unsigned int nodes, double degree, unsigned long long seed ) {
+	GeneratorRandom random(seed);
+	double extent = std::sqrt(static_cast<double>(nodes)) * kGeneratorSpacing;
+	// area per node is spacing^2, so pi r^2 / spacing^2 = degree.
+	double radius = kGeneratorSpacing * std::sqrt(degree / 3.14159265358979);
+
+	std::vector<float> x(nodes), y(nodes);
+	for(unsigned int node = 0; node != nodes; node++) {
+		x[node] = static_cast<float>(random.unit() * extent);
+		y[node] = static_cast<float>(random.unit() * extent);
+	}
+
+	// bucket the nodes into cells one radius wide, so each node only
+	// has to be compared with the nodes in the 3 x 3 cells around it.
+	unsigned int cells = static_cast<unsigned int>(extent / radius) + 1;
+	std::vector<unsigned int> cellStart(static_cast<size_t>(cells) * cells + 1, 0), order(nodes);
+	std::vector<unsigned int> cellOf(nodes);
+	for(unsigned int node = 0; node != nodes; node++) {
+		unsigned int cx = std::min(cells - 1, static_cast<unsigned int>(x[node] / radius));
+		unsigned int cy = std::min(cells - 1, static_cast<unsigned int>(y[node] / radius));
+		cellOf[node] = cy * cells + cx;
+		cellStart[cellOf[node] + 1]++;
+	}
+	for(size_t cell = 0; cell + 1 != cellStart.size(); cell++) {
+		cellStart[cell + 1] += cellStart[cell];
+	}
+	std::vector<unsigned int> fill(cellStart.begin(), cellStart.end() - 1);
+	for(unsigned int node = 0; node != nodes; node++) {
+		order[fill[cellOf[node]]++] = node;
+	}
+
+	std::vector<GeneratedArc> arcs;
+	arcs.reserve(static_cast<size_t>(nodes * degree / 2));
+	for(unsigned int node = 0; node != nodes; node++) {
+		int cx = static_cast<int>(cellOf[node] % cells), cy = static_cast<int>(cellOf[node] / cells);
+		for(int ny = cy - 1; ny <= cy + 1; ny++) {
+			for(int nx = cx - 1; nx <= cx + 1; nx++) {
+				if(nx < 0 || ny < 0 || nx >= static_cast<int>(cells) || ny >= static_cast<int>(cells)) {
+					continue;
+				}
+				unsigned int cell = ny * cells + nx;
+				for(unsigned int i = cellStart[cell]; i != cellStart[cell + 1]; i++) {
+					unsigned int other = order[i];
+					double dx = x[other] - x[node], dy = y[other] - y[node];
+					double distance = std::sqrt(dx * dx + dy * dy);
+					if(other > node && distance < radius) {
+						GeneratedArc arc = { node, other, static_cast<int>(std::ceil(distance)) + 1 };
+						arcs.push_back(arc);
+					}
+				}
+			}
+		}
+	}
+	return buildGeneratedGraph(nodes, arcs, x, y);
+}
+
+// ----------------------------------------------------------------
+//  Name:           generateScaleFree
+//  Description:    A Barabasi-Albert graph: each new node is joined
+//                  to `links` existing nodes picked with probability
+//                  proportional to their degree, which gives a few
+//                  hubs and a power-law degree distribution, like
+//                  road junction and network topologies. The nodes
+//                  are placed at random, and each arc weighs at
+//                  least the distance between its ends.
+//  Arguments:      The number of nodes, the links per new node and
+//                  the seed.
+//  Return Value:   The graph.
+// ----------------------------------------------------------------
+inline CSRGraph<int> generateScaleFree( unsigned int nodes, unsigned int links, unsigned long long seed ) {
+	GeneratorRandom random(seed);
+	double extent = std::sqrt(static_cast<double>(nodes)) * kGeneratorSpacing;
+
+	std::vector<float> x(nodes), y(nodes);
+	for(unsigned int node = 0; node != nodes; node++) {
+		x[node] = static_cast<float>(random.unit() * extent);
+		y[node] = static_cast<float>(random.unit() * extent);
+	}
+
+	// every arc end goes into ends, so a uniform pick from it is a
+	// pick weighted by degree.
+	std::vector<GeneratedArc> arcs;
+	std::vector<unsigned int> ends;
+	arcs.reserve(static_cast<size_t>(nodes) * links);
+	ends.reserve(2 * static_cast<size_t>(nodes) * links);
+
+	unsigned int seedNodes = std::min(nodes, links + 1);
+	for(unsigned int node = 1; node < seedNodes; node++) {
+		for(unsigned int other = 0; other != node; other++) {
+			GeneratedArc arc = { node, other, 0 };
+			arcs.push_back(arc);
+			ends.push_back(node);
+			ends.push_back(other);
+		}
+	}
+	for(unsigned int node = seedNodes; node < nodes; node++) {
+		for(unsigned int link = 0; link != links; link++) {
+			unsigned int other = ends[random.below(static_cast<unsigned int>(ends.size()))];
+			GeneratedArc arc = { node, other, 0 };
+			arcs.push_back(arc);
+		}
+		for(unsigned int link = 0; link != links; link++) {
+			ends.push_back(node);
+			ends.push_back(arcs[arcs.size() - 1 - link].to);
+		}
+	}
+	std::vector<unsigned int>().swap(ends);
+
+	for(size_t i = 0; i != arcs.size(); i++) {
+		double dx = x[arcs[i].to] - x[arcs[i].from], dy = y[arcs[i].to] - y[arcs[i].from];
+		arcs[i].weight = static_cast<int>(std::ceil(std::sqrt(dx * dx + dy * dy))) + 1 + static_cast<int>(random.below(kGeneratorSpacing));
+	}
+	return buildGeneratedGraph(nodes, arcs, x, y);
+}
+
+#endif
@@ -2,8 +2,10 @@
 #define GRAPHNODE_H
 
 #include <list>
+#include <vector>
 
-using namespace sf;
+#include "ArcIndex.h"
+#include "GraphArena.h"
 
 // Forward references
 template <typename NodeType, typename ArcType> class GraphArc;
@@ -12,14 +14,27 @@ template <typename NodeType, typename ArcType> class GraphArc;
 // Name:        GraphNode
 // Description: This is the node class. The node class 
 //              contains data, and has a linked list of 
-//              arcs.
+//              arcs, whose cells come from its graph's arena.
 // -------------------------------------------------------
 template<class NodeType, class ArcType>
 class GraphNode {
+public:
+    typedef list<GraphArc<NodeType, ArcType>, PoolAllocator<GraphArc<NodeType, ArcType> > > ArcList;
+
 private:    
 // typedef the classes to make our lives easier.
     typedef GraphArc<NodeType, ArcType> Arc;
     typedef GraphNode<NodeType, ArcType> Node;
+    typedef typename ArcList::iterator ArcIterator;
+
+// -------------------------------------------------------
+// Description: Below this many arcs getArc just scans the
+//              arc list; from here on the node keeps an
+//              ArcIndex so lookups stay O(1) on high-degree
+//              nodes.
+// -------------------------------------------------------
+    static const size_t kIndexThreshold = 8;
+
 // -------------------------------------------------------
 // Description: data inside the node
 // -------------------------------------------------------
@@ -28,92 +43,88 @@ private:
 // -------------------------------------------------------
 // Description: list of arcs that the node has.
 // -------------------------------------------------------
-    list<Arc> m_arcList;
+    ArcList m_arcList;
+
+// -------------------------------------------------------
+// Description: the arc to each neighbour, once the node
+//              has kIndexThreshold arcs (empty before that).
+// -------------------------------------------------------
+    ArcIndex<Node*, ArcIterator> m_arcIndex;
 
 // -------------------------------------------------------
-// Description: This remembers if the node is marked.
+// Description: the nodes that have an arc to this node,
+//              so the node can be unlinked in O(degree).
 // -------------------------------------------------------
-    bool m_marked;
+    vector<Node*> m_incoming;
 
-	//Pointer to previous node
-	Node* m_previousNode;
+// -------------------------------------------------------
+// Description: The index of the node in its graph.
+// -------------------------------------------------------
+	int m_index;
 
 
-	//Graphics variables
-	Text m_text;
-	CircleShape m_circle;
+// -------------------------------------------------------
+// Description: The position of the node, used by the
+//              heuristic and by any view of the graph.
+// -------------------------------------------------------
+	float m_x;
+	float m_y;
 
 public:
-	//constructor
-	GraphNode<NodeType, ArcType>::GraphNode( Font const &font, unsigned int radius = 25U ) {
-		m_previousNode = NULL;
-
-		//setup circle
-		m_circle.setOrigin(radius, radius);
-		m_circle.setRadius(radius);
-		m_circle.setFillColor(Color::Blue);
-
-		//setup text
-		m_text.setFont(font);
-		m_text.setCharacterSize(20U);
+	//constructor; the arc list cells come from the arena, if any.
+	explicit GraphNode( GraphArena* pArena = 0 ) : m_arcList( PoolAllocator<Arc>( pArena ) ) {
+		m_index = -1;
+		m_x = 0.0f;
+		m_y = 0.0f;
 	}
 
     // Accessor functions
-    list<Arc> const & arcList() const {
+    ArcList const & arcList() const {
         return m_arcList;              
     }
 
-	Vector2f getPosition() const {
-		return m_circle.getPosition();
+    vector<Node*> const & incoming() const {
+        return m_incoming;
+    }
+
+	float x() const {
+		return m_x;
 	}
 
-    bool marked() const {
-        return m_marked;
-    }
+	float y() const {
+		return m_y;
+	}
 
 	NodeType const & data() const {
         return m_data;
     }
 
+	int index() const {
+		return m_index;
+	}
+
     // Manipulator functions
 	void setData(NodeType data) {
         m_data = data;
-		m_text.setString(m_data.first);
     }
     
 	NodeType data() {
         return m_data;
     }
 
-    void setMarked(bool mark) {
-        m_marked = mark;
-    }
-
-	void setPrevious(Node* value) {
-        m_previousNode = value;
-    }
-
-	Node* getPrevious() {
-        return m_previousNode;
-    }
+	void setIndex(int index) {
+		m_index = index;
+	}
 
     Arc* getArc( Node* pNode );    
-    void addArc( Node* pNode, ArcType pWeight, int startX, int startY, int endX, int endY, Font const &font);
+    void addArc( Node* pNode, ArcType pWeight );
     void removeArc( Node* pNode );
+    void removeAllArcs();
 
-	void drawSelf(sf::RenderWindow &w);
-
-	void drawArcs(sf::RenderWindow &w);
-
-	void setPosition(int x, int y);
-
-	ArcType H_Value;
-	ArcType F_Value;
-
-	void setColor(float r, float g, float b);
-
-	bool containsPoint(int x, int y);
-
+	void setPosition(float x, float y) {
+		m_x = x;
+		m_y = y;
+	}
 };
 
 // ----------------------------------------------------------------
@@ -127,8 +138,14 @@ public:
 template<typename NodeType, typename ArcType>
 GraphArc<NodeType, ArcType>* GraphNode<NodeType, ArcType>::getArc( Node* pNode ) {
 
-     list<Arc>::iterator iter = m_arcList.begin();
-     list<Arc>::iterator endIter = m_arcList.end();
+     // high-degree nodes look the arc up in their index
+     if( !m_arcIndex.empty() ) {
+          ArcIterator const * pIter = m_arcIndex.find( pNode );
+          return pIter != 0 ? &( *(*pIter) ) : 0;
+     }
+
+     ArcIterator iter = m_arcList.begin();
+     ArcIterator endIter = m_arcList.end();
      Arc* pArc = 0;
      
      // find the arc that matches the node
@@ -153,16 +170,25 @@ GraphArc<NodeType, ArcType>* GraphNode<NodeType, ArcType>::getArc( Node* pNode )
 //  Return Value:   None.
 // ----------------------------------------------------------------
 template<typename NodeType, typename ArcType>
-void GraphNode<NodeType, ArcType>::addArc( Node* pNode, ArcType weight, int startx, int starty, int endx, int endy, sf::Font const &font) {
-   
-	// Create a new arc.
-   Arc a(font);
+void GraphNode<NodeType, ArcType>::addArc( Node* pNode, ArcType weight ) {
+   // Create a new arc.
+   Arc a;
    a.setNode(pNode);
-   a.setWeight(weight);   
-   a.setStartEnd(startx, starty, endx, endy);
-   
+   a.setWeight(weight);
+
    // Add it to the arc list.
    m_arcList.push_back( a );
+   pNode->m_incoming.push_back( this );
+
+   // index the arcs once there are enough of them to be worth it
+   if( !m_arcIndex.empty() ) {
+      m_arcIndex.insert( pNode, --m_arcList.end() );
+   }
+   else if( m_arcList.size() >= kIndexThreshold ) {
+      for( ArcIterator iter = m_arcList.begin(); iter != m_arcList.end(); ++iter ) {
+         m_arcIndex.insert( iter->node(), iter );
+      }
+   }
 }
 
 
@@ -170,58 +196,59 @@ void GraphNode<NodeType, ArcType>::addArc( Node* pNode, ArcType weight, int star
 //  Name:           removeArc
 //  Description:    This finds an arc from this node to input node 
 //                  and removes it.
-//  Arguments:      None.
+//  Arguments:      The node the arc points to.
 //  Return Value:   None.
 // ----------------------------------------------------------------
 template<typename NodeType, typename ArcType>
 void GraphNode<NodeType, ArcType>::removeArc( Node* pNode ) {
-	list<Arc>::iterator iter = m_arcList.begin();
-	list<Arc>::iterator endIter = m_arcList.end();
-
-     int size = m_arcList.size();
-     // find the arc that matches the node
-     for( ; iter != endIter && m_arcList.size() == size; ++iter ) {
-          if ( iter->node() == pNode) {
-             m_arcList.remove( (*iter) );
-          }                           
-     }
-}
-
-
-
-template<typename NodeType, typename ArcType>
-void GraphNode<NodeType, ArcType>::drawArcs(sf::RenderWindow & const w){
-	list<Arc>::iterator iter = m_arcList.begin();
-    list<Arc>::iterator endIter = m_arcList.end();
-    for( ; iter != endIter; ++iter ) {
-		iter->DrawArc(w);                     
-    }
-}
-
-
-template<typename NodeType, typename ArcType>
-void GraphNode<NodeType, ArcType>::drawSelf(sf::RenderWindow & const w){
-	w.draw(m_circle);
-	w.draw(m_text);
-}
-
-template<typename NodeType, typename ArcType>
-void GraphNode<NodeType, ArcType>::setPosition(int x, int y){
-	m_circle.setPosition(x, y);
-	m_text.setPosition(x - m_circle.getRadius()/2.0f, y - m_circle.getRadius()/2.0f);
-}
+	ArcIterator iter = m_arcList.end();
+
+	// find the arc that matches the node
+	if( !m_arcIndex.empty() ) {
+		ArcIterator const * pIter = m_arcIndex.find( pNode );
+		if( pIter != 0 ) {
+			iter = *pIter;
+			m_arcIndex.erase( pNode );
+		}
+	}
+	else {
+		for( iter = m_arcList.begin(); iter != m_arcList.end() && iter->node() != pNode; ++iter ) {
+		}
+	}
 
-template<typename NodeType, typename ArcType>
-void GraphNode<NodeType, ArcType>::setColor(float r, float g, float b){
-	m_circle.setFillColor(sf::Color(r, g, b, 255));
+	if( iter != m_arcList.end() ) {
+		m_arcList.erase( iter );
+
+		// the target no longer has an arc from this node
+		vector<Node*> &sources = pNode->m_incoming;
+		for( size_t i = 0; i != sources.size(); i++ ) {
+			if( sources[i] == this ) {
+				sources[i] = sources.back();
+				sources.pop_back();
+				break;
+			}
+		}
+	}
 }
 
+// ----------------------------------------------------------------
+//  Name:           removeAllArcs
+//  Description:    Removes every arc into and out of this node, in
+//                  time proportional to its degree.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
 template<typename NodeType, typename ArcType>
-bool GraphNode<NodeType, ArcType>::containsPoint(int x, int y) {
-	Vector2f pos = m_circle.getPosition();
+void GraphNode<NodeType, ArcType>::removeAllArcs() {
+	// arcs into the node; removeArc takes each source off m_incoming
+	while( !m_incoming.empty() ) {
+		m_incoming.back()->removeArc( this );
+	}
 
-	//return true if the point is closer (euclidean space) than the radius of the circle
-	return sqrtf(powf(x - pos.x, 2) + powf(y - pos.y, 2)) < m_circle.getRadius();
+	// arcs out of the node
+	while( !m_arcList.empty() ) {
+		removeArc( m_arcList.back().node() );
+	}
 }
 
 #include "GraphArc.h"
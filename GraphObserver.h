@@ -0,0 +1,40 @@
+#ifndef GRAPHOBSERVER_H
+#define GRAPHOBSERVER_H
+
+// -------------------------------------------------------
+// Name:        GraphObserver
+// Description: Told about every change made to a Graph it is
+//              registered with (Graph::addObserver), e.g. a
+//              cache of answers that the change can make stale.
+//              Each call is made after the change, except
+//              nodeRemoved, which is made before the node and
+//              its arcs go, so the node can still be looked at.
+//
+//              A weight written straight to a GraphArc through
+//              setWeight() is not seen; use
+//              Graph::setArcWeight() instead. Likewise a node
+//              moved with GraphNode::setPosition() is not seen;
+//              use Graph::setNodePosition().
+//
+//              nodeAdded and nodeMoved do nothing by default, for
+//              observers that only care about arcs.
+// -------------------------------------------------------
+template<class ArcType>
+class GraphObserver {
+public:
+	virtual ~GraphObserver() {
+	}
+
+	virtual void arcAdded( int from, int to, ArcType weight ) = 0;
+	virtual void arcRemoved( int from, int to ) = 0;
+	virtual void arcWeightChanged( int from, int to, ArcType oldWeight, ArcType weight ) = 0;
+	virtual void nodeRemoved( int index ) = 0;
+
+	virtual void nodeAdded( int ) {
+	}
+
+	virtual void nodeMoved( int, float, float ) {
+	}
+};
+
+#endif
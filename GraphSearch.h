@@ -0,0 +1,212 @@
+#ifndef GRAPHSEARCH_H
+#define GRAPHSEARCH_H
+
+#include <vector>
+#include <limits>
+
+#include "Graph.h"
+#include "SearchContext.h"
+
+// -------------------------------------------------------
+// Name:        CostTraits
+// Description: What the searches do differently for integer
+//              and floating point costs, chosen at compile time
+//              from std::numeric_limits. Weights are applied to
+//              integer costs in 1/1024ths, so a weighted
+//              heuristic stays in integer arithmetic.
+// -------------------------------------------------------
+template<class CostT, bool Integer = std::numeric_limits<CostT>::is_integer>
+struct CostTraits {
+	typedef double Weight;
+
+	static Weight weight( double factor ) {
+		return factor;
+	}
+
+	static CostT scale( CostT cost, Weight weight ) {
+		return static_cast<CostT>(cost * weight);
+	}
+};
+
+template<class CostT>
+struct CostTraits<CostT, true> {
+	typedef long long Weight;
+
+	static Weight weight( double factor ) {
+		return static_cast<Weight>(factor * 1024.0 + 0.5);
+	}
+
+	static CostT scale( CostT cost, Weight weight ) {
+		return static_cast<CostT>(cost * weight >> 10);
+	}
+};
+
+// -------------------------------------------------------
+// Name:        ZeroHeuristic
+// Description: No estimate at all, which makes search() a
+//              uniform cost search (Dijkstra).
+// -------------------------------------------------------
+template<class CostT>
+struct ZeroHeuristic {
+	CostT operator()( int, int ) const {
+		return 0;
+	}
+};
+
+// -------------------------------------------------------
+// Name:        WeightedHeuristic
+// Description: Another heuristic times a weight w >= 1, which
+//              makes search() weighted A*: it expands fewer
+//              nodes and its paths cost at most w times the
+//              shortest.
+// -------------------------------------------------------
+template<class Heuristic, class CostT>
+struct WeightedHeuristic {
+	Heuristic heuristic;
+	typename CostTraits<CostT>::Weight weight;
+
+	WeightedHeuristic( Heuristic const &h, double factor )
+		: heuristic( h ), weight( CostTraits<CostT>::weight(factor) ) {
+	}
+
+	CostT operator()( int node, int dest ) const {
+		return CostTraits<CostT>::scale(static_cast<CostT>(heuristic(node, dest)), weight);
+	}
+};
+
+// -------------------------------------------------------
+// Name:        GreedyHeuristic
+// Description: Another heuristic, used alone: search() orders
+//              the open set by the estimate and ignores the
+//              cost so far, which is greedy best-first search.
+//              It is fast but its paths are not shortest.
+// -------------------------------------------------------
+template<class Heuristic, class CostT>
+struct GreedyHeuristic {
+	Heuristic heuristic;
+
+	explicit GreedyHeuristic( Heuristic const &h ) : heuristic( h ) {
+	}
+
+	CostT operator()( int node, int dest ) const {
+		return static_cast<CostT>(heuristic(node, dest));
+	}
+};
+
+// -------------------------------------------------------
+// Name:        NullVisitor
+// Description: The visitor to pass when nothing needs to see
+//              the expanded nodes; the call compiles away.
+// -------------------------------------------------------
+struct NullVisitor {
+	template<class Node>
+	void operator()( Node* ) const {
+	}
+};
+
+// ----------------------------------------------------------------
+//  Name:           searchPriority
+//  Description:    The open set key of a node: g + h, or h alone
+//                  for greedy best-first.
+//  Arguments:      The heuristic (only its type matters), the cost
+//                  so far and the estimate.
+//  Return Value:   The key.
+// ----------------------------------------------------------------
+template<class Heuristic, class CostT>
+inline CostT searchPriority( Heuristic const &, CostT cost, CostT estimate ) {
+	return cost + estimate;
+}
+
+template<class Heuristic, class CostT>
+inline CostT searchPriority( GreedyHeuristic<Heuristic, CostT> const &, CostT, CostT estimate ) {
+	return estimate;
+}
+
+// ----------------------------------------------------------------
+//  Name:           search
+//  Description:    Best-first search on a Graph with every part
+//                  chosen at compile time, so nothing is called
+//                  through a pointer and each policy can be
+//                  inlined:
+//                    Heuristic  a functor estimating the cost
+//                               between two node indices:
+//                               ZeroHeuristic (Dijkstra), any
+//                               admissible one (A*), or one
+//                               wrapped in WeightedHeuristic or
+//                               GreedyHeuristic;
+//                    OpenSet    IndexedPriorityQueue<CostT>,
+//                               LazyPriorityQueue<CostT> or any
+//                               class with their interface;
+//                    Visitor    called with each expanded node;
+//                               NullVisitor for none, a functor,
+//                               or (through a pointer, as Graph's
+//                               searches do) a function;
+//                    CostT      the type costs are added up in,
+//                               which may be wider than ArcType.
+//                  A node whose cost drops after it was expanded is
+//                  queued again, so an admissible heuristic is
+//                  enough for an exact result.
+//  Arguments:      The graph, the search context (it is reset
+//                  first), the open set (cleared first), the start
+//                  and destination, the heuristic, the visitor and
+//                  the vector to write the path into (destination
+//                  first).
+//  Return Value:   The cost of the path, or the context's infinity()
+//                  if pDest cannot be reached (the path is then left
+//                  empty).
+// ----------------------------------------------------------------
+template<class Heuristic, class OpenSet, class Visitor, class CostT, class NodeType, class ArcType>
+CostT search( Graph<NodeType, ArcType> const &graph, SearchContext<CostT> &context, OpenSet &open,
+              GraphNode<NodeType, ArcType>* pStart, GraphNode<NodeType, ArcType>* pDest,
+              Heuristic const &heuristic, Visitor visitor, std::vector<GraphNode<NodeType, ArcType>*> &path ) {
+	typedef GraphNode<NodeType, ArcType> Node;
+	Node** nodes = graph.nodeArray();
+	int dest = pDest->index();
+
+	context.reset(graph.getMaxNodes());
+	open.clear();
+	open.reserve(graph.getMaxNodes());
+
+	context.setCost(pStart->index(), 0, -1);
+	open.push(pStart->index(), searchPriority(heuristic, CostT(0), static_cast<CostT>(heuristic(pStart->index(), dest))));
+	context.setMarked(pStart->index());
+
+	while(!open.empty() && open.top() != dest) {
+		Node* top = nodes[open.top()];
+		open.pop();
+		context.countExpansion();
+		visitor(top);
+
+		CostT cost = context.cost(top->index());
+		typename Node::ArcList::const_iterator iter = top->arcList().begin();
+		typename Node::ArcList::const_iterator endIter = top->arcList().end();
+
+		for( ; iter != endIter; iter++) {
+			int child = iter->node()->index();
+			CostT gC = cost + iter->weight();
+
+			if(gC < context.cost(child)) {
+				CostT fC = searchPriority(heuristic, gC, static_cast<CostT>(heuristic(child, dest)));
+				context.setCost(child, gC, top->index());
+				context.setEstimate(child, fC);
+
+				if(open.contains(child)) {
+					open.decreaseKey(child, fC);
+				}
+				else {
+					open.push(child, fC);
+					context.setMarked(child);
+				}
+			}
+		}
+	}
+
+	if(context.reached(dest)) {
+		for(int node = dest; node != -1; node = context.previous(node)) {
+			path.push_back(nodes[node]);
+		}
+	}
+	return context.cost(dest);
+}
+
+#endif
@@ -0,0 +1,444 @@
+#ifndef GRAPHVIEW_H
+#define GRAPHVIEW_H
+
+#include "SFML/Graphics.hpp"
+#include <sstream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+
+#include "Graph.h"
+#include "GraphObserver.h"
+#include "SpatialIndex.h"
+
+// -------------------------------------------------------
+// Name:        GraphView
+// Description: Draws a Graph with SFML. The graph itself only
+//              stores topology, weights and positions; the
+//              shapes, fonts and node colours all live here so
+//              that headless programs never need SFML.
+//
+//              Everything is drawn from four vertex arrays, in
+//              four draw calls however large the graph: the arc
+//              lines, the arc weights, the node circles (copies
+//              of one circle mesh) and the node labels. The
+//              labels are quads cut from the font's glyph
+//              texture, laid out once as sf::Text would lay
+//              them out. The arrays are rebuilt only when the
+//              graph changes (the view observes it) or the
+//              window's view is panned or zoomed; a colour
+//              change rewrites just that node's circle.
+//
+//              Only what can be seen is laid out: the nodes in
+//              the window's view, and the arcs whose bounding
+//              box meets it, are found through a SpatialIndex,
+//              which nodeAt() uses as well. Positions written
+//              straight to a node with GraphNode::setPosition()
+//              are not seen; use Graph::setNodePosition(), or
+//              call invalidate().
+// -------------------------------------------------------
+template<class NodeType, class ArcType>
+class GraphView : public GraphObserver<ArcType> {
+private:
+	typedef GraphArc<NodeType, ArcType> Arc;
+	typedef GraphNode<NodeType, ArcType> Node;
+
+	static const unsigned int kNodeTextSize = 20;
+	static const unsigned int kArcTextSize = 8;
+	static const int kCircleSegments = 24;
+
+	Graph<NodeType, ArcType> & m_graph;
+	sf::Font const & m_font;
+	float m_radius;
+	SpatialIndex<NodeType, ArcType> m_index;
+
+// -------------------------------------------------------
+// Description: An upper bound on the width and height of any
+//              arc's bounding box, so that every arc crossing
+//              the view starts at a node within this distance
+//              of it. It only grows.
+// -------------------------------------------------------
+	float m_reach;
+
+// -------------------------------------------------------
+// Description: The part of the world the arrays were laid out
+//              for (left, top, right, bottom), and the nodes
+//              they hold circles for.
+// -------------------------------------------------------
+	sf::FloatRect m_laidOut;
+	std::vector<int> m_visible;
+	std::vector<int> m_found;
+
+// -------------------------------------------------------
+// Description: The circle every node is drawn with, as the
+//              offsets of its rim from the centre.
+// -------------------------------------------------------
+	std::vector<sf::Vector2f> m_circleMesh;
+
+	sf::VertexArray m_arcLines;
+	sf::VertexArray m_arcLabels;
+	sf::VertexArray m_circles;
+	sf::VertexArray m_nodeLabels;
+
+// -------------------------------------------------------
+// Description: Where each node's circle starts in m_circles
+//              (-1 for an empty slot), and the colour it was
+//              last written in.
+// -------------------------------------------------------
+	std::vector<int> m_circleStart;
+	std::vector<sf::Color> m_shown;
+	bool m_dirty;
+
+// -------------------------------------------------------
+// Description: The colour of each node, indexed by node
+//              index.
+// -------------------------------------------------------
+	std::vector<sf::Color> m_colours;
+
+// -------------------------------------------------------
+// Description: The search whose queued nodes are shown in
+//              gray, or 0.
+// -------------------------------------------------------
+	SearchContext<ArcType> const * m_pContext;
+
+	void rebuild( sf::FloatRect const &area );
+	void stretchReach( int node );
+	void appendText( sf::VertexArray &quads, std::string const &text, unsigned int size, float x, float y );
+	void paintCircle( int node, sf::Color const &colour );
+
+	// not copyable
+	GraphView( GraphView const & );
+	GraphView & operator=( GraphView const & );
+
+public:
+	GraphView( Graph<NodeType, ArcType> &graph, sf::Font const &font, float radius = 25.0f );
+	~GraphView();
+
+	void setSearchContext( SearchContext<ArcType> const *pContext ) {
+		m_pContext = pContext;
+	}
+
+	// makes the next draw() rebuild everything, re-reading every
+	// node's position.
+	void invalidate() {
+		m_index.rebuild();
+		for(size_t i = 0; i != m_graph.liveNodes().size(); ++i) {
+			stretchReach(m_graph.liveNodes()[i]);
+		}
+		m_dirty = true;
+	}
+
+	// the index of the graph's node positions, for snapping world
+	// coordinates to nodes.
+	SpatialIndex<NodeType, ArcType> const & index() const {
+		return m_index;
+	}
+
+	void setColor( Node const * pNode, sf::Color const &colour );
+	void resetColors();
+	Node* nodeAt( int x, int y ) const;
+	void draw( sf::RenderWindow &w );
+
+	// GraphObserver: any change to the graph means a rebuild.
+	void arcAdded( int from, int, ArcType ) {
+		stretchReach(from);
+		m_dirty = true;
+	}
+
+	void arcRemoved( int, int ) {
+		m_dirty = true;
+	}
+
+	void arcWeightChanged( int, int, ArcType, ArcType ) {
+		m_dirty = true;
+	}
+
+	void nodeRemoved( int ) {
+		m_dirty = true;
+	}
+
+	void nodeAdded( int ) {
+		m_dirty = true;
+	}
+
+	void nodeMoved( int index, float, float ) {
+		stretchReach(index);
+		m_dirty = true;
+	}
+};
+
+template<class NodeType, class ArcType>
+GraphView<NodeType, ArcType>::GraphView( Graph<NodeType, ArcType> &graph, sf::Font const &font, float radius )
+	: m_graph( graph ), m_font( font ), m_radius( radius ), m_index( graph, 4.0f * radius ), m_reach( 0.0f ),
+	  m_arcLines( sf::Lines ), m_arcLabels( sf::Quads ), m_circles( sf::Triangles ), m_nodeLabels( sf::Quads ),
+	  m_dirty( true ), m_pContext( 0 ) {
+	for(int i = 0; i != kCircleSegments; ++i) {
+		float angle = i * 2.0f * 3.14159265f / kCircleSegments;
+		m_circleMesh.push_back(sf::Vector2f(radius * std::cos(angle), radius * std::sin(angle)));
+	}
+
+	for(size_t i = 0; i != m_graph.liveNodes().size(); ++i) {
+		stretchReach(m_graph.liveNodes()[i]);
+	}
+
+	resetColors();
+	m_graph.addObserver(this);
+}
+
+template<class NodeType, class ArcType>
+GraphView<NodeType, ArcType>::~GraphView() {
+	m_graph.removeObserver(this);
+}
+
+// ----------------------------------------------------------------
+//  Name:           setColor
+//  Description:    Sets the fill colour of a node.
+//  Arguments:      The node and its new colour.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void GraphView<NodeType, ArcType>::setColor( Node const * pNode, sf::Color const &colour ) {
+	if(pNode->index() >= static_cast<int>(m_colours.size())) {
+		m_colours.resize(m_graph.getMaxNodes(), sf::Color::Blue);
+	}
+	m_colours[pNode->index()] = colour;
+}
+
+// ----------------------------------------------------------------
+//  Name:           resetColors
+//  Description:    Sets every node back to blue (untouched).
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void GraphView<NodeType, ArcType>::resetColors() {
+	m_colours.assign(m_graph.getMaxNodes(), sf::Color::Blue);
+}
+
+// ----------------------------------------------------------------
+//  Name:           nodeAt
+//  Description:    Finds the node whose circle contains a point;
+//                  where circles overlap, the one whose centre is
+//                  closest.
+//  Arguments:      The point, in world coordinates (the same as the
+//                  window's while its default view is in use).
+//  Return Value:   The node, or 0 if no node is there.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+GraphNode<NodeType, ArcType>* GraphView<NodeType, ArcType>::nodeAt( int x, int y ) const {
+	int node = m_index.nearest(static_cast<float>(x), static_cast<float>(y), m_radius);
+	return node == -1 ? 0 : m_graph.nodeArray()[node];
+}
+
+// ----------------------------------------------------------------
+//  Name:           stretchReach
+//  Description:    Grows m_reach to cover the arcs leaving a node
+//                  and those arriving at it.
+//  Arguments:      The node index (an empty slot is ignored).
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void GraphView<NodeType, ArcType>::stretchReach( int node ) {
+	Node* pNode = m_graph.nodeArray()[node];
+	if(pNode == 0) {
+		return;
+	}
+
+	typename Node::ArcList::const_iterator iter = pNode->arcList().begin();
+	typename Node::ArcList::const_iterator endIter = pNode->arcList().end();
+	for( ; iter != endIter; ++iter) {
+		m_reach = std::max(m_reach, std::max(std::fabs(iter->node()->x() - pNode->x()), std::fabs(iter->node()->y() - pNode->y())));
+	}
+
+	for(size_t i = 0; i != pNode->incoming().size(); ++i) {
+		Node* pSource = pNode->incoming()[i];
+		m_reach = std::max(m_reach, std::max(std::fabs(pSource->x() - pNode->x()), std::fabs(pSource->y() - pNode->y())));
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           rebuild
+//  Description:    Lays out the arc lines, weights, circles and
+//                  labels that can be seen in an area: the nodes
+//                  within reach of it are looked up in the index,
+//                  and each of their arcs is kept if its bounding
+//                  box meets the area.
+//  Arguments:      The area, as left, top, width and height.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void GraphView<NodeType, ArcType>::rebuild( sf::FloatRect const &area ) {
+	Node** nodes = m_graph.nodeArray();
+	int maxNodes = m_graph.getMaxNodes();
+	float left = area.left, top = area.top;
+	float right = area.left + area.width, bottom = area.top + area.height;
+
+	m_arcLines.clear();
+	m_arcLabels.clear();
+	m_circles.clear();
+	m_nodeLabels.clear();
+	if(static_cast<int>(m_circleStart.size()) < maxNodes) {
+		m_circleStart.resize(maxNodes, -1);
+		m_shown.resize(maxNodes, sf::Color::Transparent);
+	}
+	for(size_t i = 0; i != m_visible.size(); ++i) {
+		m_circleStart[m_visible[i]] = -1;
+	}
+	m_visible.clear();
+	if(static_cast<int>(m_colours.size()) < maxNodes) {
+		m_colours.resize(maxNodes, sf::Color::Blue);
+	}
+
+	// a circle and its label stay within two radii of the centre, and
+	// any arc crossing the area starts within m_reach of it.
+	float margin = 2.0f * m_radius;
+	float reach = std::max(m_reach, margin);
+	m_found.clear();
+	m_index.inRectangle(left - reach, top - reach, right + reach, bottom + reach, m_found);
+
+	//the arcs (TODO: don't draw reverse arcs)
+	for(size_t n = 0; n != m_found.size(); ++n) {
+		Node* from = nodes[m_found[n]];
+		typename Node::ArcList::const_iterator iter = from->arcList().begin();
+		typename Node::ArcList::const_iterator endIter = from->arcList().end();
+
+		for( ; iter != endIter; ++iter) {
+			Node* to = iter->node();
+			if(std::max(from->x(), to->x()) < left || std::min(from->x(), to->x()) > right ||
+			   std::max(from->y(), to->y()) < top || std::min(from->y(), to->y()) > bottom) {
+				continue;
+			}
+
+			m_arcLines.append(sf::Vertex(sf::Vector2f(from->x(), from->y())));
+			m_arcLines.append(sf::Vertex(sf::Vector2f(to->x(), to->y())));
+
+			std::ostringstream weight;
+			weight << iter->weight();
+			appendText(m_arcLabels, weight.str(), kArcTextSize, (from->x() + to->x()) / 2.0f, (from->y() + to->y()) / 2.0f);
+		}
+	}
+
+	//the nodes: a fan of triangles each, coloured by draw()
+	for(size_t n = 0; n != m_found.size(); ++n) {
+		int i = m_found[n];
+		if(nodes[i]->x() < left - margin || nodes[i]->x() > right + margin ||
+		   nodes[i]->y() < top - margin || nodes[i]->y() > bottom + margin) {
+			continue;
+		}
+
+		sf::Vector2f centre(nodes[i]->x(), nodes[i]->y());
+		m_circleStart[i] = static_cast<int>(m_circles.getVertexCount());
+		m_shown[i] = sf::Color::Transparent;
+		m_visible.push_back(i);
+		for(int segment = 0; segment != kCircleSegments; ++segment) {
+			sf::Vector2f const &rim = m_circleMesh[segment];
+			sf::Vector2f const &next = m_circleMesh[(segment + 1) % kCircleSegments];
+			m_circles.append(sf::Vertex(centre));
+			m_circles.append(sf::Vertex(sf::Vector2f(centre.x + rim.x, centre.y + rim.y)));
+			m_circles.append(sf::Vertex(sf::Vector2f(centre.x + next.x, centre.y + next.y)));
+		}
+
+		std::ostringstream label;
+		label << nodes[i]->data().first;
+		appendText(m_nodeLabels, label.str(), kNodeTextSize, nodes[i]->x() - m_radius / 2.0f, nodes[i]->y() - m_radius / 2.0f);
+	}
+
+	m_laidOut = area;
+	m_dirty = false;
+}
+
+// ----------------------------------------------------------------
+//  Name:           appendText
+//  Description:    Adds the quads of a line of text, placed as an
+//                  sf::Text of the same size at (x, y) would place
+//                  its glyphs.
+//  Arguments:      The array to add to, the text, the character
+//                  size and the text's top left corner.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void GraphView<NodeType, ArcType>::appendText( sf::VertexArray &quads, std::string const &text, unsigned int size, float x, float y ) {
+	float penX = x;
+	float baseline = y + size;
+	sf::Uint32 previous = 0;
+
+	for(size_t i = 0; i != text.size(); ++i) {
+		sf::Uint32 character = static_cast<unsigned char>(text[i]);
+		penX += m_font.getKerning(previous, character, size);
+		previous = character;
+
+		sf::Glyph const &glyph = m_font.getGlyph(character, size, false);
+		float left = penX + glyph.bounds.left;
+		float top = baseline + glyph.bounds.top;
+		float right = left + glyph.bounds.width;
+		float bottom = top + glyph.bounds.height;
+
+		float u1 = static_cast<float>(glyph.textureRect.left);
+		float v1 = static_cast<float>(glyph.textureRect.top);
+		float u2 = static_cast<float>(glyph.textureRect.left + glyph.textureRect.width);
+		float v2 = static_cast<float>(glyph.textureRect.top + glyph.textureRect.height);
+
+		quads.append(sf::Vertex(sf::Vector2f(left, top), sf::Color::White, sf::Vector2f(u1, v1)));
+		quads.append(sf::Vertex(sf::Vector2f(right, top), sf::Color::White, sf::Vector2f(u2, v1)));
+		quads.append(sf::Vertex(sf::Vector2f(right, bottom), sf::Color::White, sf::Vector2f(u2, v2)));
+		quads.append(sf::Vertex(sf::Vector2f(left, bottom), sf::Color::White, sf::Vector2f(u1, v2)));
+
+		penX += glyph.advance;
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           paintCircle
+//  Description:    Recolours the triangles of one node's circle.
+//  Arguments:      The node index and its colour.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void GraphView<NodeType, ArcType>::paintCircle( int node, sf::Color const &colour ) {
+	int first = m_circleStart[node];
+	for(int vertex = first; vertex != first + 3 * kCircleSegments; ++vertex) {
+		m_circles[vertex].color = colour;
+	}
+	m_shown[node] = colour;
+}
+
+// ----------------------------------------------------------------
+//  Name:           draw
+//  Description:    Draws the arcs (lines and weights) and then the
+//                  nodes on top, rebuilding the arrays first if the
+//                  graph has changed or the window's view shows a
+//                  different area. Only the circles whose colour
+//                  differs from last frame are rewritten; nodes the
+//                  search has queued but not yet coloured are drawn
+//                  gray.
+//  Arguments:      The window to draw to.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void GraphView<NodeType, ArcType>::draw( sf::RenderWindow &w ) {
+	sf::View const &view = w.getView();
+	sf::FloatRect area(view.getCenter().x - view.getSize().x / 2.0f, view.getCenter().y - view.getSize().y / 2.0f,
+	                   view.getSize().x, view.getSize().y);
+	if(m_dirty || area != m_laidOut) {
+		rebuild(area);
+	}
+
+	for(size_t n = 0; n != m_visible.size(); ++n) {
+		int i = m_visible[n];
+		sf::Color colour = m_colours[i];
+		if(colour == sf::Color::Blue && m_pContext != 0 && i < m_pContext->capacity() && m_pContext->marked(i)) {
+			colour = sf::Color(100, 100, 100);
+		}
+		if(colour != m_shown[i]) {
+			paintCircle(i, colour);
+		}
+	}
+
+	w.draw(m_arcLines);
+	w.draw(m_arcLabels, sf::RenderStates(&m_font.getTexture(kArcTextSize)));
+	w.draw(m_circles);
+	w.draw(m_nodeLabels, sf::RenderStates(&m_font.getTexture(kNodeTextSize)));
+}
+
+#endif
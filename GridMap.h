@@ -0,0 +1,75 @@
+#ifndef GRIDMAP_H
+#define GRIDMAP_H
+
+#include <vector>
+#include <cstddef>
+
+// -------------------------------------------------------
+// Name:        GridMap
+// Description: A width x height map of walkable and blocked
+//              cells, one bit per cell, row by row. Movement
+//              is 8-connected, but a diagonal step is only
+//              allowed when both cells it passes between are
+//              walkable, so paths never cut a corner. Cell
+//              (x, y) has the id y * width + x, which is what
+//              JumpPointSearch returns paths in. Cells outside
+//              the map read as blocked.
+// -------------------------------------------------------
+class GridMap {
+private:
+	int m_width;
+	int m_height;
+	std::vector<unsigned long long> m_bits;
+
+public:
+	GridMap( int width, int height, bool walkable = true )
+		: m_width( width ), m_height( height ),
+		  m_bits( (static_cast<size_t>(width) * height + 63) / 64, walkable ? ~0ull : 0ull ) {
+	}
+
+	// Accessor functions
+	int width() const {
+		return m_width;
+	}
+
+	int height() const {
+		return m_height;
+	}
+
+	int id( int x, int y ) const {
+		return y * m_width + x;
+	}
+
+	int x( int id ) const {
+		return id % m_width;
+	}
+
+	int y( int id ) const {
+		return id / m_width;
+	}
+
+	bool walkable( int x, int y ) const {
+		if( x < 0 || y < 0 || x >= m_width || y >= m_height ) {
+			return false;
+		}
+		size_t bit = static_cast<size_t>(y) * m_width + x;
+		return (m_bits[bit >> 6] >> (bit & 63)) & 1;
+	}
+
+	size_t memoryUsage() const {
+		return m_bits.capacity() * sizeof(unsigned long long);
+	}
+
+	// Manipulator functions
+	void setWalkable( int x, int y, bool walkable ) {
+		size_t bit = static_cast<size_t>(y) * m_width + x;
+		if( walkable ) {
+			m_bits[bit >> 6] |= 1ull << (bit & 63);
+		}
+		else {
+			m_bits[bit >> 6] &= ~(1ull << (bit & 63));
+		}
+	}
+};
+
+#endif
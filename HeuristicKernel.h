@@ -0,0 +1,282 @@
+#ifndef HEURISTICKERNEL_H
+#define HEURISTICKERNEL_H
+
+#include <cmath>
+#include <cstddef>
+#include <atomic>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define HEURISTIC_KERNEL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// intrinsics for instruction sets beyond the compiler's baseline
+// need the function to be marked on gcc and clang; MSVC allows
+// them anywhere.
+#if defined(HEURISTIC_KERNEL_X86) && (defined(__GNUC__) || defined(__clang__))
+#define HEURISTIC_KERNEL_AVX2 __attribute__((target("avx2")))
+#else
+#define HEURISTIC_KERNEL_AVX2
+#endif
+
+// -------------------------------------------------------
+// Name:        DistanceMetric
+// Description: What HeuristicKernel computes from the
+//              coordinate differences dx and dy.
+//                EUCLIDEAN  sqrt(dx^2 + dy^2)
+//                OCTILE     max + (sqrt(2) - 1) * min of |dx|, |dy|
+//                MANHATTAN  |dx| + |dy|
+//                SQUARED    dx^2 + dy^2, which is not an admissible
+//                           heuristic but orders nodes by distance
+//                           without the square root.
+// -------------------------------------------------------
+enum DistanceMetric {
+	METRIC_EUCLIDEAN,
+	METRIC_OCTILE,
+	METRIC_MANHATTAN,
+	METRIC_SQUARED
+};
+
+// -------------------------------------------------------
+// Name:        HeuristicKernel
+// Description: Computes the distance from many nodes to one
+//              point in a single call, reading the nodes'
+//              coordinates from separate x[] and y[] arrays
+//              (as CSRGraph keeps them). It uses AVX2 (8 nodes
+//              per step, with gathered loads), SSE2 (4 nodes)
+//              or plain C++, whichever is the best the CPU has;
+//              that is checked once, on the first call. The
+//              levels agree to the last bit unless the compiler
+//              fuses the scalar multiply-adds.
+// -------------------------------------------------------
+class HeuristicKernel {
+public:
+	enum Level {
+		SCALAR,
+		SSE2,
+		AVX2
+	};
+
+private:
+	static std::atomic<int> & chosen() {
+		static std::atomic<int> level(-1);
+		return level;
+	}
+
+	static Level detect();
+
+	template<DistanceMetric Metric>
+	static void scalar( float const *x, float const *y, unsigned int const *nodes, size_t count, float tx, float ty, float *out );
+
+#ifdef HEURISTIC_KERNEL_X86
+	template<DistanceMetric Metric>
+	static __m128 metric4( __m128 dx, __m128 dy );
+
+	template<DistanceMetric Metric>
+	static void sse2( float const *x, float const *y, unsigned int const *nodes, size_t count, float tx, float ty, float *out );
+
+	template<DistanceMetric Metric>
+	HEURISTIC_KERNEL_AVX2 static void avx2( float const *x, float const *y, unsigned int const *nodes, size_t count, float tx, float ty, float *out );
+#endif
+
+public:
+	// the instruction set the kernels use.
+	static Level level() {
+		int current = chosen().load(std::memory_order_relaxed);
+		if(current < 0) {
+			current = detect();
+			chosen().store(current, std::memory_order_relaxed);
+		}
+		return static_cast<Level>(current);
+	}
+
+	// makes the kernels use at most the given level, e.g. to time
+	// them against each other; what the CPU lacks is not used.
+	static void limitLevel( Level limit ) {
+		Level best = detect();
+		chosen().store(limit < best ? limit : best, std::memory_order_relaxed);
+	}
+
+	static char const * levelName( Level level ) {
+		return level == AVX2 ? "avx2" : level == SSE2 ? "sse2" : "scalar";
+	}
+
+	// one distance, in plain C++, for callers that need just one.
+	template<DistanceMetric Metric>
+	static float distance( float dx, float dy );
+
+	template<DistanceMetric Metric>
+	static void distances( float const *x, float const *y, unsigned int const *nodes, size_t count, float tx, float ty, float *out );
+
+	static void distances( DistanceMetric metric, float const *x, float const *y, unsigned int const *nodes, size_t count, float tx, float ty, float *out );
+};
+
+// ----------------------------------------------------------------
+//  Name:           detect
+//  Description:    Asks the CPU, and for AVX2 the OS, which
+//                  instruction sets can be used.
+//  Arguments:      None.
+//  Return Value:   The best level available.
+// ----------------------------------------------------------------
+inline HeuristicKernel::Level HeuristicKernel::detect() {
+#if defined(HEURISTIC_KERNEL_X86) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+	__cpuid(info, 1);
+	bool sse2 = (info[3] & (1 << 26)) != 0;
+	// AVX state must be saved by the OS as well as known to the CPU.
+	bool osAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+	bool avx2 = false;
+	if(osAvx && maxLeaf >= 7) {
+		__cpuidex(info, 7, 0);
+		avx2 = (info[1] & (1 << 5)) != 0;
+	}
+	return avx2 ? AVX2 : sse2 ? SSE2 : SCALAR;
+#elif defined(HEURISTIC_KERNEL_X86)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") ? AVX2 : __builtin_cpu_supports("sse2") ? SSE2 : SCALAR;
+#else
+	return SCALAR;
+#endif
+}
+
+template<DistanceMetric Metric>
+inline float HeuristicKernel::distance( float dx, float dy ) {
+	float ax = std::fabs(dx), ay = std::fabs(dy);
+	switch(Metric) {
+	case METRIC_EUCLIDEAN:
+		return std::sqrt(dx * dx + dy * dy);
+	case METRIC_OCTILE:
+		return ax > ay ? ax + 0.41421356f * ay : ay + 0.41421356f * ax;
+	case METRIC_MANHATTAN:
+		return ax + ay;
+	default:
+		return dx * dx + dy * dy;
+	}
+}
+
+template<DistanceMetric Metric>
+inline void HeuristicKernel::scalar( float const *x, float const *y, unsigned int const *nodes, size_t count, float tx, float ty, float *out ) {
+	for(size_t i = 0; i != count; i++) {
+		out[i] = distance<Metric>(tx - x[nodes[i]], ty - y[nodes[i]]);
+	}
+}
+
+#ifdef HEURISTIC_KERNEL_X86
+template<DistanceMetric Metric>
+inline __m128 HeuristicKernel::metric4( __m128 dx, __m128 dy ) {
+	// clearing the sign bit is the absolute value
+	__m128 sign = _mm_set1_ps(-0.0f);
+	__m128 ax = _mm_andnot_ps(sign, dx), ay = _mm_andnot_ps(sign, dy);
+	switch(Metric) {
+	case METRIC_EUCLIDEAN:
+		return _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+	case METRIC_OCTILE:
+		return _mm_add_ps(_mm_max_ps(ax, ay), _mm_mul_ps(_mm_set1_ps(0.41421356f), _mm_min_ps(ax, ay)));
+	case METRIC_MANHATTAN:
+		return _mm_add_ps(ax, ay);
+	default:
+		return _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+	}
+}
+
+template<DistanceMetric Metric>
+inline void HeuristicKernel::sse2( float const *x, float const *y, unsigned int const *nodes, size_t count, float tx, float ty, float *out ) {
+	__m128 px = _mm_set1_ps(tx), py = _mm_set1_ps(ty);
+	size_t i = 0;
+	for( ; i + 4 <= count; i += 4) {
+		// SSE has no gather; the loads are scalar, the arithmetic is not.
+		__m128 nx = _mm_setr_ps(x[nodes[i]], x[nodes[i + 1]], x[nodes[i + 2]], x[nodes[i + 3]]);
+		__m128 ny = _mm_setr_ps(y[nodes[i]], y[nodes[i + 1]], y[nodes[i + 2]], y[nodes[i + 3]]);
+		_mm_storeu_ps(out + i, metric4<Metric>(_mm_sub_ps(px, nx), _mm_sub_ps(py, ny)));
+	}
+	scalar<Metric>(x, y, nodes + i, count - i, tx, ty, out + i);
+}
+
+template<DistanceMetric Metric>
+HEURISTIC_KERNEL_AVX2 inline void HeuristicKernel::avx2( float const *x, float const *y, unsigned int const *nodes, size_t count, float tx, float ty, float *out ) {
+	__m256 px = _mm256_set1_ps(tx), py = _mm256_set1_ps(ty);
+	__m256 sign = _mm256_set1_ps(-0.0f);
+	size_t i = 0;
+	for( ; i + 8 <= count; i += 8) {
+		__m256i index = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(nodes + i));
+		__m256 dx = _mm256_sub_ps(px, _mm256_i32gather_ps(x, index, 4));
+		__m256 dy = _mm256_sub_ps(py, _mm256_i32gather_ps(y, index, 4));
+		__m256 ax = _mm256_andnot_ps(sign, dx), ay = _mm256_andnot_ps(sign, dy);
+		__m256 result;
+		switch(Metric) {
+		case METRIC_EUCLIDEAN:
+			result = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+			break;
+		case METRIC_OCTILE:
+			result = _mm256_add_ps(_mm256_max_ps(ax, ay), _mm256_mul_ps(_mm256_set1_ps(0.41421356f), _mm256_min_ps(ax, ay)));
+			break;
+		case METRIC_MANHATTAN:
+			result = _mm256_add_ps(ax, ay);
+			break;
+		default:
+			result = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+			break;
+		}
+		_mm256_storeu_ps(out + i, result);
+	}
+	// the last few nodes, four at a time if there are enough
+	if(i + 4 <= count) {
+		__m128 nx = _mm_setr_ps(x[nodes[i]], x[nodes[i + 1]], x[nodes[i + 2]], x[nodes[i + 3]]);
+		__m128 ny = _mm_setr_ps(y[nodes[i]], y[nodes[i + 1]], y[nodes[i + 2]], y[nodes[i + 3]]);
+		_mm_storeu_ps(out + i, metric4<Metric>(_mm_sub_ps(_mm256_castps256_ps128(px), nx), _mm_sub_ps(_mm256_castps256_ps128(py), ny)));
+		i += 4;
+	}
+	scalar<Metric>(x, y, nodes + i, count - i, tx, ty, out + i);
+}
+#endif
+
+// ----------------------------------------------------------------
+//  Name:           distances
+//  Description:    The distance from each of the given nodes to a
+//                  point, under a metric.
+//  Arguments:      The x and y coordinate arrays, the ids of the
+//                  nodes (indices into x and y, below 2^31) and how
+//                  many there are, the point, and where to write
+//                  the count distances.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<DistanceMetric Metric>
+inline void HeuristicKernel::distances( float const *x, float const *y, unsigned int const *nodes, size_t count, float tx, float ty, float *out ) {
+#ifdef HEURISTIC_KERNEL_X86
+	switch(level()) {
+	case AVX2:
+		avx2<Metric>(x, y, nodes, count, tx, ty, out);
+		return;
+	case SSE2:
+		sse2<Metric>(x, y, nodes, count, tx, ty, out);
+		return;
+	default:
+		break;
+	}
+#endif
+	scalar<Metric>(x, y, nodes, count, tx, ty, out);
+}
+
+inline void HeuristicKernel::distances( DistanceMetric metric, float const *x, float const *y, unsigned int const *nodes, size_t count, float tx, float ty, float *out ) {
+	switch(metric) {
+	case METRIC_EUCLIDEAN:
+		distances<METRIC_EUCLIDEAN>(x, y, nodes, count, tx, ty, out);
+		break;
+	case METRIC_OCTILE:
+		distances<METRIC_OCTILE>(x, y, nodes, count, tx, ty, out);
+		break;
+	case METRIC_MANHATTAN:
+		distances<METRIC_MANHATTAN>(x, y, nodes, count, tx, ty, out);
+		break;
+	default:
+		distances<METRIC_SQUARED>(x, y, nodes, count, tx, ty, out);
+		break;
+	}
+}
+
+#endif
@@ -0,0 +1,253 @@
+#ifndef INDEXEDPRIORITYQUEUE_H
+#define INDEXEDPRIORITYQUEUE_H
+
+#include <vector>
+#include <functional>
+
+// -------------------------------------------------------
+// Name:        IndexedPriorityQueue
+// Description: A d-ary min-heap of integer ids in the range
+//              [0, capacity). Every id remembers where it sits
+//              in the heap, so the key of a queued id can be
+//              lowered in place in O(log n) rather than pushing
+//              a duplicate or re-sorting the whole open set.
+//              A 4-ary heap is the default: it is shallower
+//              than a binary heap and its children share a
+//              cache line.
+// -------------------------------------------------------
+template<class KeyType, int Arity = 4, class Compare = std::less<KeyType> >
+class IndexedPriorityQueue {
+private:
+// -------------------------------------------------------
+// Description: the queued ids, in heap order.
+// -------------------------------------------------------
+	std::vector<int> m_heap;
+
+// -------------------------------------------------------
+// Description: the key of each id, indexed by id.
+// -------------------------------------------------------
+	std::vector<KeyType> m_keys;
+
+// -------------------------------------------------------
+// Description: the heap slot of each id, or -1 if the id
+//              is not queued.
+// -------------------------------------------------------
+	std::vector<int> m_position;
+
+	Compare m_compare;
+
+	void siftUp( int slot );
+	void siftDown( int slot );
+
+	void place( int slot, int id ) {
+		m_heap[slot] = id;
+		m_position[id] = slot;
+	}
+
+public:
+	IndexedPriorityQueue( int capacity = 0 ) {
+		reserve(capacity);
+	}
+
+	// Accessor functions
+	bool empty() const {
+		return m_heap.empty();
+	}
+
+	int size() const {
+		return static_cast<int>(m_heap.size());
+	}
+
+	int capacity() const {
+		return static_cast<int>(m_position.size());
+	}
+
+	bool contains( int id ) const {
+		return m_position[id] != -1;
+	}
+
+	int top() const {
+		return m_heap.front();
+	}
+
+	KeyType const & topKey() const {
+		return m_keys[m_heap.front()];
+	}
+
+	KeyType const & key( int id ) const {
+		return m_keys[id];
+	}
+
+	// Manipulator functions
+	void reserve( int capacity );
+	void push( int id, KeyType key );
+	void pop();
+	void decreaseKey( int id, KeyType key );
+	void changeKey( int id, KeyType key );
+	void remove( int id );
+	void clear();
+};
+
+// ----------------------------------------------------------------
+//  Name:           reserve
+//  Description:    Makes room for ids up to capacity - 1. Ids that
+//                  are already queued are left where they are.
+//  Arguments:      The number of distinct ids the queue must hold.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class KeyType, int Arity, class Compare>
+void IndexedPriorityQueue<KeyType, Arity, Compare>::reserve( int capacity ) {
+	if( capacity > static_cast<int>(m_position.size()) ) {
+		m_position.resize(capacity, -1);
+		m_keys.resize(capacity);
+		m_heap.reserve(capacity);
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           push
+//  Description:    Queues an id that is not already in the queue.
+//  Arguments:      The id and its key.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class KeyType, int Arity, class Compare>
+void IndexedPriorityQueue<KeyType, Arity, Compare>::push( int id, KeyType key ) {
+	m_keys[id] = key;
+	m_heap.push_back(id);
+	m_position[id] = static_cast<int>(m_heap.size()) - 1;
+	siftUp(m_position[id]);
+}
+
+// ----------------------------------------------------------------
+//  Name:           pop
+//  Description:    Removes the id with the smallest key.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class KeyType, int Arity, class Compare>
+void IndexedPriorityQueue<KeyType, Arity, Compare>::pop() {
+	int last = m_heap.back();
+	m_position[m_heap.front()] = -1;
+	m_heap.pop_back();
+
+	if( !m_heap.empty() ) {
+		place(0, last);
+		siftDown(0);
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           decreaseKey
+//  Description:    Lowers the key of a queued id and moves it
+//                  towards the top of the heap.
+//  Arguments:      The id and its new (smaller or equal) key.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class KeyType, int Arity, class Compare>
+void IndexedPriorityQueue<KeyType, Arity, Compare>::decreaseKey( int id, KeyType key ) {
+	m_keys[id] = key;
+	siftUp(m_position[id]);
+}
+
+// ----------------------------------------------------------------
+//  Name:           changeKey
+//  Description:    Sets the key of a queued id to any value and
+//                  moves it up or down to match.
+//  Arguments:      The id and its new key.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class KeyType, int Arity, class Compare>
+void IndexedPriorityQueue<KeyType, Arity, Compare>::changeKey( int id, KeyType key ) {
+	bool lower = m_compare(key, m_keys[id]);
+	m_keys[id] = key;
+	if( lower ) {
+		siftUp(m_position[id]);
+	}
+	else {
+		siftDown(m_position[id]);
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           remove
+//  Description:    Takes a queued id out of the queue, wherever it
+//                  is in the heap.
+//  Arguments:      The id.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class KeyType, int Arity, class Compare>
+void IndexedPriorityQueue<KeyType, Arity, Compare>::remove( int id ) {
+	int slot = m_position[id];
+	int last = m_heap.back();
+	m_position[id] = -1;
+	m_heap.pop_back();
+
+	if( slot != static_cast<int>(m_heap.size()) ) {
+		// the last id fills the hole, and may belong above or below it.
+		place(slot, last);
+		siftUp(slot);
+		siftDown(m_position[last]);
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           clear
+//  Description:    Empties the queue. Only the ids still queued are
+//                  touched, so this costs O(size) not O(capacity).
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class KeyType, int Arity, class Compare>
+void IndexedPriorityQueue<KeyType, Arity, Compare>::clear() {
+	for( int slot = 0; slot != size(); slot++ ) {
+		m_position[m_heap[slot]] = -1;
+	}
+	m_heap.clear();
+}
+
+template<class KeyType, int Arity, class Compare>
+void IndexedPriorityQueue<KeyType, Arity, Compare>::siftUp( int slot ) {
+	int id = m_heap[slot];
+
+	// move parents down until the id's key is no longer smaller
+	while( slot > 0 ) {
+		int parent = (slot - 1) / Arity;
+		if( !m_compare(m_keys[id], m_keys[m_heap[parent]]) ) {
+			break;
+		}
+		place(slot, m_heap[parent]);
+		slot = parent;
+	}
+	place(slot, id);
+}
+
+template<class KeyType, int Arity, class Compare>
+void IndexedPriorityQueue<KeyType, Arity, Compare>::siftDown( int slot ) {
+	int id = m_heap[slot];
+	int count = size();
+
+	// move the smallest child up until the id's key is no larger
+	for( ;; ) {
+		int first = slot * Arity + 1;
+		if( first >= count ) {
+			break;
+		}
+
+		int best = first;
+		int last = first + Arity < count ? first + Arity : count;
+		for( int child = first + 1; child < last; child++ ) {
+			if( m_compare(m_keys[m_heap[child]], m_keys[m_heap[best]]) ) {
+				best = child;
+			}
+		}
+
+		if( !m_compare(m_keys[m_heap[best]], m_keys[id]) ) {
+			break;
+		}
+		place(slot, m_heap[best]);
+		slot = best;
+	}
+	place(slot, id);
+}
+
+#endif
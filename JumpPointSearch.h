@@ -0,0 +1,262 @@
+#ifndef JUMPPOINTSEARCH_H
+#define JUMPPOINTSEARCH_H
+
+#include <vector>
+#include <cstdlib>
+
+#include "GridMap.h"
+#include "SearchContext.h"
+
+// -------------------------------------------------------
+// Name:        JumpPointSearch
+// Description: Jump Point Search over a GridMap. On a
+//              uniform-cost grid most shortest paths have many
+//              equally good variants, and plain A* expands
+//              every cell on all of them. JPS expands only the
+//              cells where an optimal path may have to turn
+//              (next to an obstacle corner), by "jumping" in a
+//              straight line past everything in between, so it
+//              typically expands orders of magnitude fewer
+//              cells while returning a path of the same cost.
+//
+//              Straight steps cost `straight` and diagonal
+//              steps `diagonal`; the octile distance is the
+//              heuristic. A JumpPointSearch owns its context,
+//              so give each thread its own.
+// -------------------------------------------------------
+template<class ArcType>
+class JumpPointSearch {
+private:
+	GridMap const & m_map;
+	ArcType m_straight;
+	ArcType m_diagonal;
+	SearchContext<ArcType> m_context;
+	int m_goal;
+
+	ArcType octile( int from, int to ) const {
+		int dx = std::abs(m_map.x(to) - m_map.x(from));
+		int dy = std::abs(m_map.y(to) - m_map.y(from));
+		return dx < dy ? m_diagonal * dx + m_straight * (dy - dx) : m_diagonal * dy + m_straight * (dx - dy);
+	}
+
+	bool walkable( int x, int y ) const {
+		return m_map.walkable(x, y);
+	}
+
+	int jumpStraight( int x, int y, int dx, int dy ) const;
+	int jumpDiagonal( int x, int y, int dx, int dy ) const;
+	void jump( int x, int y, int dx, int dy, int parent );
+
+public:
+	// The defaults are 10 and 14, an integral approximation of 1 and
+	// sqrt(2).
+	JumpPointSearch( GridMap const &map, ArcType straight = 10, ArcType diagonal = 14 )
+		: m_map( map ), m_straight( straight ), m_diagonal( diagonal ), m_goal( -1 ) {
+	}
+
+	ArcType search( int start, int dest, std::vector<int> &path );
+
+	// The state of the last search: its expansions, and the jump
+	// points it reached.
+	SearchContext<ArcType> const & context() const {
+		return m_context;
+	}
+};
+
+// ----------------------------------------------------------------
+//  Name:           search
+//  Description:    A* over jump points. Each expanded cell only
+//                  looks along the directions an optimal path from
+//                  its parent could continue in, and each of those
+//                  is followed until it reaches the goal, a dead end
+//                  or a jump point.
+//  Arguments:      The start cell id, the destination cell id and
+//                  the vector to write the path into, destination
+//                  first and with every cell along it.
+//  Return Value:   The cost of the path, or infinity() if dest
+//                  cannot be reached (the path is then left empty).
+// ----------------------------------------------------------------
+template<class ArcType>
+ArcType JumpPointSearch<ArcType>::search( int start, int dest, std::vector<int> &path ) {
+	m_context.reset(m_map.width() * m_map.height());
+	if(!walkable(m_map.x(start), m_map.y(start)) || !walkable(m_map.x(dest), m_map.y(dest))) {
+		return SearchContext<ArcType>::infinity();
+	}
+
+	m_goal = dest;
+	IndexedPriorityQueue<ArcType> &pq = m_context.open();
+	m_context.setCost(start, 0, -1);
+	pq.push(start, octile(start, dest));
+
+	while(!pq.empty() && pq.top() != dest) {
+		int top = pq.top();
+		pq.pop();
+		m_context.countExpansion();
+
+		int x = m_map.x(top), y = m_map.y(top);
+		int parent = m_context.previous(top);
+
+		if(parent == -1) {
+			// the start looks everywhere.
+			for(int dy = -1; dy <= 1; dy++) {
+				for(int dx = -1; dx <= 1; dx++) {
+					if((dx != 0 || dy != 0) && (dx == 0 || dy == 0 || (walkable(x + dx, y) && walkable(x, y + dy)))) {
+						jump(x + dx, y + dy, dx, dy, top);
+					}
+				}
+			}
+			continue;
+		}
+
+		int px = m_map.x(parent), py = m_map.y(parent);
+		int dx = x > px ? 1 : (x < px ? -1 : 0);
+		int dy = y > py ? 1 : (y < py ? -1 : 0);
+
+		if(dx != 0 && dy != 0) {
+			// carry on diagonally, or along either of its two parts.
+			bool horizontal = walkable(x + dx, y);
+			bool vertical = walkable(x, y + dy);
+			if(vertical) {
+				jump(x, y + dy, 0, dy, top);
+			}
+			if(horizontal) {
+				jump(x + dx, y, dx, 0, top);
+			}
+			if(horizontal && vertical) {
+				jump(x + dx, y + dy, dx, dy, top);
+			}
+		}
+		else {
+			// carry on straight, or turn round an obstacle that forced
+			// this jump point; (sx, sy) is one step to the side.
+			int sx = dy, sy = dx;
+			bool ahead = walkable(x + dx, y + dy);
+			bool left = walkable(x + sx, y + sy);
+			bool right = walkable(x - sx, y - sy);
+			if(ahead) {
+				jump(x + dx, y + dy, dx, dy, top);
+				if(left) {
+					jump(x + dx + sx, y + dy + sy, dx + sx, dy + sy, top);
+				}
+				if(right) {
+					jump(x + dx - sx, y + dy - sy, dx - sx, dy - sy, top);
+				}
+			}
+			if(left) {
+				jump(x + sx, y + sy, sx, sy, top);
+			}
+			if(right) {
+				jump(x - sx, y - sy, -sx, -sy, top);
+			}
+		}
+	}
+
+	if(!m_context.reached(dest)) {
+		return SearchContext<ArcType>::infinity();
+	}
+
+	// fill in the cells between consecutive jump points.
+	for(int node = dest; node != start; node = m_context.previous(node)) {
+		int parent = m_context.previous(node);
+		int x = m_map.x(node), y = m_map.y(node);
+		int px = m_map.x(parent), py = m_map.y(parent);
+		int dx = px > x ? 1 : (px < x ? -1 : 0);
+		int dy = py > y ? 1 : (py < y ? -1 : 0);
+
+		while(x != px || y != py) {
+			path.push_back(m_map.id(x, y));
+			if(x != px) {
+				x += dx;
+			}
+			if(y != py) {
+				y += dy;
+			}
+		}
+	}
+	path.push_back(start);
+	return m_context.cost(dest);
+}
+
+// ----------------------------------------------------------------
+//  Name:           jump
+//  Description:    Follows one direction from a cell and queues the
+//                  jump point it finds, if any.
+//  Arguments:      The first cell in that direction, the direction
+//                  and the cell being expanded.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType>
+void JumpPointSearch<ArcType>::jump( int x, int y, int dx, int dy, int parent ) {
+	int found = dx != 0 && dy != 0 ? jumpDiagonal(x, y, dx, dy) : jumpStraight(x, y, dx, dy);
+	if(found == -1) {
+		return;
+	}
+
+	ArcType gC = m_context.cost(parent) + octile(parent, found);
+	if(gC < m_context.cost(found)) {
+		ArcType fC = gC + octile(found, m_goal);
+		m_context.setCost(found, gC, parent);
+		m_context.setEstimate(found, fC);
+
+		IndexedPriorityQueue<ArcType> &pq = m_context.open();
+		if(pq.contains(found)) {
+			pq.decreaseKey(found, fC);
+		}
+		else {
+			pq.push(found, fC);
+		}
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           jumpStraight
+//  Description:    Walks in a straight line until the goal, a wall,
+//                  or a cell with an opening to the side that was
+//                  closed one step back (a path may need to turn
+//                  there, so it is a jump point).
+//  Arguments:      The first cell and the direction.
+//  Return Value:   The id of the jump point, or -1 if there is none.
+// ----------------------------------------------------------------
+template<class ArcType>
+int JumpPointSearch<ArcType>::jumpStraight( int x, int y, int dx, int dy ) const {
+	int sx = dy, sy = dx;
+
+	for( ; walkable(x, y); x += dx, y += dy) {
+		int cell = m_map.id(x, y);
+		if(cell == m_goal) {
+			return cell;
+		}
+		if((walkable(x + sx, y + sy) && !walkable(x - dx + sx, y - dy + sy))
+			|| (walkable(x - sx, y - sy) && !walkable(x - dx - sx, y - dy - sy))) {
+			return cell;
+		}
+	}
+	return -1;
+}
+
+// ----------------------------------------------------------------
+//  Name:           jumpDiagonal
+//  Description:    Walks diagonally until the goal, a blocked step,
+//                  or a cell from which one of the two straight
+//                  directions reaches a jump point.
+//  Arguments:      The first cell and the direction.
+//  Return Value:   The id of the jump point, or -1 if there is none.
+// ----------------------------------------------------------------
+template<class ArcType>
+int JumpPointSearch<ArcType>::jumpDiagonal( int x, int y, int dx, int dy ) const {
+	for( ; walkable(x, y); x += dx, y += dy) {
+		int cell = m_map.id(x, y);
+		if(cell == m_goal) {
+			return cell;
+		}
+		if(jumpStraight(x + dx, y, dx, 0) != -1 || jumpStraight(x, y + dy, 0, dy) != -1) {
+			return cell;
+		}
+		if(!walkable(x + dx, y) || !walkable(x, y + dy)) {
+			return -1;
+		}
+	}
+	return -1;
+}
+
+#endif
@@ -0,0 +1,398 @@
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+
+#include <vector>
+#include <cmath>
+
+#include "CSRGraph.h"
+#include "SearchContext.h"
+#include "ThreadPool.h"
+
+// -------------------------------------------------------
+// Name:        Landmarks
+// Description: The ALT heuristic: A*, landmarks and the
+//              triangle inequality. For a few landmark nodes L
+//              the exact distances d(L, v) and d(v, L) to and
+//              from every node are stored, and since
+//
+//                d(v, t) >= d(v, L) - d(t, L)
+//                d(v, t) >= d(L, t) - d(L, v)
+//
+//              the largest of these over all landmarks is an
+//              admissible estimate. Unlike the euclidean
+//              heuristic_eval it does not assume that arc
+//              weights follow the node positions, and it is
+//              usually much tighter.
+//
+//              Landmarks are picked by farthest-point
+//              selection, so they end up spread around the
+//              edge of the graph, and the distance tables are
+//              filled by Dijkstra runs on a ThreadPool. Nodes no
+//              landmark reaches are never picked, so the
+//              landmarks stay in the largest connected
+//              component rather than on isolated nodes (blocked
+//              grid cells, say); a smaller component only gets
+//              one once every node reached so far is a landmark.
+//
+//              The tables cost 2 * k values per node. With
+//              QUANTIZED storage each value is 16 bits: the
+//              distance divided by a scale and rounded down.
+//              The estimate then allows for the rounding, so it
+//              stays admissible, just a little looser.
+// -------------------------------------------------------
+template<class ArcType>
+class Landmarks {
+public:
+	typedef typename CSRGraph<ArcType>::NodeId NodeId;
+
+	enum Storage {
+		FULL,
+		QUANTIZED
+	};
+
+private:
+// -------------------------------------------------------
+// Description: the quantized value of an unreachable pair.
+// -------------------------------------------------------
+	static const unsigned short kUnreachable = 0xFFFF;
+
+	std::vector<NodeId> m_landmarks;
+	Storage m_storage;
+
+// -------------------------------------------------------
+// Description: d(L, v) and d(v, L) for landmark i at
+//              [v * k + i], so the k values a lookup needs
+//              share a cache line. Only one pair is used,
+//              depending on the storage.
+// -------------------------------------------------------
+	std::vector<ArcType> m_from;
+	std::vector<ArcType> m_to;
+	std::vector<unsigned short> m_quantizedFrom;
+	std::vector<unsigned short> m_quantizedTo;
+
+// -------------------------------------------------------
+// Description: the distance one quantized step stands for.
+// -------------------------------------------------------
+	double m_scale;
+
+	static void distances( CSRGraph<ArcType> const &graph, SearchContext<ArcType> &context, NodeId source, std::vector<ArcType> &out );
+	static NodeId farthest( std::vector<ArcType> const &nearest );
+	static void components( CSRGraph<ArcType> const &graph, std::vector<NodeId> &root, std::vector<NodeId> &size );
+	void store( std::vector<ArcType> const &table, int landmark, std::vector<ArcType> &full, std::vector<unsigned short> &quantized ) const;
+
+	// a lower bound on a - b from two table entries.
+	ArcType bound( ArcType a, ArcType b ) const {
+		return a != SearchContext<ArcType>::infinity() && b != SearchContext<ArcType>::infinity() && a > b ? a - b : 0;
+	}
+
+	ArcType bound( unsigned short a, unsigned short b ) const {
+		if(a == kUnreachable || b == kUnreachable || a <= b + 1) {
+			return 0;
+		}
+		// a stands for [a, a + 1) steps and b for [b, b + 1).
+		return static_cast<ArcType>(std::floor((a - b - 1) * m_scale));
+	}
+
+public:
+	Landmarks( CSRGraph<ArcType> const &graph, int count, Storage storage = FULL, int threads = 0 );
+
+	// Accessor functions
+	int count() const {
+		return static_cast<int>(m_landmarks.size());
+	}
+
+	NodeId landmark( int i ) const {
+		return m_landmarks[i];
+	}
+
+	Storage storage() const {
+		return m_storage;
+	}
+
+	size_t memoryUsage() const {
+		return m_landmarks.capacity() * sizeof(NodeId) + (m_from.capacity() + m_to.capacity()) * sizeof(ArcType)
+			+ (m_quantizedFrom.capacity() + m_quantizedTo.capacity()) * sizeof(unsigned short);
+	}
+
+	ArcType operator()( NodeId node, NodeId dest ) const;
+};
+
+// ----------------------------------------------------------------
+//  Name:           Landmarks
+//  Description:    Picks the landmarks and fills the tables. Each
+//                  landmark is the reachable node farthest from all
+//                  the ones picked so far (the first is the node
+//                  farthest from a node of the largest component),
+//                  which needs the runs from the landmarks one after
+//                  another; the runs to them, on the transposed
+//                  graph, are then done in parallel.
+//  Arguments:      The graph, frozen, how many landmarks to use,
+//                  how to store the tables and the number of worker
+//                  threads (0 means one per hardware thread).
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType>
+Landmarks<ArcType>::Landmarks( CSRGraph<ArcType> const &graph, int count, Storage storage, int threads )
+	: m_storage( storage ), m_scale( 1.0 ) {
+	NodeId nodes = graph.nodeCount();
+	if(nodes == 0 || count <= 0) {
+		return;
+	}
+	if(static_cast<NodeId>(count) > nodes) {
+		count = static_cast<int>(nodes);
+	}
+
+	SearchContext<ArcType> context(nodes);
+	std::vector<std::vector<ArcType> > from(count), to(count);
+
+	std::vector<NodeId> root, size;
+	components(graph, root, size);
+	std::vector<bool> covered(nodes, false);
+
+	// nearest[v] is v's distance from the closest landmark so far,
+	// infinity() if none of them reaches it.
+	std::vector<ArcType> nearest(nodes, SearchContext<ArcType>::infinity());
+	std::vector<ArcType> seed;
+
+	for(int i = 0; i != count; i++) {
+		NodeId next = farthest(nearest);
+		if(next == nodes) {
+			// every node reached so far is a landmark: start on the
+			// largest component that has none, from the node farthest
+			// from its root (its lowest-numbered node).
+			NodeId start = nodes;
+			for(NodeId node = 0; node != nodes; node++) {
+				if(root[node] == node && !covered[node] && (start == nodes || size[node] > size[start])) {
+					start = node;
+				}
+			}
+			if(start == nodes) {
+				// no node is left that a landmark would help.
+				from.resize(i);
+				to.resize(i);
+				count = i;
+				break;
+			}
+
+			distances(graph, context, start, seed);
+			next = farthest(seed);
+			if(next == nodes) {
+				next = start;
+			}
+		}
+		m_landmarks.push_back(next);
+		covered[root[next]] = true;
+
+		distances(graph, context, next, from[i]);
+		for(NodeId node = 0; node != nodes; node++) {
+			if(from[i][node] < nearest[node]) {
+				nearest[node] = from[i][node];
+			}
+		}
+	}
+
+	CSRGraph<ArcType> reverse = graph.transpose();
+	ThreadPool pool(threads < count ? threads : count);
+	std::vector<SearchContext<ArcType> > contexts(pool.workerCount());
+	std::vector<NodeId> const &landmarks = m_landmarks;
+
+	pool.parallelFor(count, 1, [&](int worker, size_t begin, size_t end) {
+		for(size_t i = begin; i != end; i++) {
+			distances(reverse, contexts[worker], landmarks[i], to[i]);
+		}
+	});
+
+	if(m_storage == QUANTIZED) {
+		// one step is the longest finite distance over 65534 steps.
+		ArcType longest = 0;
+		for(int i = 0; i != count; i++) {
+			for(NodeId node = 0; node != nodes; node++) {
+				if(from[i][node] != SearchContext<ArcType>::infinity() && from[i][node] > longest) {
+					longest = from[i][node];
+				}
+				if(to[i][node] != SearchContext<ArcType>::infinity() && to[i][node] > longest) {
+					longest = to[i][node];
+				}
+			}
+		}
+		m_scale = longest > 0 ? static_cast<double>(longest) / (kUnreachable - 1) : 1.0;
+		m_quantizedFrom.resize(static_cast<size_t>(nodes) * count);
+		m_quantizedTo.resize(static_cast<size_t>(nodes) * count);
+	}
+	else {
+		m_from.resize(static_cast<size_t>(nodes) * count);
+		m_to.resize(static_cast<size_t>(nodes) * count);
+	}
+
+	for(int i = 0; i != count; i++) {
+		store(from[i], i, m_from, m_quantizedFrom);
+		store(to[i], i, m_to, m_quantizedTo);
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           operator()
+//  Description:    The ALT estimate, for passing to aStar.
+//  Arguments:      The node and the destination.
+//  Return Value:   A lower bound on the cost from node to dest.
+// ----------------------------------------------------------------
+template<class ArcType>
+ArcType Landmarks<ArcType>::operator()( NodeId node, NodeId dest ) const {
+	size_t k = m_landmarks.size();
+	size_t v = node * k, t = dest * k;
+	ArcType best = 0;
+
+	for(size_t i = 0; i != k; i++) {
+		ArcType toBound, fromBound;
+		if(m_storage == QUANTIZED) {
+			toBound = bound(m_quantizedTo[v + i], m_quantizedTo[t + i]);
+			fromBound = bound(m_quantizedFrom[t + i], m_quantizedFrom[v + i]);
+		}
+		else {
+			toBound = bound(m_to[v + i], m_to[t + i]);
+			fromBound = bound(m_from[t + i], m_from[v + i]);
+		}
+
+		if(toBound > best) {
+			best = toBound;
+		}
+		if(fromBound > best) {
+			best = fromBound;
+		}
+	}
+	return best;
+}
+
+// ----------------------------------------------------------------
+//  Name:           farthest
+//  Description:    Finds the next landmark for farthest-point
+//                  selection.
+//  Arguments:      Each node's distance from the nearest landmark.
+//  Return Value:   The node with the largest finite, nonzero
+//                  distance, or nearest.size() if there is none.
+// ----------------------------------------------------------------
+template<class ArcType>
+typename Landmarks<ArcType>::NodeId Landmarks<ArcType>::farthest( std::vector<ArcType> const &nearest ) {
+	NodeId nodes = static_cast<NodeId>(nearest.size());
+	NodeId best = nodes;
+	for(NodeId node = 0; node != nodes; node++) {
+		if(nearest[node] != SearchContext<ArcType>::infinity() && nearest[node] > 0
+			&& (best == nodes || nearest[node] > nearest[best])) {
+			best = node;
+		}
+	}
+	return best;
+}
+
+// ----------------------------------------------------------------
+//  Name:           components
+//  Description:    Splits the graph into weakly connected
+//                  components (arc directions ignored) with a
+//                  union-find.
+//  Arguments:      The graph and the vectors to write each node's
+//                  component root (the component's lowest-numbered
+//                  node) and, at each root, the component's size
+//                  into.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType>
+void Landmarks<ArcType>::components( CSRGraph<ArcType> const &graph, std::vector<NodeId> &root, std::vector<NodeId> &size ) {
+	NodeId nodes = graph.nodeCount();
+	root.resize(nodes);
+	for(NodeId node = 0; node != nodes; node++) {
+		root[node] = node;
+	}
+
+	for(NodeId node = 0; node != nodes; node++) {
+		for(NodeId arc = graph.arcBegin(node); arc != graph.arcEnd(node); arc++) {
+			NodeId a = node, b = graph.target(arc);
+			// find both roots, halving the paths on the way.
+			while(root[a] != a) {
+				a = root[a] = root[root[a]];
+			}
+			while(root[b] != b) {
+				b = root[b] = root[root[b]];
+			}
+			if(a != b) {
+				root[a < b ? b : a] = a < b ? a : b;
+			}
+		}
+	}
+
+	size.assign(nodes, 0);
+	for(NodeId node = 0; node != nodes; node++) {
+		NodeId r = node;
+		while(root[r] != r) {
+			r = root[r];
+		}
+		root[node] = r;
+		size[r]++;
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           distances
+//  Description:    Dijkstra from one node to every node.
+//  Arguments:      The graph, a context, the source and the vector to
+//                  write the distances into (infinity() where there
+//                  is no path).
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType>
+void Landmarks<ArcType>::distances( CSRGraph<ArcType> const &graph, SearchContext<ArcType> &context, NodeId source, std::vector<ArcType> &out ) {
+	context.reset(graph.nodeCount());
+	IndexedPriorityQueue<ArcType> &pq = context.open();
+
+	context.setCost(source, 0, -1);
+	pq.push(source, 0);
+
+	while(!pq.empty()) {
+		NodeId top = pq.top();
+		pq.pop();
+
+		for(NodeId arc = graph.arcBegin(top); arc != graph.arcEnd(top); arc++) {
+			NodeId child = graph.target(arc);
+			ArcType distC = context.cost(top) + graph.weight(arc);
+
+			if(distC < context.cost(child)) {
+				context.setCost(child, distC, top);
+				if(pq.contains(child)) {
+					pq.decreaseKey(child, distC);
+				}
+				else {
+					pq.push(child, distC);
+				}
+			}
+		}
+	}
+
+	out.resize(graph.nodeCount());
+	for(NodeId node = 0; node != graph.nodeCount(); node++) {
+		out[node] = context.cost(node);
+	}
+}
+
+template<class ArcType>
+void Landmarks<ArcType>::store( std::vector<ArcType> const &table, int landmark, std::vector<ArcType> &full, std::vector<unsigned short> &quantized ) const {
+	size_t k = m_landmarks.size();
+
+	for(size_t node = 0; node != table.size(); node++) {
+		if(m_storage == QUANTIZED) {
+			unsigned short value = kUnreachable;
+			if(table[node] != SearchContext<ArcType>::infinity()) {
+				double steps = std::floor(table[node] / m_scale);
+				if(steps * m_scale > table[node]) {
+					// rounding must never make a distance look longer.
+					steps -= 1.0;
+				}
+				value = static_cast<unsigned short>(steps < kUnreachable - 1 ? steps : kUnreachable - 1);
+			}
+			quantized[node * k + landmark] = value;
+		}
+		else {
+			full[node * k + landmark] = table[node];
+		}
+	}
+}
+
+#endif
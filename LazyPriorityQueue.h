@@ -0,0 +1,118 @@
+#ifndef LAZYPRIORITYQUEUE_H
+#define LAZYPRIORITYQUEUE_H
+
+#include <vector>
+#include <algorithm>
+
+// -------------------------------------------------------
+// Name:        LazyPriorityQueue
+// Description: An open set with the same interface as
+//              IndexedPriorityQueue, built on a plain binary
+//              heap of (key, id) pairs. Lowering a key pushes
+//              a second pair instead of moving the first; the
+//              stale one is thrown away when it reaches the top.
+//              There is no position table to keep up, so a push
+//              is cheaper, at the price of a larger heap when
+//              keys are lowered often.
+// -------------------------------------------------------
+template<class KeyType>
+class LazyPriorityQueue {
+private:
+	struct Entry {
+		KeyType key;
+		int id;
+
+		// std::push_heap makes a max-heap; this turns it around.
+		bool operator<( Entry const &other ) const {
+			return other.key < key;
+		}
+	};
+
+	std::vector<Entry> m_heap;
+
+// -------------------------------------------------------
+// Description: the live key of each queued id, and the
+//              generation it was queued in; an id is queued
+//              if that is the current one.
+// -------------------------------------------------------
+	std::vector<KeyType> m_keys;
+	std::vector<unsigned int> m_queued;
+	unsigned int m_generation;
+	int m_size;
+
+	// pops pairs whose id has left the queue or has a lower key now.
+	void discardStale() {
+		while(!m_heap.empty() && (m_queued[m_heap.front().id] != m_generation || m_keys[m_heap.front().id] < m_heap.front().key)) {
+			std::pop_heap(m_heap.begin(), m_heap.end());
+			m_heap.pop_back();
+		}
+	}
+
+public:
+	LazyPriorityQueue( int capacity = 0 ) : m_generation( 1 ), m_size( 0 ) {
+		reserve(capacity);
+	}
+
+	// Accessor functions
+	bool empty() const {
+		return m_size == 0;
+	}
+
+	int size() const {
+		return m_size;
+	}
+
+	bool contains( int id ) const {
+		return m_queued[id] == m_generation;
+	}
+
+	int top() const {
+		return m_heap.front().id;
+	}
+
+	KeyType const & key( int id ) const {
+		return m_keys[id];
+	}
+
+	void reserve( int capacity ) {
+		if( capacity > static_cast<int>(m_keys.size()) ) {
+			m_keys.resize(capacity);
+			m_queued.resize(capacity, 0);
+		}
+	}
+
+	void push( int id, KeyType key ) {
+		m_keys[id] = key;
+		m_queued[id] = m_generation;
+		m_size++;
+		Entry entry = { key, id };
+		m_heap.push_back(entry);
+		std::push_heap(m_heap.begin(), m_heap.end());
+	}
+
+	void decreaseKey( int id, KeyType key ) {
+		m_keys[id] = key;
+		Entry entry = { key, id };
+		m_heap.push_back(entry);
+		std::push_heap(m_heap.begin(), m_heap.end());
+	}
+
+	void pop() {
+		m_queued[m_heap.front().id] = 0;
+		m_size--;
+		std::pop_heap(m_heap.begin(), m_heap.end());
+		m_heap.pop_back();
+		discardStale();
+	}
+
+	void clear() {
+		m_heap.clear();
+		m_size = 0;
+		if( ++m_generation == 0 ) {
+			m_queued.assign(m_queued.size(), 0);
+			m_generation = 1;
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,475 @@
+#ifndef PATHCACHE_H
+#define PATHCACHE_H
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+
+#include "Graph.h"
+#include "GraphObserver.h"
+
+// -------------------------------------------------------
+// Name:        PathCache
+// Description: Remembers the paths Graph::aStar and ucs found,
+//              keyed by (start, dest, algorithm), so agents
+//              asking for the same pair again get a copy
+//              instead of a search. Every part of a shortest
+//              path is itself a shortest path, so a query whose
+//              ends both lie, in order, on a cached path is
+//              answered from that path too.
+//
+//              The cache watches the graph (GraphObserver) and
+//              drops just the entries a change can make wrong:
+//              removing or raising an arc drops the paths that
+//              use it; adding or lowering one drops the paths
+//              it is on and those it could shorten, which it
+//              decides with the heuristic: if h(start, from) +
+//              weight + h(to, dest) is not below the cached
+//              cost, the new arc cannot help. The heuristic
+//              must therefore be admissible.
+//
+//              It holds at most about budget bytes, dropping the
+//              least recently used entries to make room. All
+//              members may be called from several threads; the
+//              graph itself must not change while a search on
+//              it is running.
+// -------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic = typename Graph<NodeType, ArcType>::Euclidean>
+class PathCache : public GraphObserver<ArcType> {
+public:
+	typedef Graph<NodeType, ArcType> GraphType;
+	typedef GraphNode<NodeType, ArcType> Node;
+	typedef typename GraphType::Context Context;
+
+	enum Algorithm {
+		UCS,
+		ASTAR
+	};
+
+	struct Stats {
+		// answered by an entry with the same ends
+		size_t hits;
+		// answered by part of a longer entry
+		size_t subpathHits;
+		size_t misses;
+		// entries dropped because the graph changed
+		size_t invalidated;
+		// entries dropped to stay within the budget
+		size_t evicted;
+		size_t entries;
+		// an estimate of the memory the entries use
+		size_t bytes;
+
+		double hitRate() const {
+			size_t queries = hits + subpathHits + misses;
+			return queries == 0 ? 0.0 : static_cast<double>(hits + subpathHits) / queries;
+		}
+	};
+
+private:
+	// start << 33 | dest << 1 | algorithm
+	typedef unsigned long long Key;
+
+	struct Entry {
+		// destination first, as the searches give it
+		std::vector<Node*> path;
+		// costs[i] is the cost from the start to path[i]
+		std::vector<ArcType> costs;
+		typename std::list<Key>::iterator recent;
+		size_t bytes;
+	};
+
+	// path[position] of the entry under key is the node
+	struct Occurrence {
+		Key key;
+		size_t position;
+	};
+
+	typedef typename std::unordered_map<Key, Entry>::iterator EntryIterator;
+	typedef typename std::unordered_multimap<int, Occurrence>::iterator OccurrenceIterator;
+
+	GraphType & m_graph;
+	Heuristic m_heuristic;
+	size_t m_budget;
+
+	mutable std::mutex m_mutex;
+	std::unordered_map<Key, Entry> m_entries;
+	// the entries each node is on
+	std::unordered_multimap<int, Occurrence> m_byNode;
+	// most recently used first
+	std::list<Key> m_recent;
+	Stats m_stats;
+
+	static Key makeKey( int start, int dest, Algorithm algorithm ) {
+		return (static_cast<Key>(start) << 33) | (static_cast<Key>(dest) << 1) | static_cast<Key>(algorithm);
+	}
+
+	static int keyStart( Key key ) {
+		return static_cast<int>(key >> 33);
+	}
+
+	static int keyDest( Key key ) {
+		return static_cast<int>((key >> 1) & 0xFFFFFFFFull);
+	}
+
+	static Algorithm keyAlgorithm( Key key ) {
+		return static_cast<Algorithm>(key & 1);
+	}
+
+	static ArcType add( ArcType a, ArcType b ) {
+		return a == SearchContext<ArcType>::infinity() || b == SearchContext<ArcType>::infinity() ? SearchContext<ArcType>::infinity() : a + b;
+	}
+
+	void erase( Key key );
+	void eraseAll( std::vector<Key> &keys );
+	void eraseUsing( int from, int to );
+	void eraseShortened( int from, int to, ArcType weight );
+
+	// not copyable
+	PathCache( PathCache const & );
+	PathCache & operator=( PathCache const & );
+
+public:
+	explicit PathCache( GraphType &graph, size_t budget = 4 << 20 )
+		: m_graph( graph ), m_heuristic( graph ), m_budget( budget ) {
+		m_stats = Stats();
+		m_graph.addObserver(this);
+	}
+
+	PathCache( GraphType &graph, Heuristic const &heuristic, size_t budget = 4 << 20 )
+		: m_graph( graph ), m_heuristic( heuristic ), m_budget( budget ) {
+		m_stats = Stats();
+		m_graph.addObserver(this);
+	}
+
+	~PathCache() {
+		m_graph.removeObserver(this);
+	}
+
+	bool find( int start, int dest, Algorithm algorithm, std::vector<Node*> &path, ArcType *pCost = 0 );
+	bool insert( int start, int dest, Algorithm algorithm, std::vector<Node*> const &path );
+	void clear();
+
+	bool ucs( Context &context, Node* pStart, Node* pDest, void (*pProcess)(Node*), std::vector<Node*> &path );
+	bool aStar( Context &context, Node* pStart, Node* pDest, void (*pProcess)(Node*), std::vector<Node*> &path ) {
+		return aStar(context, pStart, pDest, pProcess, path, m_heuristic);
+	}
+	template<class SearchHeuristic>
+	bool aStar( Context &context, Node* pStart, Node* pDest, void (*pProcess)(Node*), std::vector<Node*> &path, SearchHeuristic const &heuristic );
+
+	Stats stats() const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Stats result = m_stats;
+		result.entries = m_entries.size();
+		return result;
+	}
+
+	size_t memoryUsage() const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_stats.bytes;
+	}
+
+	// GraphObserver
+	void arcAdded( int from, int to, ArcType weight );
+	void arcRemoved( int from, int to );
+	void arcWeightChanged( int from, int to, ArcType oldWeight, ArcType weight );
+	void nodeRemoved( int index );
+};
+
+// ----------------------------------------------------------------
+//  Name:           find
+//  Description:    Looks a query up: first an entry with the same
+//                  ends, then any entry with the same algorithm
+//                  that passes through start and later dest.
+//  Arguments:      The start and destination indices, the search
+//                  the answer must come from, the vector to append
+//                  the path to (destination first) and, optionally,
+//                  where to write its cost.
+//  Return Value:   true if the cache had the answer.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+bool PathCache<NodeType, ArcType, Heuristic>::find( int start, int dest, Algorithm algorithm, std::vector<Node*> &path, ArcType *pCost ) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	EntryIterator found = m_entries.find(makeKey(start, dest, algorithm));
+	size_t first = 0, last = 0;
+	if(found != m_entries.end()) {
+		last = found->second.path.size() - 1;
+		m_stats.hits++;
+	}
+	else {
+		// entries through dest, then whether start is on the same one
+		// further from dest.
+		std::pair<OccurrenceIterator, OccurrenceIterator> destOn = m_byNode.equal_range(dest);
+		std::pair<OccurrenceIterator, OccurrenceIterator> startOn = m_byNode.equal_range(start);
+		for(OccurrenceIterator d = destOn.first; d != destOn.second && found == m_entries.end(); d++) {
+			if(keyAlgorithm(d->second.key) != algorithm) {
+				continue;
+			}
+			for(OccurrenceIterator s = startOn.first; s != startOn.second; s++) {
+				if(s->second.key == d->second.key && s->second.position >= d->second.position) {
+					found = m_entries.find(d->second.key);
+					first = d->second.position;
+					last = s->second.position;
+					break;
+				}
+			}
+		}
+		if(found == m_entries.end()) {
+			m_stats.misses++;
+			return false;
+		}
+		m_stats.subpathHits++;
+	}
+
+	Entry &entry = found->second;
+	path.insert(path.end(), entry.path.begin() + first, entry.path.begin() + last + 1);
+	if(pCost != 0) {
+		*pCost = entry.costs[first] - entry.costs[last];
+	}
+	m_recent.splice(m_recent.begin(), m_recent, entry.recent);
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           insert
+//  Description:    Caches the answer to a query, replacing any
+//                  older one, and drops the least recently used
+//                  entries until it fits the budget. Unreachable
+//                  destinations (an empty path) are not cached.
+//  Arguments:      The start and destination indices, the search
+//                  that found the path, and the path, destination
+//                  first, as the searches give it.
+//  Return Value:   true if the path was cached.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+bool PathCache<NodeType, ArcType, Heuristic>::insert( int start, int dest, Algorithm algorithm, std::vector<Node*> const &path ) {
+	if(path.empty() || path.front()->index() != dest || path.back()->index() != start) {
+		return false;
+	}
+
+	Entry entry;
+	entry.path = path;
+	entry.costs.resize(path.size());
+	entry.costs.back() = 0;
+	for(size_t i = path.size() - 1; i != 0; i--) {
+		GraphArc<NodeType, ArcType> *pArc = m_graph.getArc(path[i]->index(), path[i - 1]->index());
+		if(pArc == 0) {
+			return false;
+		}
+		entry.costs[i - 1] = entry.costs[i] + pArc->weight();
+	}
+
+	// the vectors, and a node in each of the hash tables and the list.
+	size_t node = 3 * sizeof(void*);
+	entry.bytes = sizeof(Entry) + sizeof(Key) + node
+		+ path.size() * (sizeof(Node*) + sizeof(ArcType) + sizeof(std::pair<int, Occurrence>) + node)
+		+ sizeof(Key) + node;
+	if(entry.bytes > m_budget) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	Key key = makeKey(start, dest, algorithm);
+	if(m_entries.count(key) != 0) {
+		erase(key);
+	}
+	while(m_stats.bytes + entry.bytes > m_budget) {
+		erase(m_recent.back());
+		m_stats.evicted++;
+	}
+
+	m_recent.push_front(key);
+	entry.recent = m_recent.begin();
+	m_stats.bytes += entry.bytes;
+	for(size_t i = 0; i != path.size(); i++) {
+		Occurrence occurrence = { key, i };
+		m_byNode.insert(std::make_pair(path[i]->index(), occurrence));
+	}
+	Entry &placed = m_entries[key];
+	placed.path.swap(entry.path);
+	placed.costs.swap(entry.costs);
+	placed.recent = entry.recent;
+	placed.bytes = entry.bytes;
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           clear
+//  Description:    Drops every entry. The counters are kept.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+void PathCache<NodeType, ArcType, Heuristic>::clear() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_entries.clear();
+	m_byNode.clear();
+	m_recent.clear();
+	m_stats.bytes = 0;
+}
+
+// ----------------------------------------------------------------
+//  Name:           ucs
+//  Description:    Graph::ucs, answered from the cache when it can
+//                  be and cached when it is not.
+//  Arguments:      As Graph::ucs. pProcess is only called for the
+//                  nodes of a search that actually runs.
+//  Return Value:   true if the cache had the answer.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+bool PathCache<NodeType, ArcType, Heuristic>::ucs( Context &context, Node* pStart, Node* pDest, void (*pProcess)(Node*), std::vector<Node*> &path ) {
+	if(find(pStart->index(), pDest->index(), UCS, path)) {
+		return true;
+	}
+
+	size_t first = path.size();
+	m_graph.ucs(context, pStart, pDest, pProcess, path);
+	insert(pStart->index(), pDest->index(), UCS, std::vector<Node*>(path.begin() + first, path.end()));
+	return false;
+}
+
+// ----------------------------------------------------------------
+//  Name:           aStar
+//  Description:    Graph::aStar, answered from the cache when it can
+//                  be and cached when it is not.
+//  Arguments:      As Graph::aStar. pProcess is only called for the
+//                  nodes of a search that actually runs.
+//  Return Value:   true if the cache had the answer.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+template<class SearchHeuristic>
+bool PathCache<NodeType, ArcType, Heuristic>::aStar( Context &context, Node* pStart, Node* pDest, void (*pProcess)(Node*), std::vector<Node*> &path, SearchHeuristic const &heuristic ) {
+	if(find(pStart->index(), pDest->index(), ASTAR, path)) {
+		return true;
+	}
+
+	size_t first = path.size();
+	m_graph.aStar(context, pStart, pDest, pProcess, path, heuristic);
+	insert(pStart->index(), pDest->index(), ASTAR, std::vector<Node*>(path.begin() + first, path.end()));
+	return false;
+}
+
+// ----------------------------------------------------------------
+//  Name:           erase
+//  Description:    Drops one entry. The mutex must be held.
+//  Arguments:      The entry's key.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+void PathCache<NodeType, ArcType, Heuristic>::erase( Key key ) {
+	EntryIterator found = m_entries.find(key);
+	if(found == m_entries.end()) {
+		return;
+	}
+
+	Entry &entry = found->second;
+	for(size_t i = 0; i != entry.path.size(); i++) {
+		std::pair<OccurrenceIterator, OccurrenceIterator> on = m_byNode.equal_range(entry.path[i]->index());
+		for(OccurrenceIterator occurrence = on.first; occurrence != on.second; occurrence++) {
+			if(occurrence->second.key == key) {
+				m_byNode.erase(occurrence);
+				break;
+			}
+		}
+	}
+	m_recent.erase(entry.recent);
+	m_stats.bytes -= entry.bytes;
+	m_entries.erase(found);
+}
+
+// ----------------------------------------------------------------
+//  Name:           eraseAll
+//  Description:    Drops the entries a change made stale. The
+//                  mutex must be held.
+//  Arguments:      Their keys, which may repeat (emptied).
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+void PathCache<NodeType, ArcType, Heuristic>::eraseAll( std::vector<Key> &keys ) {
+	for(size_t i = 0; i != keys.size(); i++) {
+		if(m_entries.count(keys[i]) != 0) {
+			erase(keys[i]);
+			m_stats.invalidated++;
+		}
+	}
+	keys.clear();
+}
+
+// ----------------------------------------------------------------
+//  Name:           eraseUsing
+//  Description:    Drops the entries whose path takes the arc.
+//                  The mutex must be held.
+//  Arguments:      The arc's ends.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+void PathCache<NodeType, ArcType, Heuristic>::eraseUsing( int from, int to ) {
+	std::vector<Key> stale;
+	std::pair<OccurrenceIterator, OccurrenceIterator> on = m_byNode.equal_range(from);
+	for(OccurrenceIterator occurrence = on.first; occurrence != on.second; occurrence++) {
+		size_t position = occurrence->second.position;
+		// the next node towards the destination comes before it
+		if(position != 0 && m_entries[occurrence->second.key].path[position - 1]->index() == to) {
+			stale.push_back(occurrence->second.key);
+		}
+	}
+	eraseAll(stale);
+}
+
+// ----------------------------------------------------------------
+//  Name:           eraseShortened
+//  Description:    Drops the entries an arc of the given weight
+//                  might give a cheaper path. The mutex must be
+//                  held.
+//  Arguments:      The arc's ends and its weight.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Heuristic>
+void PathCache<NodeType, ArcType, Heuristic>::eraseShortened( int from, int to, ArcType weight ) {
+	std::vector<Key> stale;
+	for(EntryIterator entry = m_entries.begin(); entry != m_entries.end(); entry++) {
+		int start = keyStart(entry->first), dest = keyDest(entry->first);
+		ArcType bound = add(add(m_heuristic(start, from), weight), m_heuristic(to, dest));
+		if(bound < entry->second.costs.front()) {
+			stale.push_back(entry->first);
+		}
+	}
+	eraseAll(stale);
+}
+
+template<class NodeType, class ArcType, class Heuristic>
+void PathCache<NodeType, ArcType, Heuristic>::arcAdded( int from, int to, ArcType weight ) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	eraseShortened(from, to, weight);
+}
+
+template<class NodeType, class ArcType, class Heuristic>
+void PathCache<NodeType, ArcType, Heuristic>::arcRemoved( int from, int to ) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	eraseUsing(from, to);
+}
+
+template<class NodeType, class ArcType, class Heuristic>
+void PathCache<NodeType, ArcType, Heuristic>::arcWeightChanged( int from, int to, ArcType oldWeight, ArcType weight ) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	eraseUsing(from, to);
+	if(weight < oldWeight) {
+		eraseShortened(from, to, weight);
+	}
+}
+
+template<class NodeType, class ArcType, class Heuristic>
+void PathCache<NodeType, ArcType, Heuristic>::nodeRemoved( int index ) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::vector<Key> stale;
+	std::pair<OccurrenceIterator, OccurrenceIterator> on = m_byNode.equal_range(index);
+	for(OccurrenceIterator occurrence = on.first; occurrence != on.second; occurrence++) {
+		stale.push_back(occurrence->second.key);
+	}
+	eraseAll(stale);
+}
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef SEARCHCONTEXT_H
+#define SEARCHCONTEXT_H
+
+#include <vector>
+#include <limits>
+#include <cstddef>
+
+#include "IndexedPriorityQueue.h"
+
+// -------------------------------------------------------
+// Name:        SearchContext
+// Description: The per-query state of a search: the cost
+//              g(n), the estimate f(n), the previous node and
+//              the mark of every node, plus the open set.
+//              Keeping this out of the nodes means a graph
+//              can be searched by many threads at once, each
+//              with its own context.
+//
+//              Every entry is stamped with the generation it
+//              was written in. reset() just starts a new
+//              generation, so older entries read as "not
+//              reached" without an O(N) clearing pass.
+// -------------------------------------------------------
+template<class ArcType>
+class SearchContext {
+private:
+	std::vector<ArcType> m_cost;
+	std::vector<ArcType> m_estimate;
+	std::vector<int> m_previous;
+
+// -------------------------------------------------------
+// Description: the generation each node's cost/previous
+//              and mark were last written in.
+// -------------------------------------------------------
+	std::vector<unsigned int> m_reached;
+	std::vector<unsigned int> m_marked;
+
+	unsigned int m_generation;
+
+// -------------------------------------------------------
+// Description: how many nodes the current search has taken
+//              off the open set.
+// -------------------------------------------------------
+	size_t m_expanded;
+
+	IndexedPriorityQueue<ArcType> m_open;
+
+public:
+	SearchContext( int capacity = 0 ) : m_generation( 1 ), m_expanded( 0 ) {
+		reset(capacity);
+	}
+
+	static ArcType infinity() {
+		return std::numeric_limits<ArcType>::max() / 2;
+	}
+
+	void reset( int nodeCount );
+
+	// Accessor functions
+	int capacity() const {
+		return static_cast<int>(m_reached.size());
+	}
+
+	bool reached( int node ) const {
+		return m_reached[node] == m_generation;
+	}
+
+	ArcType cost( int node ) const {
+		return reached(node) ? m_cost[node] : infinity();
+	}
+
+	ArcType estimate( int node ) const {
+		return reached(node) ? m_estimate[node] : infinity();
+	}
+
+	int previous( int node ) const {
+		return reached(node) ? m_previous[node] : -1;
+	}
+
+	bool marked( int node ) const {
+		return m_marked[node] == m_generation;
+	}
+
+	size_t expanded() const {
+		return m_expanded;
+	}
+
+	IndexedPriorityQueue<ArcType> & open() {
+		return m_open;
+	}
+
+	// Manipulator functions
+	void setCost( int node, ArcType cost, int previous ) {
+		m_cost[node] = cost;
+		m_estimate[node] = cost;
+		m_previous[node] = previous;
+		m_reached[node] = m_generation;
+	}
+
+	void setEstimate( int node, ArcType estimate ) {
+		m_estimate[node] = estimate;
+	}
+
+	void setMarked( int node ) {
+		m_marked[node] = m_generation;
+	}
+
+	void countExpansion() {
+		m_expanded++;
+	}
+};
+
+// ----------------------------------------------------------------
+//  Name:           reset
+//  Description:    Forgets the previous query. This is O(1) unless
+//                  the graph has grown or the generation counter
+//                  wraps around.
+//  Arguments:      The number of nodes the next query may touch.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType>
+void SearchContext<ArcType>::reset( int nodeCount ) {
+	m_open.clear();
+	m_generation++;
+	m_expanded = 0;
+
+	if( m_generation == 0 ) {
+		// stamps from 2^32 generations ago would look current again.
+		m_reached.assign(m_reached.size(), 0);
+		m_marked.assign(m_marked.size(), 0);
+		m_generation = 1;
+	}
+
+	if( nodeCount > capacity() ) {
+		m_cost.resize(nodeCount);
+		m_estimate.resize(nodeCount);
+		m_previous.resize(nodeCount);
+		m_reached.resize(nodeCount, 0);
+		m_marked.resize(nodeCount, 0);
+		m_open.reserve(nodeCount);
+	}
+}
+
+#endif
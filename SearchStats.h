@@ -0,0 +1,139 @@
+#ifndef SEARCHSTATS_H
+#define SEARCHSTATS_H
+
+#include <cstddef>
+#include <chrono>
+
+// -------------------------------------------------------
+// Name:        SearchStats
+// Description: The counters of one query.
+// -------------------------------------------------------
+struct SearchStats {
+	size_t expansions;
+	// arcs looked at from expanded nodes
+	size_t relaxations;
+	size_t pushes;
+	size_t pops;
+	size_t decreaseKeys;
+	size_t peakOpen;
+	double seconds;
+
+	void clear() {
+		expansions = relaxations = pushes = pops = decreaseKeys = peakOpen = 0;
+		seconds = 0.0;
+	}
+};
+
+// -------------------------------------------------------
+// Name:        StatsSink
+// Description: Where SearchStatistics sends each query's
+//              counters when it finishes, e.g. an exporter to a
+//              metrics system. search names the algorithm, such
+//              as "Graph::aStar".
+// -------------------------------------------------------
+class StatsSink {
+public:
+	virtual ~StatsSink() {
+	}
+
+	virtual void record( char const *search, SearchStats const &stats ) = 0;
+};
+
+// -------------------------------------------------------
+// Name:        NoInstrumentation
+// Description: The instrumentation policy the searches use
+//              unless given another. Every hook is empty and
+//              inline, so an uninstrumented search compiles to
+//              the same code as one with no hooks at all.
+//
+//              A policy is any class with these members; the
+//              searches take it as a template parameter, so the
+//              choice is made at compile time.
+// -------------------------------------------------------
+struct NoInstrumentation {
+	void begin() {
+	}
+
+	void expanded() {
+	}
+
+	void relaxed() {
+	}
+
+	void pushed( size_t ) {
+	}
+
+	void popped() {
+	}
+
+	void decreasedKey() {
+	}
+
+	void end( char const * ) {
+	}
+};
+
+// -------------------------------------------------------
+// Name:        SearchStatistics
+// Description: The counting policy. Pass one to a search to
+//              have it count its work and time itself; stats()
+//              then holds the last query's counters, and the
+//              sink, if any, is given them as the query ends.
+// -------------------------------------------------------
+class SearchStatistics {
+private:
+	SearchStats m_stats;
+	StatsSink * m_pSink;
+	std::chrono::high_resolution_clock::time_point m_start;
+
+public:
+	explicit SearchStatistics( StatsSink *sink = 0 ) : m_pSink( sink ) {
+		m_stats.clear();
+	}
+
+	SearchStats const & stats() const {
+		return m_stats;
+	}
+
+	void setSink( StatsSink *sink ) {
+		m_pSink = sink;
+	}
+
+	void begin() {
+		m_stats.clear();
+		m_start = std::chrono::high_resolution_clock::now();
+	}
+
+	void expanded() {
+		m_stats.expansions++;
+	}
+
+	void relaxed() {
+		m_stats.relaxations++;
+	}
+
+	// openSize is the size of the open set after the push.
+	void pushed( size_t openSize ) {
+		m_stats.pushes++;
+		if(openSize > m_stats.peakOpen) {
+			m_stats.peakOpen = openSize;
+		}
+	}
+
+	void popped() {
+		m_stats.pops++;
+	}
+
+	void decreasedKey() {
+		m_stats.decreaseKeys++;
+	}
+
+	void end( char const *search ) {
+		m_stats.seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - m_start).count();
+		if(m_pSink != 0) {
+			m_pSink->record(search, m_stats);
+		}
+	}
+};
+
+#endif
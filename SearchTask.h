@@ -0,0 +1,281 @@
+#ifndef SEARCHTASK_H
+#define SEARCHTASK_H
+
+#include <vector>
+#include <chrono>
+
+#include "Graph.h"
+#include "GraphSearch.h"
+#include "SearchContext.h"
+#include "SearchStats.h"
+
+// -------------------------------------------------------
+// Name:        SearchTask
+// Description: Graph::aStar and Graph::ucs cut into slices,
+//              for a frame loop that cannot wait for a whole
+//              search. startAStar() or startUcs() sets a query
+//              up without expanding anything; each step() or
+//              stepFor() then expands nodes until its budget
+//              (a number of expansions or of microseconds) is
+//              spent, and says when the search is finished.
+//              Everything a search keeps between slices is in
+//              the SearchContext, so a view of the context
+//              shows the frontier growing as it goes, and the
+//              visitor is called on each expanded node as the
+//              synchronous searches do.
+//
+//              The graph must not change while a task runs,
+//              and the heuristic passed to startAStar() must
+//              outlive it. Instrumentation, as for the
+//              searches, is told when a query begins and ends,
+//              so the time it records includes the frames in
+//              between.
+// -------------------------------------------------------
+template<class NodeType, class ArcType, class Instrumentation = NoInstrumentation>
+class SearchTask {
+public:
+	typedef Graph<NodeType, ArcType> GraphType;
+	typedef GraphNode<NodeType, ArcType> Node;
+
+private:
+	// the heuristic of the running query, behind a virtual call so
+	// that one task can run searches with any heuristic.
+	struct Estimator {
+		virtual ~Estimator() {
+		}
+
+		virtual ArcType operator()( int node, int dest ) const = 0;
+	};
+
+	template<class Heuristic>
+	struct HeuristicEstimator : public Estimator {
+		Heuristic const *heuristic;
+
+		explicit HeuristicEstimator( Heuristic const &h ) : heuristic( &h ) {
+		}
+
+		ArcType operator()( int node, int dest ) const {
+			return static_cast<ArcType>((*heuristic)(node, dest));
+		}
+	};
+
+	GraphType const & m_graph;
+	SearchContext<ArcType> & m_context;
+	Instrumentation m_ownInstrumentation;
+	Instrumentation * m_pInstrumentation;
+
+	ZeroHeuristic<ArcType> m_zero;
+	Estimator * m_pEstimator;
+	char const * m_name;
+
+	Node* m_pStart;
+	Node* m_pDest;
+	void (*m_pProcess)(Node*);
+	bool m_running;
+	std::vector<Node*> m_path;
+
+	template<class Heuristic>
+	void start( Node* pStart, Node* pDest, Heuristic const &heuristic, void (*pProcess)(Node*), char const *name );
+	void finish();
+
+	// not copyable
+	SearchTask( SearchTask const & );
+	SearchTask & operator=( SearchTask const & );
+
+public:
+	SearchTask( GraphType const &graph, SearchContext<ArcType> &context )
+		: m_graph( graph ), m_context( context ), m_pInstrumentation( &m_ownInstrumentation ), m_pEstimator( 0 ), m_name( "" ),
+		  m_pStart( 0 ), m_pDest( 0 ), m_pProcess( 0 ), m_running( false ) {
+	}
+
+	SearchTask( GraphType const &graph, SearchContext<ArcType> &context, Instrumentation &instrumentation )
+		: m_graph( graph ), m_context( context ), m_pInstrumentation( &instrumentation ), m_pEstimator( 0 ), m_name( "" ),
+		  m_pStart( 0 ), m_pDest( 0 ), m_pProcess( 0 ), m_running( false ) {
+	}
+
+	~SearchTask() {
+		delete m_pEstimator;
+	}
+
+	template<class Heuristic>
+	void startAStar( Node* pStart, Node* pDest, Heuristic const &heuristic, void (*pProcess)(Node*) ) {
+		start(pStart, pDest, heuristic, pProcess, "SearchTask::aStar");
+	}
+
+	void startUcs( Node* pStart, Node* pDest, void (*pProcess)(Node*) ) {
+		start(pStart, pDest, m_zero, pProcess, "SearchTask::ucs");
+	}
+
+	bool step( size_t expansions );
+	bool stepFor( double microseconds );
+
+	// drops the running query, if any, ending it for the
+	// instrumentation; its state stays in the context.
+	void cancel() {
+		if(m_running) {
+			m_running = false;
+			m_pInstrumentation->end(m_name);
+		}
+	}
+
+	// Accessor functions
+	bool running() const {
+		return m_running;
+	}
+
+	// the path of the last query to finish, destination first, or
+	// nothing if it found none.
+	void path( std::vector<Node*> &path ) const {
+		path.insert(path.end(), m_path.begin(), m_path.end());
+	}
+};
+
+// ----------------------------------------------------------------
+//  Name:           start
+//  Description:    Sets a query up: resets the context and queues
+//                  the start node. Any query still running is
+//                  cancelled.
+//  Arguments:      The start and destination, the heuristic (the
+//                  zero one for ucs), the function to call on each
+//                  expanded node (or 0 for none) and the name to
+//                  report the query under.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Instrumentation>
+template<class Heuristic>
+void SearchTask<NodeType, ArcType, Instrumentation>::start( Node* pStart, Node* pDest, Heuristic const &heuristic, void (*pProcess)(Node*), char const *name ) {
+	cancel();
+	delete m_pEstimator;
+	m_pEstimator = new HeuristicEstimator<Heuristic>(heuristic);
+	m_name = name;
+	m_pStart = pStart;
+	m_pDest = pDest;
+	m_pProcess = pProcess;
+	m_path.clear();
+
+	m_pInstrumentation->begin();
+	m_context.reset(m_graph.getMaxNodes());
+	IndexedPriorityQueue<ArcType> &pq = m_context.open();
+
+	m_context.setCost(pStart->index(), 0, -1);
+	m_context.setEstimate(pStart->index(), (*m_pEstimator)(pStart->index(), pDest->index()));
+	pq.push(pStart->index(), m_context.estimate(pStart->index()));
+	m_pInstrumentation->pushed(pq.size());
+	m_context.setMarked(pStart->index());
+	m_running = true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           step
+//  Description:    Expands up to a number of nodes, in the same
+//                  order Graph::aStar would, and finishes the query
+//                  if the destination comes to the top of the open
+//                  set or the open set runs out.
+//  Arguments:      The most nodes to expand.
+//  Return Value:   true if the query finished in this call.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Instrumentation>
+bool SearchTask<NodeType, ArcType, Instrumentation>::step( size_t expansions ) {
+	if(!m_running) {
+		return false;
+	}
+
+	IndexedPriorityQueue<ArcType> &pq = m_context.open();
+	Node** nodes = m_graph.nodeArray();
+	int dest = m_pDest->index();
+
+	for(size_t spent = 0; spent != expansions; spent++) {
+		if(pq.empty() || pq.top() == dest) {
+			finish();
+			return true;
+		}
+
+		Node* top = nodes[pq.top()];
+		pq.pop();
+		m_context.countExpansion();
+		m_pInstrumentation->popped();
+		m_pInstrumentation->expanded();
+
+		if(m_pProcess != 0) {
+			m_pProcess(top);
+		}
+
+		ArcType cost = m_context.cost(top->index());
+		typename Node::ArcList::const_iterator iter = top->arcList().begin();
+		typename Node::ArcList::const_iterator endIter = top->arcList().end();
+
+		for( ; iter != endIter; iter++) {
+			int child = iter->node()->index();
+			m_pInstrumentation->relaxed();
+			ArcType gC = cost + iter->weight();
+
+			if(gC < m_context.cost(child)) {
+				ArcType fC = gC + (*m_pEstimator)(child, dest);
+				m_context.setCost(child, gC, top->index());
+				m_context.setEstimate(child, fC);
+
+				if(pq.contains(child)) {
+					pq.decreaseKey(child, fC);
+					m_pInstrumentation->decreasedKey();
+				}
+				else {
+					pq.push(child, fC);
+					m_pInstrumentation->pushed(pq.size());
+					m_context.setMarked(child);
+				}
+			}
+		}
+	}
+
+	// the budget may have run out just as the search was done.
+	if(pq.empty() || pq.top() == dest) {
+		finish();
+		return true;
+	}
+	return false;
+}
+
+// ----------------------------------------------------------------
+//  Name:           stepFor
+//  Description:    Expands nodes for about a length of time. The
+//                  clock is read after every 8 expansions, so a
+//                  slow visitor can run over by up to 8 calls.
+//  Arguments:      The time to spend, in microseconds.
+//  Return Value:   true if the query finished in this call.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Instrumentation>
+bool SearchTask<NodeType, ArcType, Instrumentation>::stepFor( double microseconds ) {
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+	while(m_running) {
+		if(step(8)) {
+			return true;
+		}
+		if(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count() >= microseconds) {
+			break;
+		}
+	}
+	return false;
+}
+
+// ----------------------------------------------------------------
+//  Name:           finish
+//  Description:    Ends the query: follows the previous pointers
+//                  back from the destination, if it was reached, and
+//                  tells the instrumentation.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType, class Instrumentation>
+void SearchTask<NodeType, ArcType, Instrumentation>::finish() {
+	Node** nodes = m_graph.nodeArray();
+	if(m_context.reached(m_pDest->index())) {
+		for(int node = m_pDest->index(); node != -1; node = m_context.previous(node)) {
+			m_path.push_back(nodes[node]);
+		}
+	}
+	m_running = false;
+	m_pInstrumentation->end(m_name);
+}
+
+#endif
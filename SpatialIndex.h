@@ -0,0 +1,350 @@
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#include "Graph.h"
+#include "GraphObserver.h"
+
+// -------------------------------------------------------
+// Name:        SpatialIndex
+// Description: A uniform grid over the positions of a Graph's
+//              nodes, for the questions a view and a caller
+//              with world coordinates ask: which node is under
+//              a point, which nodes are near it (the k nearest,
+//              or all within a radius) and which lie in a
+//              rectangle. Each query looks at the few cells
+//              around its area rather than every node.
+//
+//              The cells are square, cellSize wide, and kept in
+//              a hash map, so the graph may spread over any
+//              range of coordinates and only occupied cells
+//              cost memory. The index observes the graph and
+//              follows nodes as they are added, moved (through
+//              Graph::setNodePosition, or addDualArc) and
+//              removed. A cell size around the typical distance
+//              between neighbouring nodes works well.
+// -------------------------------------------------------
+template<class NodeType, class ArcType>
+class SpatialIndex : public GraphObserver<ArcType> {
+public:
+	typedef Graph<NodeType, ArcType> GraphType;
+	typedef GraphNode<NodeType, ArcType> Node;
+
+private:
+	typedef long long CellKey;
+
+	GraphType & m_graph;
+	float m_cellSize;
+
+	std::unordered_map<CellKey, std::vector<int> > m_cells;
+
+// -------------------------------------------------------
+// Description: The position each node is filed under, and
+//              whether it is in the index at all.
+// -------------------------------------------------------
+	std::vector<float> m_x;
+	std::vector<float> m_y;
+	std::vector<char> m_indexed;
+	int m_count;
+
+	// the range of cells that have ever held a node, which bounds
+	// how far a nearest-node search has to look.
+	int m_minCellX;
+	int m_minCellY;
+	int m_maxCellX;
+	int m_maxCellY;
+
+	int cellOf( float coordinate ) const {
+		return static_cast<int>(std::floor(coordinate / m_cellSize));
+	}
+
+	static CellKey key( int cellX, int cellY ) {
+		return static_cast<CellKey>(static_cast<unsigned long long>(static_cast<unsigned int>(cellX)) << 32 | static_cast<unsigned int>(cellY));
+	}
+
+	std::vector<int> const * cell( int cellX, int cellY ) const {
+		typename std::unordered_map<CellKey, std::vector<int> >::const_iterator found = m_cells.find(key(cellX, cellY));
+		return found == m_cells.end() ? 0 : &found->second;
+	}
+
+	float distanceSquared( int node, float x, float y ) const {
+		float dx = m_x[node] - x, dy = m_y[node] - y;
+		return dx * dx + dy * dy;
+	}
+
+	void insert( int node, float x, float y );
+	void erase( int node );
+
+	// not copyable
+	SpatialIndex( SpatialIndex const & );
+	SpatialIndex & operator=( SpatialIndex const & );
+
+public:
+	SpatialIndex( GraphType &graph, float cellSize = 64.0f );
+	~SpatialIndex();
+
+	void rebuild();
+
+	// Accessor functions
+	int size() const {
+		return m_count;
+	}
+
+	float cellSize() const {
+		return m_cellSize;
+	}
+
+	int nearest( float x, float y, float maxDistance = std::numeric_limits<float>::max() ) const;
+	void nearest( float x, float y, size_t k, std::vector<int> &nodes ) const;
+	void withinRadius( float x, float y, float radius, std::vector<int> &nodes ) const;
+	void inRectangle( float left, float top, float right, float bottom, std::vector<int> &nodes ) const;
+
+	// GraphObserver: nodes are followed; arcs do not matter here.
+	void nodeAdded( int index ) {
+		Node* pNode = m_graph.nodeArray()[index];
+		insert(index, pNode->x(), pNode->y());
+	}
+
+	void nodeMoved( int index, float, float ) {
+		Node* pNode = m_graph.nodeArray()[index];
+		erase(index);
+		insert(index, pNode->x(), pNode->y());
+	}
+
+	void nodeRemoved( int index ) {
+		erase(index);
+	}
+
+	void arcAdded( int, int, ArcType ) {
+	}
+
+	void arcRemoved( int, int ) {
+	}
+
+	void arcWeightChanged( int, int, ArcType, ArcType ) {
+	}
+};
+
+template<class NodeType, class ArcType>
+SpatialIndex<NodeType, ArcType>::SpatialIndex( GraphType &graph, float cellSize )
+	: m_graph( graph ), m_cellSize( cellSize > 0.0f ? cellSize : 64.0f ), m_count( 0 ) {
+	rebuild();
+	m_graph.addObserver(this);
+}
+
+template<class NodeType, class ArcType>
+SpatialIndex<NodeType, ArcType>::~SpatialIndex() {
+	m_graph.removeObserver(this);
+}
+
+// ----------------------------------------------------------------
+//  Name:           rebuild
+//  Description:    Files every node again from scratch, e.g. after
+//                  positions were written straight to the nodes
+//                  with GraphNode::setPosition, which the index
+//                  does not see.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void SpatialIndex<NodeType, ArcType>::rebuild() {
+	m_cells.clear();
+	m_x.assign(m_graph.getMaxNodes(), 0.0f);
+	m_y.assign(m_graph.getMaxNodes(), 0.0f);
+	m_indexed.assign(m_graph.getMaxNodes(), 0);
+	m_count = 0;
+	m_minCellX = m_minCellY = std::numeric_limits<int>::max();
+	m_maxCellX = m_maxCellY = std::numeric_limits<int>::min();
+
+	Node** nodes = m_graph.nodeArray();
+	std::vector<int> const &live = m_graph.liveNodes();
+	for(size_t i = 0; i != live.size(); i++) {
+		insert(live[i], nodes[live[i]]->x(), nodes[live[i]]->y());
+	}
+}
+
+template<class NodeType, class ArcType>
+void SpatialIndex<NodeType, ArcType>::insert( int node, float x, float y ) {
+	if(node >= static_cast<int>(m_indexed.size())) {
+		m_x.resize(m_graph.getMaxNodes(), 0.0f);
+		m_y.resize(m_graph.getMaxNodes(), 0.0f);
+		m_indexed.resize(m_graph.getMaxNodes(), 0);
+	}
+
+	int cellX = cellOf(x), cellY = cellOf(y);
+	m_cells[key(cellX, cellY)].push_back(node);
+	m_x[node] = x;
+	m_y[node] = y;
+	m_indexed[node] = 1;
+	m_count++;
+
+	m_minCellX = std::min(m_minCellX, cellX);
+	m_minCellY = std::min(m_minCellY, cellY);
+	m_maxCellX = std::max(m_maxCellX, cellX);
+	m_maxCellY = std::max(m_maxCellY, cellY);
+}
+
+template<class NodeType, class ArcType>
+void SpatialIndex<NodeType, ArcType>::erase( int node ) {
+	if(!m_indexed[node]) {
+		return;
+	}
+
+	CellKey cellKey = key(cellOf(m_x[node]), cellOf(m_y[node]));
+	std::vector<int> &members = m_cells[cellKey];
+	std::vector<int>::iterator found = std::find(members.begin(), members.end(), node);
+	*found = members.back();
+	members.pop_back();
+	if(members.empty()) {
+		m_cells.erase(cellKey);
+	}
+	m_indexed[node] = 0;
+	m_count--;
+}
+
+// ----------------------------------------------------------------
+//  Name:           nearest
+//  Description:    Snaps a point to the closest node. The cells are
+//                  searched in square rings around the point's cell
+//                  until no cell further out could hold anything
+//                  closer.
+//  Arguments:      The point and how far away a node may be.
+//  Return Value:   The node's index, or -1 if none is that close.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+int SpatialIndex<NodeType, ArcType>::nearest( float x, float y, float maxDistance ) const {
+	std::vector<int> nodes;
+	nearest(x, y, 1, nodes);
+	if(nodes.empty() || distanceSquared(nodes[0], x, y) > maxDistance * maxDistance) {
+		return -1;
+	}
+	return nodes[0];
+}
+
+// ----------------------------------------------------------------
+//  Name:           nearest
+//  Description:    Finds the k nodes closest to a point, keeping the
+//                  best k seen in a max-heap and widening the ring
+//                  of cells until the next ring is further away than
+//                  the k-th best (or the occupied cells run out).
+//  Arguments:      The point, k and the vector to write the nodes
+//                  into, closest first (fewer than k if the index
+//                  holds fewer).
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void SpatialIndex<NodeType, ArcType>::nearest( float x, float y, size_t k, std::vector<int> &nodes ) const {
+	if(k == 0 || m_count == 0) {
+		return;
+	}
+
+	// (distance squared, node), the largest on top.
+	std::vector<std::pair<float, int> > best;
+	int centreX = cellOf(x), centreY = cellOf(y);
+	int rings = std::max(std::max(centreX - m_minCellX, m_maxCellX - centreX), std::max(centreY - m_minCellY, m_maxCellY - centreY));
+
+	for(int ring = 0; ring <= rings; ring++) {
+		for(int cellY = centreY - ring; cellY <= centreY + ring; cellY++) {
+			// the middle rows only have the two cells at the ends.
+			int step = (cellY == centreY - ring || cellY == centreY + ring) ? 1 : 2 * ring;
+			for(int cellX = centreX - ring; cellX <= centreX + ring; cellX += step > 0 ? step : 1) {
+				std::vector<int> const *members = cell(cellX, cellY);
+				if(members == 0) {
+					continue;
+				}
+				for(size_t i = 0; i != members->size(); i++) {
+					float distance = distanceSquared((*members)[i], x, y);
+					if(best.size() < k) {
+						best.push_back(std::make_pair(distance, (*members)[i]));
+						std::push_heap(best.begin(), best.end());
+					}
+					else if(distance < best.front().first) {
+						std::pop_heap(best.begin(), best.end());
+						best.back() = std::make_pair(distance, (*members)[i]);
+						std::push_heap(best.begin(), best.end());
+					}
+				}
+			}
+		}
+
+		if(best.size() == k) {
+			// the nearest a node outside this ring's square can be
+			float gap = std::min(std::min(x - (centreX - ring) * m_cellSize, (centreX + ring + 1) * m_cellSize - x),
+			                     std::min(y - (centreY - ring) * m_cellSize, (centreY + ring + 1) * m_cellSize - y));
+			if(gap * gap >= best.front().first) {
+				break;
+			}
+		}
+	}
+
+	std::sort_heap(best.begin(), best.end());
+	for(size_t i = 0; i != best.size(); i++) {
+		nodes.push_back(best[i].second);
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           withinRadius
+//  Description:    Finds the nodes within a distance of a point.
+//  Arguments:      The point, the radius and the vector to add the
+//                  nodes to (in no particular order).
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void SpatialIndex<NodeType, ArcType>::withinRadius( float x, float y, float radius, std::vector<int> &nodes ) const {
+	for(int cellY = cellOf(y - radius); cellY <= cellOf(y + radius); cellY++) {
+		for(int cellX = cellOf(x - radius); cellX <= cellOf(x + radius); cellX++) {
+			std::vector<int> const *members = cell(cellX, cellY);
+			if(members == 0) {
+				continue;
+			}
+			for(size_t i = 0; i != members->size(); i++) {
+				if(distanceSquared((*members)[i], x, y) <= radius * radius) {
+					nodes.push_back((*members)[i]);
+				}
+			}
+		}
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           inRectangle
+//  Description:    Finds the nodes inside a rectangle, edges
+//                  included. Cells are only visited where the
+//                  rectangle and the occupied cells overlap, so a
+//                  rectangle far larger than the graph is cheap.
+//  Arguments:      The rectangle's left, top, right and bottom, and
+//                  the vector to add the nodes to (in no particular
+//                  order).
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void SpatialIndex<NodeType, ArcType>::inRectangle( float left, float top, float right, float bottom, std::vector<int> &nodes ) const {
+	if(m_count == 0) {
+		return;
+	}
+
+	int firstX = std::max(cellOf(left), m_minCellX), lastX = std::min(cellOf(right), m_maxCellX);
+	int firstY = std::max(cellOf(top), m_minCellY), lastY = std::min(cellOf(bottom), m_maxCellY);
+	for(int cellY = firstY; cellY <= lastY; cellY++) {
+		for(int cellX = firstX; cellX <= lastX; cellX++) {
+			std::vector<int> const *members = cell(cellX, cellY);
+			if(members == 0) {
+				continue;
+			}
+			for(size_t i = 0; i != members->size(); i++) {
+				int node = (*members)[i];
+				if(m_x[node] >= left && m_x[node] <= right && m_y[node] >= top && m_y[node] <= bottom) {
+					nodes.push_back(node);
+				}
+			}
+		}
+	}
+}
+
+#endif
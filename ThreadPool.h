@@ -0,0 +1,230 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+// -------------------------------------------------------
+// Name:        ThreadPool
+// Description: A fixed set of worker threads that run
+//              parallel loops. Each loop is cut into chunks
+//              which are dealt out to per-worker deques. A
+//              worker takes chunks from the back of its own
+//              deque and, once that is empty, steals from the
+//              front of the others, so a worker that drew
+//              cheap chunks helps out one that drew expensive
+//              ones. The threads are created once and sleep
+//              between loops.
+// -------------------------------------------------------
+class ThreadPool {
+public:
+// -------------------------------------------------------
+// Description: The loop body: the worker running it (in
+//              [0, workerCount())) and the half-open range of
+//              loop indices to process.
+// -------------------------------------------------------
+	typedef std::function<void (int worker, size_t begin, size_t end)> Job;
+
+private:
+	struct Chunk {
+		size_t begin;
+		size_t end;
+		unsigned int round;
+	};
+
+	struct WorkQueue {
+		std::mutex lock;
+		std::deque<Chunk> chunks;
+	};
+
+	std::vector<std::thread> m_threads;
+	std::vector<WorkQueue*> m_queues;
+
+	// the loop being run, and how many of its chunks are unfinished.
+	Job m_job;
+	std::atomic<size_t> m_remaining;
+
+	// m_round is bumped to wake the workers for a new loop. Chunks
+	// are stamped with the round they belong to, so a worker still
+	// holding the previous loop's job notices when it picks up a
+	// chunk of the next one.
+	std::mutex m_lock;
+	std::condition_variable m_wake;
+	std::condition_variable m_finished;
+	unsigned int m_round;
+	bool m_stop;
+
+	void workerLoop( int worker );
+	bool takeChunk( int worker, Chunk &chunk );
+
+	// not copyable
+	ThreadPool( ThreadPool const & );
+	ThreadPool & operator=( ThreadPool const & );
+
+public:
+	ThreadPool( int threads = 0 );
+	~ThreadPool();
+
+	int workerCount() const {
+		return static_cast<int>(m_threads.size());
+	}
+
+	void parallelFor( size_t count, size_t grain, Job const &job );
+};
+
+// ----------------------------------------------------------------
+//  Name:           ThreadPool
+//  Description:    Starts the worker threads.
+//  Arguments:      The number of workers; 0 means one per hardware
+//                  thread.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline ThreadPool::ThreadPool( int threads ) : m_remaining( 0 ), m_round( 0 ), m_stop( false ) {
+	if( threads <= 0 ) {
+		threads = static_cast<int>(std::thread::hardware_concurrency());
+	}
+	if( threads <= 0 ) {
+		threads = 1;
+	}
+
+	for( int i = 0; i != threads; i++ ) {
+		m_queues.push_back(new WorkQueue());
+	}
+	for( int i = 0; i != threads; i++ ) {
+		m_threads.push_back(std::thread(&ThreadPool::workerLoop, this, i));
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           ~ThreadPool
+//  Description:    Stops and joins the worker threads.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> guard(m_lock);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+
+	// a worker still looking for chunks to steal may touch any queue,
+	// so none is freed until every worker has stopped.
+	for( size_t i = 0; i != m_threads.size(); i++ ) {
+		m_threads[i].join();
+	}
+	for( size_t i = 0; i != m_queues.size(); i++ ) {
+		delete m_queues[i];
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           parallelFor
+//  Description:    Runs job over [0, count) on the workers and
+//                  waits for it to finish. Not reentrant: call it
+//                  from one thread at a time, and not from a job.
+//  Arguments:      The loop length, the number of indices per chunk
+//                  and the loop body.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void ThreadPool::parallelFor( size_t count, size_t grain, Job const &job ) {
+	if( count == 0 ) {
+		return;
+	}
+	if( grain == 0 ) {
+		grain = 1;
+	}
+
+	size_t chunks = (count + grain - 1) / grain;
+	size_t workers = m_queues.size();
+
+	std::unique_lock<std::mutex> lock(m_lock);
+	m_job = job;
+	m_remaining = chunks;
+	m_round++;
+
+	// give each worker a contiguous run of chunks; stealing evens
+	// out whatever imbalance is left.
+	for( size_t c = 0; c != chunks; c++ ) {
+		Chunk chunk;
+		chunk.begin = c * grain;
+		chunk.end = chunk.begin + grain < count ? chunk.begin + grain : count;
+		chunk.round = m_round;
+
+		WorkQueue *queue = m_queues[c * workers / chunks];
+		std::lock_guard<std::mutex> guard(queue->lock);
+		queue->chunks.push_back(chunk);
+	}
+	m_wake.notify_all();
+
+	while( m_remaining != 0 ) {
+		m_finished.wait(lock);
+	}
+}
+
+inline bool ThreadPool::takeChunk( int worker, Chunk &chunk ) {
+	// newest chunk from our own deque first...
+	{
+		WorkQueue *own = m_queues[worker];
+		std::lock_guard<std::mutex> guard(own->lock);
+		if( !own->chunks.empty() ) {
+			chunk = own->chunks.back();
+			own->chunks.pop_back();
+			return true;
+		}
+	}
+
+	// ...then the oldest chunk of any other worker.
+	int workers = static_cast<int>(m_queues.size());
+	for( int i = 1; i != workers; i++ ) {
+		WorkQueue *victim = m_queues[(worker + i) % workers];
+		std::lock_guard<std::mutex> guard(victim->lock);
+		if( !victim->chunks.empty() ) {
+			chunk = victim->chunks.front();
+			victim->chunks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+inline void ThreadPool::workerLoop( int worker ) {
+	unsigned int seen = 0;
+
+	for( ;; ) {
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(m_lock);
+			while( !m_stop && m_round == seen ) {
+				m_wake.wait(lock);
+			}
+			if( m_stop ) {
+				return;
+			}
+			seen = m_round;
+			job = m_job;
+		}
+
+		Chunk chunk;
+		while( takeChunk(worker, chunk) ) {
+			if( chunk.round != seen ) {
+				std::lock_guard<std::mutex> guard(m_lock);
+				seen = m_round;
+				job = m_job;
+			}
+			job(worker, chunk.begin, chunk.end);
+
+			if( --m_remaining == 0 ) {
+				std::lock_guard<std::mutex> guard(m_lock);
+				m_finished.notify_all();
+			}
+		}
+	}
+}
+
+#endif
@@ -22,6 +22,10 @@
 #include <fstream>
 
 #include "Graph.h"
+#include "GraphFile.h"
+#include "GraphView.h"
+#include "Landmarks.h"
+#include "SearchTask.h"
 #include "Button.h"
 
 #include <string>
@@ -39,17 +43,39 @@ typedef GraphArc<string, int> Arc;
 typedef GraphNode<pair<string, int>, int> Node;
 typedef vector<Node*> Path;
 
+//The view the search callbacks colour nodes in
+GraphView<pair<string, int>, int> *pGraphView = NULL;
+
 void visitFunc(Node * pNode) {
 	cout << "Visiting | " << pNode->data().first << endl;
-	pNode->setColor(0,100,0);
+	pGraphView->setColor(pNode, sf::Color(0,100,0));
 }
 
+//how long each frame may spend searching; the rest of a 60 fps
+//frame (16 ms) is left for events and drawing.
+const double kSearchSliceMicroseconds = 4000.0;
+
+//prints each search's counters once it finishes
+class ConsoleStatsSink : public StatsSink {
+public:
+	void record(char const *search, SearchStats const &stats) {
+		cout << "\n" << search << ": " << stats.expansions << " expanded, " << stats.relaxations << " arcs relaxed, "
+			<< stats.pushes << " pushes, " << stats.decreaseKeys << " decrease-keys, open set peaked at "
+			<< stats.peakOpen << ", " << stats.seconds * 1000.0 << " ms" << endl;
+	}
+};
+
 //outputs path to console and clears the container if param clear == true
 void outputPath(vector<Node*> &path, bool clear = true) {
+	if(path.empty()) {
+		cout << "\a\a\aDestination is unreachable from the start node." << endl;
+		return;
+	}
+
 	cout << "PATH: " << endl;
 
 	for(int i = 0; i < path.size(); i++) {
-		path[i]->setColor(200,0,0);
+		pGraphView->setColor(path[i], sf::Color(200,0,0));
 		cout << path[i]->data().first << endl;
 	}
 
@@ -70,44 +96,80 @@ int main(int argc, char *argv[]) {
 		reset_Button("RESET", mainFont, Vector2f(650, 300), Vector2f(100,50));
 
 
-	//create graph
-    Graph<pair<string, int>, int> graph( 30 );
-	
-	//read nodes
-	pair<string, int> c("", 0);
-
-	int i = 0;
-	ifstream myfile;
-	//cout << "before read";
-	myfile.open("nodes.txt");
+	//create graph, from graph.bin if GraphConvert has made one, or
+	//else from the text files (the graph grows as they are read)
+	MappedGraph<int> mapped;
+	bool binary = mapped.open("graph.bin");
+    Graph<pair<string, int>, int> graph( binary ? mapped.graph().nodeCount() : 0 );
 
-	while (myfile >> c.first) {
-		graph.addNode(c, i++, mainFont);
+	if(binary) {
+		CSRGraph<int> const &frozen = mapped.graph();
+		for(int node = 0; node < frozen.nodeCount(); node++) {
+			graph.addNode(pair<string, int>(mapped.name(node), 0), node);
+			graph.setNodePosition(node, frozen.x(node), frozen.y(node));
+		}
+		for(int node = 0; node < frozen.nodeCount(); node++) {
+			for(int arc = frozen.arcBegin(node); arc != frozen.arcEnd(node); arc++) {
+				graph.addArc(node, frozen.target(arc), frozen.weight(arc));
+			}
+		}
+		mapped.close();
 	}
+	else {
+		//read nodes
+		pair<string, int> c("", 0);
+
+		ifstream myfile;
+		myfile.open("nodes.txt");
 
-	myfile.close();
+		//nodes take slots 0, 1, 2... in file order, as arcs.txt expects
+		while (myfile >> c.first) {
+			graph.addNode(c);
+		}
 
-	//read arcs
-	myfile.open("arcs.txt");
+		myfile.close();
 
-	int from, to, weight, startX, startY, endX, endY;
-	while ( myfile >> from >> to >> weight >> startX >> startY >> endX >> endY) {
-		graph.addDualArc(from, to, weight, startX, startY, endX, endY, mainFont);
-	}
+		//read arcs
+		myfile.open("arcs.txt");
 
-    myfile.close();
+		int from, to, weight, startX, startY, endX, endY;
+		while ( myfile >> from >> to >> weight >> startX >> startY >> endX >> endY) {
+			graph.addDualArc(from, to, weight, startX, startY, endX, endY);
+		}
+
+		myfile.close();
+	}
 
 	cout << "\aLeft Click sets starting node!\nRight Click sets destination node!"<<endl;
-	cout << "-----------------------------\n[1]Run UCS first.\n[2]Hit reset to clear the colours.\n[3]Run A*.\n[4]Give marks\n-----------------------------"<<endl;
+	cout << "-----------------------------\n[1]Run UCS first.\n[2]Hit reset to clear the colours.\n[3]Run A* (or press L for A* with landmarks).\n[4]Give marks\n-----------------------------"<<endl;
 	cout << "\tColour Key\nBlue\t|\tUntouched - algorithm has not touched this node at all.\nRed\t|\tPath - node is part of the path found"<<endl;
 	cout << "Gray\t|\tProbed - node's heuristic was checked.\nGreen\t|\tChecked - node was travelled to and all its arcs were checked."<<endl;
 	cout << "All green nodes were once gray nodes. Gray may overwrite green and vice versa\n\a"<<endl;
 
 
+	GraphView<pair<string, int>, int> view(graph, mainFont);
+	pGraphView = &view;
+
+	//the state of the last search, shown by the view
+	SearchContext<int> context(graph.getMaxNodes());
+	view.setSearchContext(&context);
+
+	//landmarks for the ALT heuristic; the sample arc weights don't
+	//follow the node positions, so they bound far better than
+	//heuristic_eval does.
+	Landmarks<int> landmarks(graph.freeze(), 4);
+
 	vector<Node*> path;
-	graph.clearMarks();
 
-	
+	//counts each search's work; the sink prints it
+	ConsoleStatsSink statsSink;
+	SearchStatistics statistics(&statsSink);
+	Graph<pair<string, int>, int>::Euclidean euclidean(graph);
+
+	//the search in progress; it is advanced a slice per frame so
+	//the window keeps drawing while it runs
+	SearchTask<pair<string, int>, int, SearchStatistics> search(graph, context, statistics);
+
 	// Start game loop
 	while (window.isOpen())
 	{
@@ -124,20 +186,25 @@ int main(int argc, char *argv[]) {
 				window.close();
 
 			//Clear marks
-			else if ((Event.type == sf::Event::KeyPressed) && (Event.key.code == sf::Keyboard::R))
-				graph.clearMarks();
+			else if ((Event.type == sf::Event::KeyPressed) && (Event.key.code == sf::Keyboard::R)) {
+				search.cancel();
+				context.reset(graph.getMaxNodes());
+				view.resetColors();
+			}
 
 			//Run A*
 			else if ((Event.type == sf::Event::KeyPressed) && (Event.key.code == sf::Keyboard::A)){
-				_ASSERT(path.empty());
-				graph.aStar(graph.nodeArray()[startNode], graph.nodeArray()[destNode], visitFunc, path);
-				outputPath(path);
+				search.startAStar(graph.nodeArray()[startNode], graph.nodeArray()[destNode], euclidean, visitFunc);
 			}
 			
+			//Run A* with the landmark heuristic
+			else if ((Event.type == sf::Event::KeyPressed) && (Event.key.code == sf::Keyboard::L)){
+				search.startAStar(graph.nodeArray()[startNode], graph.nodeArray()[destNode], landmarks, visitFunc);
+			}
+
 			else if ((Event.type == sf::Event::KeyPressed) && (Event.key.code == sf::Keyboard::U)){
 				//_ASSERT(path.empty());
-				graph.ucs(graph.nodeArray()[startNode], graph.nodeArray()[destNode], visitFunc, path);
-				outputPath(path);
+				search.startUcs(graph.nodeArray()[startNode], graph.nodeArray()[destNode], visitFunc);
 			}
 
 			else if (Event.type == sf::Event::MouseButtonPressed) {
@@ -147,50 +214,47 @@ int main(int argc, char *argv[]) {
 #pragma region Button Click Checks
 			   //check mouse click on buttons
 			   if(runUCS_Button.containsPoint(mousePos.x, mousePos.y)) {
-				   graph.ucs(graph.nodeArray()[startNode], graph.nodeArray()[destNode], visitFunc, path);
-				   outputPath(path);
+				   search.startUcs(graph.nodeArray()[startNode], graph.nodeArray()[destNode], visitFunc);
 			   }
 			   else if(runASTAR_Button.containsPoint(mousePos.x, mousePos.y)) {
-				   graph.aStar(graph.nodeArray()[startNode], graph.nodeArray()[destNode], visitFunc, path);
-				   outputPath(path);
+				   search.startAStar(graph.nodeArray()[startNode], graph.nodeArray()[destNode], euclidean, visitFunc);
 			   }
 			   else if(reset_Button.containsPoint(mousePos.x, mousePos.y)) {
-				   graph.clearMarks();
+				   search.cancel();
+				   context.reset(graph.getMaxNodes());
+				   view.resetColors();
 			   }  
 #pragma endregion
 
 
 #pragma region Node Click Checks
-			   for (int i = 0; i < graph.getTotalNodes(); ++i){
-
-				   if(graph.nodeArray()[i]->containsPoint(mousePos.x, mousePos.y)){
-
-					   if (Event.mouseButton.button == sf::Mouse::Left) {
-						   startNode = i;
-						   cout << "\aStarting node set | " << graph.nodeArray()[i]->data().first << endl;
-						   break;
-					   }
-					   else if(Event.mouseButton.button == sf::Mouse::Right) {
-						   destNode = i;
-						   cout << "\aDestination node set | " << graph.nodeArray()[i]->data().first << endl;
-						   break;
-					   }
+			   Node* clicked = view.nodeAt(mousePos.x, mousePos.y);
+
+			   if(clicked != NULL) {
+				   if (Event.mouseButton.button == sf::Mouse::Left) {
+					   startNode = clicked->index();
+					   cout << "\aStarting node set | " << clicked->data().first << endl;
+				   }
+				   else if(Event.mouseButton.button == sf::Mouse::Right) {
+					   destNode = clicked->index();
+					   cout << "\aDestination node set | " << clicked->data().first << endl;
 				   }
 			   }
 			}  
 #pragma endregion
 				
 		}
+		//advance the search in progress by one slice
+		if(search.running() && search.stepFor(kSearchSliceMicroseconds)) {
+			search.path(path);
+			outputPath(path);
+		}
+
 		//prepare frame
 		window.clear();
 
-		//draw nodes and arcs (TODO: don't draw reverse arcs)
-		for (int i = 0; i < graph.getTotalNodes(); ++i) {
-			graph.nodeArray()[i]->drawArcs(window);
-		}
-		for (int i = 0; i < graph.getTotalNodes(); ++i) {
-			graph.nodeArray()[i]->drawSelf(window);
-		}
+		//draw nodes and arcs
+		view.draw(window);
 
 		runASTAR_Button.Draw(window);
 		runUCS_Button.Draw(window);